@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui sql
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -18,19 +18,94 @@ RC_ICONS = Icon.ico
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    agreementengine.cpp \
+    annotationcache.cpp \
+    annotationfile.cpp \
+    annotationindex.cpp \
+    annotationsimplifier.cpp \
+    annotationview.cpp \
+    benchmark.cpp \
+    catalogcache.cpp \
+    classindex.cpp \
+    contenthasher.cpp \
+    datasetstatistics.cpp \
+    exifreader.cpp \
+    geometry.cpp \
+    gradientmap.cpp \
+    hammingindex.cpp \
     iclass.cpp \
     image.cpp \
+    imagecache.cpp \
+    imagecatalog.cpp \
+    imageimporter.cpp \
+    imageindex.cpp \
+    imagelistmodel.cpp \
+    interactionlog.cpp \
+    livewire.cpp \
+    magicwand.cpp \
     main.cpp \
     mainwindow.cpp \
-    scene.cpp
+    maskrasterizer.cpp \
+    memorystats.cpp \
+    nearduplicatefinder.cpp \
+    overlapchecker.cpp \
+    perceptualhash.cpp \
+    perfcounters.cpp \
+    polygonsimplifier.cpp \
+    prefetcher.cpp \
+    projectdatabase.cpp \
+    scene.cpp \
+    statisticsdock.cpp \
+    syntheticdata.cpp \
+    taskscheduler.cpp \
+    templatematcher.cpp \
+    trace.cpp
 
 HEADERS += \
+    agreementengine.h \
+    annotationcache.h \
+    annotationfile.h \
+    annotationindex.h \
+    annotationsimplifier.h \
+    annotationview.h \
+    benchmark.h \
+    catalogcache.h \
+    classindex.h \
+    contenthasher.h \
+    datasetstatistics.h \
+    exifreader.h \
+    geometry.h \
+    gradientmap.h \
+    hammingindex.h \
     iclass.h \
     image.h \
+    imagecache.h \
+    imagecatalog.h \
+    imageimporter.h \
+    imageindex.h \
+    imagelistmodel.h \
+    interactionlog.h \
     linkedlist.h \
+    livewire.h \
+    magicwand.h \
     mainwindow.h \
+    maskrasterizer.h \
+    memorystats.h \
+    nearduplicatefinder.h \
     node.h \
-    scene.h
+    nodepool.h \
+    overlapchecker.h \
+    perceptualhash.h \
+    perfcounters.h \
+    polygonsimplifier.h \
+    prefetcher.h \
+    projectdatabase.h \
+    scene.h \
+    statisticsdock.h \
+    syntheticdata.h \
+    taskscheduler.h \
+    templatematcher.h \
+    trace.h
 
 FORMS += \
     mainwindow.ui
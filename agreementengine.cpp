@@ -0,0 +1,272 @@
+#include "agreementengine.h"
+#include "geometry.h"
+#include "maskrasterizer.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QMutex>
+#include <QSet>
+
+#include <algorithm>
+#include <limits>
+
+ClassAgreement::ClassAgreement()
+    : reference(0), compared(0), matched(0), iouSum(0)
+{
+}
+
+void ClassAgreement::add(const ClassAgreement &other){
+    if(shapes.size() < other.shapes.size())
+        shapes.resize(other.shapes.size());
+    for(int s = 0; s < other.shapes.size(); s++)
+        shapes[s] += other.shapes[s];
+    reference += other.reference;
+    compared += other.compared;
+    matched += other.matched;
+    iouSum += other.iouSum;
+}
+
+double ClassAgreement::precision() const{
+    return compared > 0 ? double(matched) / compared : 1;
+}
+
+double ClassAgreement::recall() const{
+    return reference > 0 ? double(matched) / reference : 1;
+}
+
+double ClassAgreement::agreement() const{
+    return reference + compared > 0 ? 2.0 * matched / (reference + compared) : 1;
+}
+
+double ClassAgreement::meanIou() const{
+    return matched > 0 ? iouSum / matched : 0;
+}
+
+AgreementEngine::AgreementEngine(const QStringList &setFolders, double threshold)
+    : folders(setFolders), iouThreshold(threshold)
+{
+}
+
+double AgreementEngine::iou(const AnnotationShape &a, const QPolygonF &outlineA, const AnnotationShape &b, const QPolygonF &outlineB){
+    if(a.type == SHAPE_RECT && b.type == SHAPE_RECT)
+        return Geometry::iou(QRectF(a.coordinates[0], a.coordinates[1], a.coordinates[2], a.coordinates[3]), a.rotation,
+                             QRectF(b.coordinates[0], b.coordinates[1], b.coordinates[2], b.coordinates[3]), b.rotation);
+    return Geometry::iou(outlineA, outlineB);
+}
+
+QVector<int> AgreementEngine::assign(const QVector<double> &cost, int rows, int columns){
+
+    //Potentials u (rows) and v (columns), p[j] is the row assigned to column j, index 0 is a virtual column
+    const double infinity = std::numeric_limits<double>::max();
+    QVector<double> u(rows + 1, 0), v(columns + 1, 0);
+    QVector<int> p(columns + 1, 0), way(columns + 1, 0);
+    QVector<double> minimum(columns + 1);
+    QVector<bool> used(columns + 1);
+
+    for(int i = 1; i <= rows; i++){
+        p[0] = i;
+        int j0 = 0;
+        minimum.fill(infinity);
+        used.fill(false);
+        do{
+            used[j0] = true;
+            int i0 = p[j0];
+            int j1 = 0;
+            double delta = infinity;
+            const double *row = cost.constData() + (i0 - 1) * columns;
+            for(int j = 1; j <= columns; j++){
+                if(used[j])
+                    continue;
+                double reduced = row[j - 1] - u[i0] - v[j];
+                if(reduced < minimum[j]){
+                    minimum[j] = reduced;
+                    way[j] = j0;
+                }
+                if(minimum[j] < delta){
+                    delta = minimum[j];
+                    j1 = j;
+                }
+            }
+            for(int j = 0; j <= columns; j++){
+                if(used[j]){
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                }else{
+                    minimum[j] -= delta;
+                }
+            }
+            j0 = j1;
+        }while(p[j0] != 0);
+
+        //the augmenting path back to the virtual column
+        do{
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        }while(j0 != 0);
+    }
+
+    QVector<int> assignment(rows, -1);
+    for(int j = 1; j <= columns; j++){
+        if(p[j] != 0)
+            assignment[p[j] - 1] = j - 1;
+    }
+    return assignment;
+}
+
+ImageAgreement AgreementEngine::compareImage(const QVector<QVector<AnnotationShape> > &sets, double threshold, QHash<QString, ClassAgreement> *classes){
+
+    ImageAgreement result;
+    result.disagreement = 0;
+    result.shapes = 0;
+    result.unmatched = 0;
+    int k = sets.size();
+
+    //the outlines of the compared shapes, grouped by class
+    QVector<QVector<QPolygonF> > outlines(k);
+    QVector<QHash<QString, QVector<int> > > byClass(k);
+    for(int s = 0; s < k; s++){
+        outlines[s].resize(sets[s].size());
+        for(int i = 0; i < sets[s].size(); i++){
+            const AnnotationShape &shape = sets[s][i];
+            if(shape.confidence >= 0)
+                continue;
+            outlines[s][i] = MaskRasterizer::outline(shape);
+            if(outlines[s][i].isEmpty())
+                continue;
+            byClass[s][shape.object].append(i);
+            result.shapes++;
+
+            ClassAgreement &counts = (*classes)[shape.object];
+            if(counts.shapes.isEmpty())
+                counts.shapes.fill(0, k);
+            counts.shapes[s]++;
+        }
+    }
+
+    double diceSum = 0;
+    int pairs = 0;
+    QVector<double> cost, ious;
+    for(int a = 0; a < k; a++){
+        for(int b = a + 1; b < k; b++){
+            QStringList names = byClass[a].keys();
+            for(const QString &name : byClass[b].keys()){
+                if(!byClass[a].contains(name))
+                    names.append(name);
+            }
+
+            qint64 shapesA = 0, shapesB = 0;
+            double iouSum = 0;
+            for(const QString &name : names){
+                const QVector<int> reference = byClass[a].value(name);
+                const QVector<int> compared = byClass[b].value(name);
+                ClassAgreement &counts = (*classes)[name];
+                counts.reference += reference.size();
+                counts.compared += compared.size();
+                shapesA += reference.size();
+                shapesB += compared.size();
+                if(reference.isEmpty() || compared.isEmpty()){
+                    result.unmatched += reference.size() + compared.size();
+                    continue;
+                }
+
+                //the smaller side are the rows, a pair below the threshold costs more than any match so the number of matches comes first
+                bool transposed = reference.size() > compared.size();
+                const QVector<int> &rowShapes = transposed ? compared : reference;
+                const QVector<int> &columnShapes = transposed ? reference : compared;
+                int rowSet = transposed ? b : a;
+                int columnSet = transposed ? a : b;
+                int rows = rowShapes.size();
+                int columns = columnShapes.size();
+                cost.resize(rows * columns);
+                ious.resize(rows * columns);
+                for(int r = 0; r < rows; r++){
+                    const AnnotationShape &rowShape = sets[rowSet][rowShapes[r]];
+                    const QPolygonF &rowOutline = outlines[rowSet][rowShapes[r]];
+                    for(int c = 0; c < columns; c++){
+                        double value = iou(rowShape, rowOutline, sets[columnSet][columnShapes[c]], outlines[columnSet][columnShapes[c]]);
+                        ious[r * columns + c] = value;
+                        cost[r * columns + c] = value >= threshold ? 1 - value : 2;
+                    }
+                }
+
+                int matched = 0;
+                QVector<int> assignment = assign(cost, rows, columns);
+                for(int r = 0; r < rows; r++){
+                    double value = ious[r * columns + assignment[r]];
+                    if(value < threshold)
+                        continue;
+                    matched++;
+                    counts.iouSum += value;
+                    iouSum += value;
+                }
+                counts.matched += matched;
+                result.unmatched += rows + columns - 2 * matched;
+            }
+
+            diceSum += shapesA + shapesB > 0 ? 2 * iouSum / (shapesA + shapesB) : 1;
+            pairs++;
+        }
+    }
+
+    result.disagreement = pairs > 0 ? 1 - diceSum / pairs : 0;
+    return result;
+}
+
+AgreementReport AgreementEngine::run(QStringList *errors) const{
+
+    TRACE_SCOPE("annotator agreement", "validation");
+    AgreementReport report;
+
+    //every file of any set, a set without it is compared as an empty annotation
+    QVector<QSet<QString> > present(folders.size());
+    QStringList names;
+    QSet<QString> seen;
+    for(int s = 0; s < folders.size(); s++){
+        for(const QString &name : QDir(folders[s]).entryList(QStringList() << "*.json", QDir::Files, QDir::Name)){
+            present[s].insert(name);
+            if(!seen.contains(name)){
+                seen.insert(name);
+                names.append(name);
+            }
+        }
+    }
+
+    report.images.resize(names.size());
+    ImageAgreement *out = report.images.data(); //each task writes its own entry, detached before the tasks start
+    QMutex mutex;
+    TaskScheduler::instance()->parallelFor(names.size(), [&](int i) {
+        QVector<QVector<AnnotationShape> > sets(folders.size());
+        QVector<int> missing;
+        QStringList failed;
+        for(int s = 0; s < folders.size(); s++){
+            QString path = QDir(folders[s]).filePath(names[i]);
+            if(!present[s].contains(names[i])){
+                missing.append(s);
+            }else if(!AnnotationFile::read(path, &sets[s])){
+                missing.append(s);
+                failed.append("Cannot read " + path);
+            }
+        }
+
+        QHash<QString, ClassAgreement> classes;
+        out[i] = compareImage(sets, iouThreshold, &classes);
+        out[i].fileName = names[i];
+        out[i].missing = missing;
+
+        QMutexLocker locker(&mutex);
+        for(auto it = classes.constBegin(); it != classes.constEnd(); ++it)
+            report.classes[it.key()].add(it.value());
+        errors->append(failed);
+    });
+
+    std::sort(report.images.begin(), report.images.end(), [](const ImageAgreement &l, const ImageAgreement &r) {
+        if(l.disagreement != r.disagreement)
+            return l.disagreement > r.disagreement;
+        if(l.unmatched != r.unmatched)
+            return l.unmatched > r.unmatched;
+        return l.fileName < r.fileName;
+    });
+    return report;
+}
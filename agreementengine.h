@@ -0,0 +1,173 @@
+#ifndef AGREEMENTENGINE_H
+#define AGREEMENTENGINE_H
+
+#include "annotationfile.h"
+
+#include <QHash>
+#include <QPolygonF>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief AGREEMENT_IOU_THRESHOLD is the default smallest intersection over union of two shapes counted as the same object
+ */
+#define AGREEMENT_IOU_THRESHOLD 0.5
+/*!
+ * \brief AGREEMENT_REVIEW_COUNT is the default number of images listed for review
+ */
+#define AGREEMENT_REVIEW_COUNT 100
+
+/*!
+ * \brief The ClassAgreement struct is the agreement of the annotation sets on one class, summed over the pairs of sets
+ *
+ * In each pair the first set is the reference: the precision is the share of the shapes of the second set matched in the first
+ * one, the recall the share of the shapes of the first set matched in the second one.
+ */
+struct ClassAgreement
+{
+    /*!
+     * \brief ClassAgreement constructor initialises empty counts
+     */
+    ClassAgreement();
+    /*!
+     * \brief add method adds the counts of another image or thread
+     */
+    void add(const ClassAgreement &other);
+    /*!
+     * \brief precision method gets the share of the compared shapes matched, 1 when there is none
+     */
+    double precision() const;
+    /*!
+     * \brief recall method gets the share of the reference shapes matched, 1 when there is none
+     */
+    double recall() const;
+    /*!
+     * \brief agreement method gets the F1 score of the matching (2 matched / (reference + compared)), 1 when there is no shape
+     */
+    double agreement() const;
+    /*!
+     * \brief meanIou method gets the mean intersection over union of the matched shapes
+     */
+    double meanIou() const;
+
+    /*!
+     * \brief shapes is the number of shapes of the class in each set
+     */
+    QVector<qint64> shapes;
+    /*!
+     * \brief reference is the number of shapes on the reference side of the pairs
+     */
+    qint64 reference;
+    /*!
+     * \brief compared is the number of shapes on the compared side of the pairs
+     */
+    qint64 compared;
+    /*!
+     * \brief matched is the number of matched pairs of shapes
+     */
+    qint64 matched;
+    /*!
+     * \brief iouSum is the sum of the intersection over union of the matched shapes
+     */
+    double iouSum;
+};
+
+/*!
+ * \brief The ImageAgreement struct is how much the annotation sets disagree on one image
+ */
+struct ImageAgreement
+{
+    /*!
+     * \brief fileName is the annotation file name, the same in every set
+     */
+    QString fileName;
+    /*!
+     * \brief disagreement is 1 minus the mean over the pairs of sets of 2 * (sum of the matched IoU) / (shapes of both sets), 0 when the sets agree exactly
+     */
+    double disagreement;
+    /*!
+     * \brief shapes is the number of shapes compared, over all the sets
+     */
+    int shapes;
+    /*!
+     * \brief unmatched is the number of shapes left without a match, over all the pairs of sets
+     */
+    int unmatched;
+    /*!
+     * \brief missing are the indexes of the sets without this file (compared as having no shape) or whose file could not be read
+     */
+    QVector<int> missing;
+};
+
+/*!
+ * \brief The AgreementReport struct is the result of comparing annotation sets
+ */
+struct AgreementReport
+{
+    /*!
+     * \brief classes maps each class to its agreement
+     */
+    QHash<QString, ClassAgreement> classes;
+    /*!
+     * \brief images are the compared images, the most disagreed on first
+     */
+    QVector<ImageAgreement> images;
+};
+
+/*!
+ * \brief The AgreementEngine class measures how much annotators agree when they label the same images, to check their quality
+ *
+ * Each annotator's files are in a folder, the files with the same name in the folders are compared. For each pair of folders and
+ * each class the shapes are matched one to one maximizing the matched intersection over union (Hungarian algorithm), a pair
+ * below the threshold is not a match. Lines and pre-labels not accepted are left out. The images are compared in parallel.
+ */
+class AgreementEngine
+{
+public:
+    /*!
+     * \brief AgreementEngine constructor sets the annotation sets
+     * \param setFolders are the folders of the annotators, at least two
+     * \param threshold is the smallest intersection over union of a match
+     */
+    AgreementEngine(const QStringList &setFolders, double threshold = AGREEMENT_IOU_THRESHOLD);
+    /*!
+     * \brief run method compares every file found in at least one of the folders
+     * \param errors receives a message per file that could not be read
+     * \return returns the per class agreement and the images sorted by disagreement
+     */
+    AgreementReport run(QStringList *errors) const;
+    /*!
+     * \brief compareImage method compares the annotation sets of one image
+     * \param sets are the shapes of each set
+     * \param threshold is the smallest intersection over union of a match
+     * \param classes receives the counts of each class, added to what it holds
+     * \return returns the disagreement of the image, its file name and missing sets are not set
+     */
+    static ImageAgreement compareImage(const QVector<QVector<AnnotationShape> > &sets, double threshold, QHash<QString, ClassAgreement> *classes);
+    /*!
+     * \brief assign method solves the assignment problem (Hungarian algorithm with potentials, O(rows^2 * columns))
+     * \param cost is the row-major cost matrix
+     * \param rows is the number of rows, at most columns
+     * \param columns is the number of columns
+     * \return returns the column assigned to each row
+     */
+    static QVector<int> assign(const QVector<double> &cost, int rows, int columns);
+
+private:
+    /*!
+     * \brief iou method gets the intersection over union of two shapes, unrotated rectangles take the quick path
+     */
+    static double iou(const AnnotationShape &a, const QPolygonF &outlineA, const AnnotationShape &b, const QPolygonF &outlineB);
+
+private:
+    /*!
+     * \brief folders are the folders of the annotation sets
+     */
+    QStringList folders;
+    /*!
+     * \brief iouThreshold is the smallest intersection over union of a match
+     */
+    double iouThreshold;
+};
+
+#endif // AGREEMENTENGINE_H
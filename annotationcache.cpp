@@ -0,0 +1,154 @@
+#include "annotationcache.h"
+#include "trace.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+QDataStream &operator<<(QDataStream &out, const AnnotationShape &shape){
+    out << qint32(shape.type) << shape.object << shape.coordinates << shape.rotation << shape.confidence;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, AnnotationShape &shape){
+    qint32 type;
+    in >> type >> shape.object >> shape.coordinates >> shape.rotation >> shape.confidence;
+    shape.type = type;
+    return in;
+}
+
+AnnotationCache::AnnotationCache(const QString &theFolder, qint64 theBudget) : folder(theFolder), budget(theBudget), used(0)
+{
+}
+
+QString AnnotationCache::defaultLocation(){
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/annotations";
+}
+
+qint64 AnnotationCache::estimateBytes(const QVector<AnnotationShape> &shapes){
+
+    qint64 bytes = sizeof(Entry);
+    for(const AnnotationShape &shape : shapes)
+        bytes += sizeof(AnnotationShape) + shape.coordinates.size() * sizeof(double) + shape.object.size() * sizeof(QChar);
+    return bytes;
+}
+
+QString AnnotationCache::fileName(const QString &imagePath) const{
+    QByteArray hash = QCryptographicHash::hash(imagePath.toUtf8(), QCryptographicHash::Md5);
+    return folder + "/" + QString::fromLatin1(hash.toHex()) + ".shapes";
+}
+
+bool AnnotationCache::writeEntry(const QString &imagePath, const Entry &entry) const{
+
+    TRACE_SCOPE("write cached annotations", "cache");
+
+    QDir().mkpath(folder);
+    QSaveFile file(fileName(imagePath));
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out << quint32(ANNOTATION_CACHE_MAGIC) << quint32(ANNOTATION_CACHE_VERSION) << imagePath << entry.modified << entry.shapes;
+    return file.commit();
+}
+
+void AnnotationCache::store(const QString &imagePath, const QVector<AnnotationShape> &shapes, bool modified){
+
+    QHash<QString, Entry>::iterator it = entries.find(imagePath);
+    if(it != entries.end()){
+        used -= it.value().bytes;
+        lru.erase(it.value().use);
+        entries.erase(it);
+    }
+
+    if(shapes.isEmpty() && !modified){
+        QFile::remove(fileName(imagePath)); //nothing to restore
+        return;
+    }
+
+    lru.push_front(imagePath);
+
+    Entry entry;
+    entry.shapes = shapes;
+    entry.modified = modified;
+    entry.bytes = estimateBytes(shapes);
+    entry.use = lru.begin();
+    entries.insert(imagePath, entry);
+    used += entry.bytes;
+
+    evict();
+}
+
+void AnnotationCache::evict(){
+
+    while(used > budget && lru.size() > 1){ //the image just stored stays in memory
+        QString path = lru.back();
+        QHash<QString, Entry>::iterator it = entries.find(path);
+
+        if(!writeEntry(path, it.value()))
+            return; //keep it in memory rather than lose it
+
+        used -= it.value().bytes;
+        lru.pop_back();
+        entries.erase(it);
+    }
+}
+
+bool AnnotationCache::take(const QString &imagePath, QVector<AnnotationShape> *shapes, bool *modified){
+
+    QHash<QString, Entry>::iterator it = entries.find(imagePath);
+    if(it != entries.end()){
+        *shapes = it.value().shapes;
+        *modified = it.value().modified;
+        used -= it.value().bytes;
+        lru.erase(it.value().use);
+        entries.erase(it);
+        QFile::remove(fileName(imagePath)); //an older copy may have been written by flush
+        return true;
+    }
+
+    TRACE_SCOPE("read cached annotations", "cache");
+
+    QFile file(fileName(imagePath));
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32 magic, version;
+    QString path;
+    bool wasModified;
+    QVector<AnnotationShape> loaded;
+    in >> magic >> version;
+    if(magic != ANNOTATION_CACHE_MAGIC || version != ANNOTATION_CACHE_VERSION)
+        return false;
+
+    in >> path >> wasModified >> loaded;
+    if(in.status() != QDataStream::Ok || path != imagePath)
+        return false;
+
+    file.close();
+    file.remove();
+
+    *shapes = loaded;
+    *modified = wasModified;
+    return true;
+}
+
+bool AnnotationCache::flush(){
+
+    bool ok = true;
+    for(QHash<QString, Entry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it)
+        ok = writeEntry(it.key(), it.value()) && ok;
+    return ok;
+}
+
+qint64 AnnotationCache::memoryUsed() const{
+    return used;
+}
+
+int AnnotationCache::count() const{
+    return entries.size();
+}
@@ -0,0 +1,125 @@
+#ifndef ANNOTATIONCACHE_H
+#define ANNOTATIONCACHE_H
+
+#include "annotationfile.h"
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <QDataStream>
+
+#include <list>
+
+/*!
+ * \brief ANNOTATION_CACHE_BUDGET is the memory the cached annotations may use, in bytes
+ */
+#define ANNOTATION_CACHE_BUDGET (32 * 1024 * 1024)
+#define ANNOTATION_CACHE_MAGIC 0x4c414e43
+#define ANNOTATION_CACHE_VERSION 2
+
+/*!
+ * \brief The AnnotationCache class keeps the shapes of the images that are not displayed, so switching back to an image restores them without re-opening the annotation file
+ *
+ * The least recently used images are written to a folder once the memory budget is exceeded and read back when needed,
+ * so unsaved shapes are never dropped (flush writes the rest when the application closes, they are restored in the next session).
+ */
+class AnnotationCache
+{
+public:
+    /*!
+     * \brief AnnotationCache constructor
+     * \param theFolder is the folder the evicted images are written to
+     * \param theBudget is the memory budget in bytes
+     */
+    AnnotationCache(const QString &theFolder, qint64 theBudget = ANNOTATION_CACHE_BUDGET);
+    /*!
+     * \brief store method keeps the shapes of an image that is no longer displayed
+     * \param imagePath is the image path
+     * \param shapes are the shapes on the image
+     * \param modified is true when the shapes have not been saved to an annotation file
+     */
+    void store(const QString &imagePath, const QVector<AnnotationShape> &shapes, bool modified);
+    /*!
+     * \brief take method gets and removes the shapes of an image that is going to be displayed
+     * \param imagePath is the image path
+     * \param shapes receives the shapes
+     * \param modified receives whether they were unsaved
+     * \return returns true if the image was cached (in memory or in the folder)
+     */
+    bool take(const QString &imagePath, QVector<AnnotationShape> *shapes, bool *modified);
+    /*!
+     * \brief flush method writes every image held in memory to the folder
+     * \return returns true if everything was written
+     */
+    bool flush();
+    /*!
+     * \brief memoryUsed method gets the estimated memory used by the images held in memory
+     * \return returns the size in bytes
+     */
+    qint64 memoryUsed() const;
+    /*!
+     * \brief count method gets the number of images held in memory
+     */
+    int count() const;
+    /*!
+     * \brief defaultLocation method gets the folder used by the application
+     * \return returns the folder path
+     */
+    static QString defaultLocation();
+
+private:
+    /*!
+     * \brief The Entry struct holds the shapes of one image
+     */
+    struct Entry
+    {
+        QVector<AnnotationShape> shapes;
+        bool modified;
+        qint64 bytes;
+        std::list<QString>::iterator use; //position in the lru list
+    };
+    /*!
+     * \brief estimateBytes method estimates the memory used by a list of shapes
+     */
+    static qint64 estimateBytes(const QVector<AnnotationShape> &shapes);
+    /*!
+     * \brief fileName method gets the file an image is written to in the folder
+     */
+    QString fileName(const QString &imagePath) const;
+    /*!
+     * \brief writeEntry method writes the shapes of an image to the folder
+     */
+    bool writeEntry(const QString &imagePath, const Entry &entry) const;
+    /*!
+     * \brief evict method writes the least recently used images to the folder until the budget is respected
+     */
+    void evict();
+
+private:
+    /*!
+     * \brief folder is where evicted images are written
+     */
+    QString folder;
+    /*!
+     * \brief budget is the memory budget in bytes
+     */
+    qint64 budget;
+    /*!
+     * \brief used is the estimated memory used by the entries
+     */
+    qint64 used;
+    /*!
+     * \brief entries maps an image path to its shapes
+     */
+    QHash<QString, Entry> entries;
+    /*!
+     * \brief lru lists the image paths from the most to the least recently stored
+     */
+    std::list<QString> lru;
+};
+
+QDataStream &operator<<(QDataStream &out, const AnnotationShape &shape);
+QDataStream &operator>>(QDataStream &in, AnnotationShape &shape);
+
+#endif // ANNOTATIONCACHE_H
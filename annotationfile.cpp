@@ -0,0 +1,126 @@
+#include "annotationfile.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+AnnotationShape::AnnotationShape() : type(0), rotation(0), confidence(-1)
+{
+}
+
+QString AnnotationFile::shapeName(int type){
+    switch (type)
+    {
+    case SHAPE_RECT:        return "Rectangle";
+    case SHAPE_TRAPEZOID:   return "Trapezoid";
+    case SHAPE_POLYGON:     return "Polygon";
+    default:                return QString();
+    }
+}
+
+int AnnotationFile::shapeType(const QString &name){
+    if(name == "Rectangle")
+        return SHAPE_RECT;
+    if(name == "Trapezoid")
+        return SHAPE_TRAPEZOID;
+    if(name == "Polygon")
+        return SHAPE_POLYGON;
+    return 0;
+}
+
+bool AnnotationFile::read(const QString &fileName, QVector<AnnotationShape> *shapes){
+
+    TRACE_SCOPE("read annotation file", "annotation");
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    *shapes = parse(file.readAll());
+    file.close();
+    return true;
+}
+
+bool AnnotationFile::write(const QString &fileName, const QVector<AnnotationShape> &shapes){
+
+    TRACE_SCOPE("write annotation file", "save");
+
+    QSaveFile jsonFile(fileName); //written to a temporary file and renamed, a failed write never leaves a truncated annotation file
+    if(!jsonFile.open(QFile::WriteOnly))
+        return false;
+
+    QByteArray json = serialize(shapes);
+    if(jsonFile.write(json) != json.size())
+        return false; //the temporary file is discarded, the previous annotation file is kept
+    return jsonFile.commit();
+}
+
+QVector<AnnotationShape> AnnotationFile::parse(const QByteArray &json){
+
+    TRACE_SCOPE("parse json", "annotation");
+
+    QVector<AnnotationShape> shapes;
+
+    QJsonDocument d = QJsonDocument::fromJson(json);
+    QJsonArray objsArray = d.object().value("objects").toArray();
+    shapes.reserve(objsArray.size());
+
+    for(int i = 0; i < objsArray.size(); i++){
+
+        QJsonObject item = objsArray[i].toObject();
+        AnnotationShape shape;
+        shape.type = shapeType(item["shape"].toString());
+        shape.object = item["object"].toString();
+
+        QJsonArray coordinates = item["coordinates"].toArray();
+        shape.coordinates.reserve(coordinates.size());
+        for(int j = 0; j < coordinates.size(); j++)
+            shape.coordinates.append(coordinates[j].toDouble());
+        if(shape.type == SHAPE_RECT)
+            shape.rotation = item["rotation"].toDouble();
+        shape.confidence = item["confidence"].toDouble(-1);
+
+        //a rectangle needs x, y, width and height and the other shapes at least one point
+        bool valid = shape.type == SHAPE_RECT ? shape.coordinates.size() >= 4
+                   : shape.type == SHAPE_TRAPEZOID ? shape.coordinates.size() >= 8
+                   : shape.type == SHAPE_POLYGON && shape.coordinates.size() >= 2;
+        if(valid)
+            shapes.append(shape);
+    }
+    return shapes;
+}
+
+QByteArray AnnotationFile::serialize(const QVector<AnnotationShape> &shapes){
+
+    TRACE_SCOPE("serialize json", "save");
+
+    QJsonDocument doc;
+    QJsonArray a;
+    QJsonObject root;
+
+    for(const AnnotationShape &shape : shapes){
+        QJsonObject o;
+        QJsonArray res;
+
+        o.insert("object", shape.object);
+        o.insert("shape", shapeName(shape.type));
+        for(double c : shape.coordinates)
+            res.append(c);
+        o.insert("coordinates", res);
+        if(shape.rotation != 0)
+            o.insert("rotation", shape.rotation); //only rotated rectangles have it, older files stay the same
+        if(shape.confidence >= 0)
+            o.insert("confidence", shape.confidence); //a pre-label the annotator hasn't accepted yet
+
+        a.push_back(o);
+    }
+
+    root.insert("TotalShapes", shapes.size());
+    root.insert("objects", a);
+
+    doc.setObject(root);
+    return doc.toJson();
+}
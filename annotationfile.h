@@ -0,0 +1,90 @@
+#ifndef ANNOTATIONFILE_H
+#define ANNOTATIONFILE_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+#define SHAPE_LINE		1
+#define SHAPE_RECT		2
+#define SHAPE_TRAPEZOID	3
+#define SHAPE_POLYGON	4
+
+/*!
+ * \brief The AnnotationShape struct is one annotated object as stored in the json file
+ */
+struct AnnotationShape
+{
+    /*!
+     * \brief AnnotationShape constructor initialises an empty shape
+     */
+    AnnotationShape();
+    /*!
+     * \brief type is the shape type (SHAPE_RECT, SHAPE_TRAPEZOID or SHAPE_POLYGON)
+     */
+    int type;
+    /*!
+     * \brief object is the class name of the annotated object
+     */
+    QString object;
+    /*!
+     * \brief coordinates are the scene coordinates, x, y, width and height for a rectangle and x, y pairs for a trapezoid or polygon
+     */
+    QVector<double> coordinates;
+    /*!
+     * \brief rotation is the rotation of a rectangle around its center in degrees (x, y, width and height are then those of the rectangle before rotating)
+     */
+    double rotation;
+    /*!
+     * \brief confidence is the score (0 to 1) of a shape proposed by a tool and not yet accepted by the annotator (a pre-label), -1 for the other shapes
+     */
+    double confidence;
+};
+
+/*!
+ * \brief The AnnotationFile class reads and writes the json annotation files (shared by the scene and the tools that work on whole datasets)
+ */
+class AnnotationFile
+{
+public:
+    /*!
+     * \brief read method reads the shapes of an annotation file
+     * \param fileName is the json file path
+     * \param shapes receives the shapes
+     * \return returns true if the file was read
+     */
+    static bool read(const QString &fileName, QVector<AnnotationShape> *shapes);
+    /*!
+     * \brief write method writes shapes to an annotation file
+     * \param fileName is the json file path
+     * \param shapes are the shapes to write
+     * \return returns true if the file was written
+     */
+    static bool write(const QString &fileName, const QVector<AnnotationShape> &shapes);
+    /*!
+     * \brief parse method gets the shapes from json text, unknown shapes and empty coordinate lists are skipped
+     * \param json is the file content
+     * \return returns the shapes
+     */
+    static QVector<AnnotationShape> parse(const QByteArray &json);
+    /*!
+     * \brief serialize method converts shapes to json text
+     * \param shapes are the shapes
+     * \return returns the file content
+     */
+    static QByteArray serialize(const QVector<AnnotationShape> &shapes);
+    /*!
+     * \brief shapeName method gets the name written to the file for a shape type
+     * \param type is the shape type
+     * \return returns "Rectangle", "Trapezoid" or "Polygon", or an empty string for other types
+     */
+    static QString shapeName(int type);
+    /*!
+     * \brief shapeType method gets the shape type of a name written in the file
+     * \param name is the shape name
+     * \return returns the shape type or 0 if the name is unknown
+     */
+    static int shapeType(const QString &name);
+};
+
+#endif // ANNOTATIONFILE_H
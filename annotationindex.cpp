@@ -0,0 +1,68 @@
+#include "annotationindex.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QFileInfo>
+
+AnnotationIndex::AnnotationIndex()
+{
+}
+
+const QHash<QString, QString> &AnnotationIndex::jsonFiles(const QString &folder){
+
+    QHash<QString, QHash<QString, QString> >::const_iterator it = folders.constFind(folder);
+    if(it != folders.constEnd())
+        return it.value();
+
+    QHash<QString, QString> names;
+    QDir dir(folder);
+    for(const QString &name : dir.entryList(QStringList() << "*.json", QDir::Files))
+        names.insert(name.toLower(), dir.filePath(name));
+
+    return folders.insert(folder, names).value();
+}
+
+QStringList AnnotationIndex::discover(const QStringList &imagePaths){
+
+    TRACE_SCOPE("discover annotations", "import");
+
+    QStringList found;
+    for(const QString &imagePath : imagePaths){
+        if(assigned.contains(imagePath))
+            continue;
+
+        QFileInfo info(imagePath);
+        QString folder = info.absolutePath();
+        QString base = info.completeBaseName().toLower() + ".json";
+        QString full = info.fileName().toLower() + ".json";
+
+        QString match = jsonFiles(folder).value(base);
+        if(match.isEmpty())
+            match = jsonFiles(folder).value(full);
+        if(match.isEmpty())
+            match = jsonFiles(folder + "/annotations").value(base);
+        if(match.isEmpty())
+            match = jsonFiles(QDir::cleanPath(folder + "/../annotations")).value(base);
+
+        if(!match.isEmpty()){
+            files.insert(imagePath, match);
+            found.append(imagePath);
+        }
+    }
+
+    folders.clear(); //files may be added before the next import
+    return found;
+}
+
+void AnnotationIndex::assign(const QString &imagePath, const QString &annotationPath){
+    assigned.insert(imagePath, annotationPath);
+    files.insert(imagePath, annotationPath);
+}
+
+QString AnnotationIndex::annotationFile(const QString &imagePath) const{
+    return files.value(imagePath);
+}
+
+int AnnotationIndex::size() const{
+    return files.size();
+}
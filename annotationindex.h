@@ -0,0 +1,66 @@
+#ifndef ANNOTATIONINDEX_H
+#define ANNOTATIONINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+/*!
+ * \brief The AnnotationIndex class maps each image to its annotation file
+ *
+ * Files are discovered by naming convention, for an image dir/name.jpg the first existing file of
+ * dir/name.json, dir/name.jpg.json, dir/annotations/name.json and dir/../annotations/name.json is used.
+ * Files opened from the annotation pane are assigned to the displayed image and take precedence.
+ */
+class AnnotationIndex
+{
+public:
+    /*!
+     * \brief AnnotationIndex constructor creates an empty index
+     */
+    AnnotationIndex();
+    /*!
+     * \brief discover method looks for the annotation files of images (each folder is listed once, whatever the number of images in it)
+     * \param imagePaths are the image paths
+     * \return returns the images an annotation file was found for
+     */
+    QStringList discover(const QStringList &imagePaths);
+    /*!
+     * \brief assign method sets the annotation file of an image
+     * \param imagePath is the image path
+     * \param annotationPath is the annotation file path
+     */
+    void assign(const QString &imagePath, const QString &annotationPath);
+    /*!
+     * \brief annotationFile method gets the annotation file of an image
+     * \param imagePath is the image path
+     * \return returns the annotation file path or an empty string if the image has none
+     */
+    QString annotationFile(const QString &imagePath) const;
+    /*!
+     * \brief size method gets the number of images with an annotation file
+     */
+    int size() const;
+
+private:
+    /*!
+     * \brief jsonFiles method gets the names of the json files of a folder, listing it only the first time
+     */
+    const QHash<QString, QString> &jsonFiles(const QString &folder);
+
+private:
+    /*!
+     * \brief files maps an image path to its annotation file path
+     */
+    QHash<QString, QString> files;
+    /*!
+     * \brief assigned maps the images whose file was chosen by hand to that file, discovery never replaces them
+     */
+    QHash<QString, QString> assigned;
+    /*!
+     * \brief folders maps a folder path to its json files (lower case file name to path)
+     */
+    QHash<QString, QHash<QString, QString> > folders;
+};
+
+#endif // ANNOTATIONINDEX_H
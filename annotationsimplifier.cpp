@@ -0,0 +1,152 @@
+#include "annotationsimplifier.h"
+#include "polygonsimplifier.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QtMath>
+
+#include <cmath>
+
+SimplifyOptions::SimplifyOptions()
+    : method(Method::None), tolerance(SIMPLIFY_DEFAULT_TOLERANCE), decimals(-1)
+{
+}
+
+bool SimplifyOptions::isActive() const{
+    return method != Method::None || decimals >= 0;
+}
+
+QString SimplifyOptions::methodName(Method method){
+    switch(method){
+    case Method::DouglasPeucker:
+        return "dp";
+    case Method::Visvalingam:
+        return "vw";
+    default:
+        return "none";
+    }
+}
+
+SimplifyOptions::Method SimplifyOptions::methodFromName(const QString &name, bool *ok){
+    *ok = true;
+    for(Method method : {Method::None, Method::DouglasPeucker, Method::Visvalingam}){
+        if(name.compare(methodName(method), Qt::CaseInsensitive) == 0)
+            return method;
+    }
+    *ok = false;
+    return Method::None;
+}
+
+SimplifyReport::SimplifyReport()
+    : files(0), verticesBefore(0), verticesAfter(0), bytesBefore(0), bytesAfter(0)
+{
+}
+
+void SimplifyReport::add(const SimplifyReport &other){
+    files += other.files;
+    verticesBefore += other.verticesBefore;
+    verticesAfter += other.verticesAfter;
+    bytesBefore += other.bytesBefore;
+    bytesAfter += other.bytesAfter;
+}
+
+QString SimplifyReport::summary() const{
+    auto change = [](qint64 before, qint64 after) {
+        return before > 0 ? QString(" (%1%)").arg(qRound(100.0 * (after - before) / before)) : QString();
+    };
+    return QString("%1 -> %2 vertices%3, %4 KB -> %5 KB%6")
+            .arg(verticesBefore).arg(verticesAfter).arg(change(verticesBefore, verticesAfter))
+            .arg(bytesBefore / 1024.0, 0, 'f', 1).arg(bytesAfter / 1024.0, 0, 'f', 1).arg(change(bytesBefore, bytesAfter));
+}
+
+double AnnotationSimplifier::quantize(double value, double scale){
+    return std::round(value * scale) / scale;
+}
+
+SimplifyReport AnnotationSimplifier::simplify(QVector<AnnotationShape> *shapes, const SimplifyOptions &options){
+
+    TRACE_SCOPE("simplify shapes", "save");
+    SimplifyReport report;
+    report.bytesBefore = AnnotationFile::serialize(*shapes).size();
+    double scale = options.decimals >= 0 ? std::pow(10.0, qMin(options.decimals, SIMPLIFY_MAX_DECIMALS)) : 0;
+
+    for(AnnotationShape &shape : *shapes){
+        if(shape.type != SHAPE_POLYGON){
+            if(scale > 0){
+                for(double &c : shape.coordinates)
+                    c = quantize(c, scale);
+            }
+            continue;
+        }
+
+        QPolygonF polygon;
+        for(int i = 0; i + 1 < shape.coordinates.size(); i += 2)
+            polygon << QPointF(shape.coordinates[i], shape.coordinates[i + 1]);
+        report.verticesBefore += polygon.size();
+
+        if(options.method != SimplifyOptions::Method::None && polygon.size() > 3){
+            polygon = PolygonSimplifier::removeCollinear(polygon);
+            if(options.method == SimplifyOptions::Method::DouglasPeucker)
+                polygon = PolygonSimplifier::douglasPeucker(polygon, options.tolerance);
+            else
+                polygon = PolygonSimplifier::visvalingam(polygon, options.tolerance * options.tolerance);
+        }
+
+        QVector<double> coordinates;
+        coordinates.reserve(2 * polygon.size());
+        for(const QPointF &point : polygon){
+            double x = scale > 0 ? quantize(point.x(), scale) : point.x();
+            double y = scale > 0 ? quantize(point.y(), scale) : point.y();
+            int n = coordinates.size();
+            if(n >= 2 && coordinates[n - 2] == x && coordinates[n - 1] == y)
+                continue; //rounded onto the previous vertex
+            coordinates << x << y;
+        }
+        if(coordinates.size() >= 6){
+            shape.coordinates = coordinates;
+        }else if(scale > 0){
+            for(double &c : shape.coordinates)
+                c = quantize(c, scale); //too small to lose vertices, only rounded
+        }
+        report.verticesAfter += shape.coordinates.size() / 2;
+    }
+
+    report.files = 1;
+    report.bytesAfter = AnnotationFile::serialize(*shapes).size();
+    return report;
+}
+
+SimplifyReport AnnotationSimplifier::simplifyFiles(const QStringList &fileNames, const QString &outputFolder, const SimplifyOptions &options, QStringList *errors){
+
+    TRACE_SCOPE("simplify files", "export");
+    SimplifyReport total;
+    if(!outputFolder.isEmpty() && !QDir().mkpath(outputFolder)){
+        errors->append("Cannot create " + outputFolder);
+        return total;
+    }
+
+    QMutex mutex;
+    TaskScheduler::instance()->parallelFor(fileNames.size(), [&](int i) {
+        QString error;
+        SimplifyReport report;
+        QVector<AnnotationShape> shapes;
+        QString output = outputFolder.isEmpty() ? fileNames[i] : QDir(outputFolder).filePath(QFileInfo(fileNames[i]).fileName());
+        if(!AnnotationFile::read(fileNames[i], &shapes)){
+            error = "Cannot read " + fileNames[i];
+        }else{
+            report = simplify(&shapes, options);
+            if(!AnnotationFile::write(output, shapes))
+                error = "Cannot write " + output;
+        }
+
+        QMutexLocker locker(&mutex);
+        if(error.isEmpty())
+            total.add(report);
+        else
+            errors->append(error);
+    });
+    return total;
+}
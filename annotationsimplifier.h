@@ -0,0 +1,136 @@
+#ifndef ANNOTATIONSIMPLIFIER_H
+#define ANNOTATIONSIMPLIFIER_H
+
+#include "annotationfile.h"
+
+#include <QString>
+#include <QStringList>
+
+/*!
+ * \brief SIMPLIFY_DEFAULT_TOLERANCE is the default tolerance of the simplification in scene pixels
+ */
+#define SIMPLIFY_DEFAULT_TOLERANCE 0.5
+/*!
+ * \brief SIMPLIFY_MAX_DECIMALS is the largest number of decimals coordinates can be quantized to
+ */
+#define SIMPLIFY_MAX_DECIMALS 6
+
+/*!
+ * \brief The SimplifyOptions struct is how the shapes are reduced before they are written
+ */
+struct SimplifyOptions
+{
+    /*!
+     * \brief The Method enum is the polygon simplification algorithm
+     */
+    enum class Method { None, DouglasPeucker, Visvalingam };
+
+    /*!
+     * \brief SimplifyOptions constructor initialises options that change nothing
+     */
+    SimplifyOptions();
+    /*!
+     * \brief isActive method determines whether the options change the shapes
+     * \return returns true if there is a method or a quantization
+     */
+    bool isActive() const;
+    /*!
+     * \brief methodName method gets the name of a method used on the command line ("none", "dp" or "vw")
+     */
+    static QString methodName(Method method);
+    /*!
+     * \brief methodFromName method gets the method of a command line name
+     * \param name is the name
+     * \param ok receives false if the name is unknown
+     */
+    static Method methodFromName(const QString &name, bool *ok);
+
+    /*!
+     * \brief method is the polygon simplification algorithm
+     */
+    Method method;
+    /*!
+     * \brief tolerance is the largest distance of a removed vertex to the simplified outline for Douglas-Peucker, for Visvalingam the triangles smaller than its square are removed
+     */
+    double tolerance;
+    /*!
+     * \brief decimals is the number of decimals the coordinates are rounded to (0 for integers), -1 to keep them as they are
+     */
+    int decimals;
+};
+
+/*!
+ * \brief The SimplifyReport struct is the reduction achieved by a simplification
+ */
+struct SimplifyReport
+{
+    /*!
+     * \brief SimplifyReport constructor initialises an empty report
+     */
+    SimplifyReport();
+    /*!
+     * \brief add method adds the counts of another report
+     */
+    void add(const SimplifyReport &other);
+    /*!
+     * \brief summary method describes the reduction, such as "1200 -> 310 vertices (-74%), 48 KB -> 9 KB (-81%)"
+     */
+    QString summary() const;
+
+    /*!
+     * \brief files is the number of files simplified
+     */
+    int files;
+    /*!
+     * \brief verticesBefore is the number of polygon vertices before
+     */
+    qint64 verticesBefore;
+    /*!
+     * \brief verticesAfter is the number of polygon vertices after
+     */
+    qint64 verticesAfter;
+    /*!
+     * \brief bytesBefore is the size of the json before
+     */
+    qint64 bytesBefore;
+    /*!
+     * \brief bytesAfter is the size of the json after
+     */
+    qint64 bytesAfter;
+};
+
+/*!
+ * \brief The AnnotationSimplifier class reduces the polygons of annotations and rounds their coordinates, before they are saved or on existing files
+ *
+ * Only the polygons are simplified: collinear points are removed, then Douglas-Peucker or Visvalingam-Whyatt removes the vertices
+ * within the tolerance, a polygon keeps at least three vertices. The quantization rounds the coordinates of every shape, a polygon
+ * vertex made equal to the previous one is then dropped. The byte counts are those of the json the shapes are written as.
+ */
+class AnnotationSimplifier
+{
+public:
+    /*!
+     * \brief simplify method simplifies and quantizes shapes
+     * \param shapes are the shapes, changed in place
+     * \param options are the method, tolerance and decimals
+     * \return returns the vertex and byte counts before and after
+     */
+    static SimplifyReport simplify(QVector<AnnotationShape> *shapes, const SimplifyOptions &options);
+    /*!
+     * \brief simplifyFiles method simplifies annotation files, in parallel
+     * \param fileNames are the json files
+     * \param outputFolder is the folder the files are written to with the same names, empty to overwrite them
+     * \param options are the method, tolerance and decimals
+     * \param errors receives a message per file that could not be done
+     * \return returns the total of the files simplified
+     */
+    static SimplifyReport simplifyFiles(const QStringList &fileNames, const QString &outputFolder, const SimplifyOptions &options, QStringList *errors);
+
+private:
+    /*!
+     * \brief quantize method rounds a coordinate to a number of decimals
+     */
+    static double quantize(double value, double scale);
+};
+
+#endif // ANNOTATIONSIMPLIFIER_H
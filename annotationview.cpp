@@ -0,0 +1,125 @@
+#include "annotationview.h"
+#include "perfcounters.h"
+
+#include <QEvent>
+#include <QPainter>
+#include <QPaintEvent>
+
+AnnotationView::AnnotationView(QWidget *parent) : QGraphicsView(parent), hudVisible(false), pendingInput(-1), inputToPaintNs(0),
+    eventNs(0), frameNs(0), averageFrameNs(0), lastCount(-1), totalItems(0), visibleItems(0)
+{
+    clock.start();
+}
+
+void AnnotationView::setHudVisible(bool visible){
+    hudVisible = visible;
+    lastCount = -1;
+    viewport()->update();
+}
+
+bool AnnotationView::isHudVisible() const{
+    return hudVisible;
+}
+
+bool AnnotationView::isInputEvent(QEvent *event){
+    switch(event->type()){
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool AnnotationView::viewportEvent(QEvent *event){
+
+    if(!hudVisible || !isInputEvent(event))
+        return QGraphicsView::viewportEvent(event);
+
+    qint64 start = clock.nsecsElapsed();
+    if(pendingInput < 0)
+        pendingInput = start;
+
+    bool result = QGraphicsView::viewportEvent(event); //the scene handlers run in here
+    eventNs = clock.nsecsElapsed() - start;
+
+    viewport()->update(hudRect); //the scene only repaints what changed, make sure the overlay is part of it
+    return result;
+}
+
+void AnnotationView::paintEvent(QPaintEvent *event){
+
+    if(!hudVisible){
+        QGraphicsView::paintEvent(event);
+        return;
+    }
+
+    qint64 start = clock.nsecsElapsed();
+    if(pendingInput >= 0){
+        inputToPaintNs = start - pendingInput;
+        pendingInput = -1;
+    }
+
+    QGraphicsView::paintEvent(event);
+
+    //the overlay shows the previous frame, this one is still being painted when it is drawn
+    frameNs = clock.nsecsElapsed() - start;
+    averageFrameNs = averageFrameNs == 0 ? frameNs : averageFrameNs * 0.9 + frameNs * 0.1;
+}
+
+QString AnnotationView::milliseconds(qint64 ns){
+    return QString::number(ns / 1e6, 'f', 1) + " ms";
+}
+
+void AnnotationView::drawForeground(QPainter *painter, const QRectF &rect){
+
+    QGraphicsView::drawForeground(painter, rect);
+    if(!hudVisible || !scene())
+        return;
+
+    qint64 now = clock.nsecsElapsed();
+    if(lastCount < 0 || now - lastCount > qint64(HUD_REFRESH_MS) * 1000000){
+        totalItems = scene()->items().size(); //both build a list of the items, so only done a few times a second
+        visibleItems = items(viewport()->rect()).size();
+        lastCount = now;
+    }
+
+    QStringList lines;
+    lines << "frame " + milliseconds(frameNs) + " (avg " + milliseconds(qint64(averageFrameNs)) + ")";
+    lines << "input to paint " + milliseconds(inputToPaintNs) + ", event " + milliseconds(eventNs);
+    lines << "items " + QString::number(totalItems) + ", visible " + QString::number(visibleItems);
+    lines << "image cache " + QString::number(PerfCounters::imageCacheBytes.load(std::memory_order_relaxed) >> 20) + " / "
+             + QString::number(PerfCounters::imageCacheLimit.load(std::memory_order_relaxed) >> 20) + " MB ("
+             + QString::number(PerfCounters::imageCacheCount.load(std::memory_order_relaxed)) + " images)";
+    lines << "image load " + milliseconds(PerfCounters::lastImageLoadNs.load(std::memory_order_relaxed))
+             + ", annotation load " + milliseconds(PerfCounters::lastLoadNs.load(std::memory_order_relaxed))
+             + ", save " + milliseconds(PerfCounters::lastSaveNs.load(std::memory_order_relaxed));
+
+    //drawn in viewport coordinates so it stays in the corner whatever the zoom and scroll
+    painter->save();
+    painter->resetTransform();
+
+    QFont font = painter->font();
+    font.setStyleHint(QFont::Monospace);
+    font.setFamily("monospace");
+    painter->setFont(font);
+
+    QFontMetrics metrics(font);
+    int width = 0;
+    for(const QString &line : lines)
+        width = qMax(width, metrics.horizontalAdvance(line));
+
+    QRect box(8, 8, width + 12, metrics.height() * lines.size() + 8);
+    hudRect = box.adjusted(0, 0, 32, 0); //room for the values to grow
+    painter->fillRect(box, QColor(0, 0, 0, 160));
+    painter->setPen(Qt::white);
+    for(int i = 0; i < lines.size(); i++)
+        painter->drawText(box.left() + 6, box.top() + 4 + metrics.ascent() + i * metrics.height(), lines[i]);
+
+    painter->restore();
+}
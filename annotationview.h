@@ -0,0 +1,105 @@
+#ifndef ANNOTATIONVIEW_H
+#define ANNOTATIONVIEW_H
+
+#include <QGraphicsView>
+#include <QElapsedTimer>
+
+/*!
+ * \brief HUD_REFRESH_MS is how often the slower overlay values (total and visible items) are recounted
+ */
+#define HUD_REFRESH_MS 250
+
+/*!
+ * \brief The AnnotationView class is the view displaying the scene, it can draw a performance overlay (frame time, input to paint latency, event handling time, item counts, image cache usage and the last load and save times)
+ */
+class AnnotationView : public QGraphicsView
+{
+public:
+    /*!
+     * \brief AnnotationView constructor
+     * \param parent is the parent widget
+     */
+    AnnotationView(QWidget *parent = nullptr);
+    /*!
+     * \brief setHudVisible method shows or hides the performance overlay
+     * \param visible is true to show it
+     */
+    void setHudVisible(bool visible);
+    /*!
+     * \brief isHudVisible method determines whether the performance overlay is shown
+     * \return returns true if it is shown
+     */
+    bool isHudVisible() const;
+
+protected:
+    /*!
+     * \brief viewportEvent method times the handling of the mouse and key events and remembers when the first event since the last paint arrived
+     */
+    bool viewportEvent(QEvent *event) override;
+    /*!
+     * \brief paintEvent method times the painting of the view
+     */
+    void paintEvent(QPaintEvent *event) override;
+    /*!
+     * \brief drawForeground method draws the performance overlay over the scene
+     */
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
+
+private:
+    /*!
+     * \brief isInputEvent method determines whether an event is a mouse, wheel or key event
+     */
+    static bool isInputEvent(QEvent *event);
+    /*!
+     * \brief milliseconds method formats a time in nanoseconds as milliseconds
+     */
+    static QString milliseconds(qint64 ns);
+
+private:
+    /*!
+     * \brief hudVisible is true when the overlay is drawn
+     */
+    bool hudVisible;
+    /*!
+     * \brief clock is the time base of the view timings
+     */
+    QElapsedTimer clock;
+    /*!
+     * \brief pendingInput is the time the first input event since the last paint arrived, -1 if there is none
+     */
+    qint64 pendingInput;
+    /*!
+     * \brief inputToPaintNs is the time from the first input event to the start of the paint that showed it
+     */
+    qint64 inputToPaintNs;
+    /*!
+     * \brief eventNs is the time taken to handle the last input event (scene handlers included)
+     */
+    qint64 eventNs;
+    /*!
+     * \brief frameNs is the time taken to paint the last frame
+     */
+    qint64 frameNs;
+    /*!
+     * \brief averageFrameNs is the moving average of the frame time
+     */
+    double averageFrameNs;
+    /*!
+     * \brief lastCount is the time the items were last counted
+     */
+    qint64 lastCount;
+    /*!
+     * \brief totalItems is the number of items of the scene at the last count
+     */
+    int totalItems;
+    /*!
+     * \brief visibleItems is the number of items in the viewport at the last count
+     */
+    int visibleItems;
+    /*!
+     * \brief hudRect is the viewport area covered by the overlay
+     */
+    QRect hudRect;
+};
+
+#endif // ANNOTATIONVIEW_H
@@ -0,0 +1,482 @@
+#include "benchmark.h"
+#include "syntheticdata.h"
+#include "imagecatalog.h"
+#include "imageindex.h"
+#include "imagelistmodel.h"
+#include "classindex.h"
+#include "annotationfile.h"
+#include "scene.h"
+#include "magicwand.h"
+#include "gradientmap.h"
+#include "livewire.h"
+#include "templatematcher.h"
+#include "maskrasterizer.h"
+#include "annotationsimplifier.h"
+#include "geometry.h"
+#include "overlapchecker.h"
+#include "agreementengine.h"
+#include "datasetstatistics.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QPixmap>
+#include <QPainter>
+#include <QGraphicsSceneMouseEvent>
+#include <QKeyEvent>
+#include <QTextStream>
+
+#include <algorithm>
+
+#define BENCHMARK_MAX_REPETITIONS   1000
+
+Benchmark::Benchmark(const QList<int> &theSizes, int theMinTime) : sizes(theSizes), minTime(theMinTime)
+{
+}
+
+void Benchmark::measure(const QString &name, int size, int operations, const std::function<void()> &body){
+
+    body(); //warm up caches and lazy initialisation
+
+    QVector<qint64> times;
+    QElapsedTimer total;
+    total.start();
+    while(times.size() < BENCHMARK_MAX_REPETITIONS && (times.size() < 3 || total.elapsed() < minTime)){
+        QElapsedTimer timer;
+        timer.start();
+        body();
+        times.append(timer.nsecsElapsed());
+    }
+
+    std::sort(times.begin(), times.end());
+    double perOp = 1.0 / qMax(operations, 1);
+
+    QJsonObject result;
+    result.insert("name", name);
+    result.insert("size", size);
+    result.insert("operations", operations);
+    result.insert("repetitions", times.size());
+    result.insert("median_ns_per_op", times[times.size() / 2] * perOp);
+    result.insert("min_ns_per_op", times.first() * perOp);
+    result.insert("max_ns_per_op", times.last() * perOp);
+    results.append(result);
+
+    QTextStream(stderr) << name << " [" << size << "]: " << times[times.size() / 2] * perOp << " ns/op\n";
+}
+
+void Benchmark::skip(const QString &name, int size, const QString &reason){
+    QJsonObject result;
+    result.insert("name", name);
+    result.insert("size", size);
+    result.insert("skipped", reason);
+    results.append(result);
+}
+
+void Benchmark::benchCatalog(int size){
+
+    QVector<Image> images = SyntheticData(size).images(size);
+
+    measure("catalog.insert", size, size, [&]() {
+        ImageCatalog catalog;
+        catalog.add(images);
+    });
+
+    measure("catalog.index_insert", size, size, [&]() {
+        ImageIndex index;
+        for(const Image &img : images)
+            index.insert(img.getPath(), img.getName(), img.getDate());
+    });
+
+    ImageCatalog catalog;
+    catalog.add(images);
+    ImageIndex index;
+    for(const Image &img : images)
+        index.insert(img.getPath(), img.getName(), img.getDate());
+
+    QStringList keys;
+    for(int i = 0; i < 100; i++)
+        keys.append(images[(i * 7919) % size].getKey());
+
+    measure("catalog.lookup_key", size, keys.size(), [&]() {
+        for(const QString &key : keys)
+            catalog.contains(key);
+    });
+
+    measure("catalog.snapshot_read", size, 1, [&]() {
+        ImageCatalog::Snapshot snapshot = catalog.snapshot();
+        qint64 total = 0;
+        for(int i = 0; i < snapshot.size(); i++)
+            total += snapshot.at(i).getName().size();
+        Q_UNUSED(total)
+    });
+
+    //A single import while a reader holds a snapshot, only the last chunk is copied
+    int extra = 0;
+    measure("catalog.append_one", size, 1, [&]() {
+        ImageCatalog::Snapshot reader = catalog.snapshot();
+        QString name = "extra_" + QString::number(extra++) + ".jpg";
+        catalog.add(QVector<Image>() << Image(name, "/synthetic/" + name, QDateTime::currentDateTime()));
+        Q_UNUSED(reader)
+    });
+
+    measure("catalog.filter_substring", size, 1, [&]() {
+        index.filter("frame_00001");
+    });
+
+    measure("catalog.filter_glob_status", size, 1, [&]() {
+        index.filter("cam3/*7.jpg is:unannotated");
+    });
+
+    measure("catalog.sort_name", size, 1, [&]() {
+        ImageCatalog unsorted;
+        unsorted.add(images);
+        unsorted.sort(ImageCatalog::Order::NameAscending);
+    });
+
+    measure("catalog.sort_date", size, 1, [&]() {
+        ImageCatalog unsorted;
+        unsorted.add(images);
+        unsorted.sort(ImageCatalog::Order::DateAscending);
+    });
+}
+
+void Benchmark::benchPane(int size){
+
+    ImageCatalog catalog;
+    catalog.add(SyntheticData(size).images(size));
+
+    ImageListModel model;
+    measure("pane.populate", size, 1, [&]() {
+        model.setImages(catalog.snapshot().items());
+    });
+}
+
+void Benchmark::benchClasses(int size){
+
+    QStringList names = SyntheticData(size).classNames(size);
+
+    measure("classes.index_insert", size, size, [&]() {
+        ClassIndex index;
+        for(const QString &name : names)
+            index.insert(name);
+    });
+
+    ClassIndex index;
+    for(const QString &name : names)
+        index.insert(name);
+
+    QStringList queries;
+    queries << "v" << "car" << "vehcle/car" << "k123";
+    measure("classes.search", size, queries.size(), [&]() {
+        for(const QString &q : queries)
+            index.search(q, 200);
+    });
+}
+
+void Benchmark::benchAnnotations(int shapes, int vertices){
+
+    SyntheticData data(shapes + vertices);
+    QStringList classes = data.classNames(50);
+    QVector<AnnotationShape> shapeList = data.shapes(shapes, vertices, classes);
+    QByteArray json = AnnotationFile::serialize(shapeList);
+    QString name = QString("annotations.%1_vertices").arg(vertices);
+
+    measure(name + ".serialize", shapes, shapes, [&]() {
+        AnnotationFile::serialize(shapeList);
+    });
+
+    measure(name + ".parse", shapes, shapes, [&]() {
+        AnnotationFile::parse(json);
+    });
+
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("roundtrip.json");
+    measure(name + ".file_roundtrip", shapes, shapes, [&]() {
+        QVector<AnnotationShape> loaded;
+        AnnotationFile::write(fileName, shapeList);
+        AnnotationFile::read(fileName, &loaded);
+    });
+
+    //the masks of a 1080p image, scaled from the scene coordinates
+    MaskRasterizer rasterizer(classes);
+    measure(name + ".mask_1080p", shapes, 1, [&]() {
+        rasterizer.rasterize(shapeList, QSize(1920, 1080));
+    });
+
+    //simplified and rounded to one decimal as when saving, the copy is part of the time
+    SimplifyOptions options;
+    options.decimals = 1;
+    for(SimplifyOptions::Method method : {SimplifyOptions::Method::DouglasPeucker, SimplifyOptions::Method::Visvalingam}){
+        options.method = method;
+        measure(name + ".simplify_" + SimplifyOptions::methodName(method), shapes, shapes, [&]() {
+            QVector<AnnotationShape> copy = shapeList;
+            AnnotationSimplifier::simplify(&copy, options);
+        });
+    }
+}
+
+void Benchmark::benchScene(int shapes){
+
+    SyntheticData data(shapes);
+    QVector<AnnotationShape> shapeList = data.shapes(shapes, 32, data.classNames(50));
+
+    measure("scene.load", shapes, shapes, [&]() {
+        Scene scene;
+        scene.addPixmap(QPixmap(1000, 800));
+        scene.addShapes(shapeList);
+    });
+
+    Scene scene;
+    scene.addPixmap(QPixmap(1000, 800));
+    scene.addShapes(shapeList);
+
+    measure("scene.collect_shapes", shapes, shapes, [&]() {
+        scene.shapes();
+    });
+
+    //A press in select mode makes every shape selectable (setSelectable)
+    scene.setMode(Scene::Mode::SelectObject);
+    measure("scene.press_select_mode", shapes, 1, [&]() {
+        QGraphicsSceneMouseEvent press(QEvent::GraphicsSceneMousePress);
+        press.setScenePos(QPointF(-10, -10));
+        press.setButton(Qt::LeftButton);
+        press.setButtons(Qt::LeftButton);
+        QCoreApplication::sendEvent(&scene, &press);
+
+        QGraphicsSceneMouseEvent release(QEvent::GraphicsSceneMouseRelease);
+        release.setScenePos(QPointF(-10, -10));
+        release.setButton(Qt::LeftButton);
+        QCoreApplication::sendEvent(&scene, &release);
+    });
+
+    //Drag a vertex of the first polygon in edit mode (editPolygon)
+    QGraphicsItem *polygon = nullptr;
+    for(QGraphicsItem *item : scene.items()){
+        if(item->type() == QGraphicsPolygonItem::Type)
+            polygon = item;
+    }
+    if(!polygon){
+        skip("scene.edit_polygon_move", shapes, "no polygon");
+        return;
+    }
+
+    polygon->setFlag(QGraphicsItem::ItemIsSelectable, true);
+    scene.clearSelection();
+    polygon->setSelected(true);
+    QKeyEvent control(QEvent::KeyPress, Qt::Key_Control, Qt::ControlModifier);
+    QCoreApplication::sendEvent(&scene, &control);
+
+    QPointF start = polygon->boundingRect().center();
+    measure("scene.edit_polygon_move", shapes, 100, [&]() {
+        for(int i = 0; i < 100; i++){
+            QGraphicsSceneMouseEvent move(QEvent::GraphicsSceneMouseMove);
+            move.setScenePos(start + QPointF(i % 10, i / 10));
+            move.setButtons(Qt::LeftButton);
+            QCoreApplication::sendEvent(&scene, &move);
+        }
+    });
+}
+
+void Benchmark::benchTools(){
+
+    QImage image = SyntheticData().picture(1000, 800, 40);
+    int pixels = image.width() * image.height();
+
+    MagicWand wand;
+    wand.setImage(image);
+
+    //an object and the background (the largest region, most of the image)
+    measure("tools.magic_wand_object", pixels, 1, [&]() {
+        wand.select(QPoint(500, 400), WAND_TOLERANCE);
+    });
+    measure("tools.magic_wand_background", pixels, 1, [&]() {
+        wand.select(QPoint(0, 0), WAND_TOLERANCE);
+    });
+
+    measure("tools.gradient_map", pixels, 1, [&]() {
+        GradientMap::compute(image);
+    });
+
+    //one snap per mouse event, over the whole image
+    GradientMap gradient = GradientMap::compute(image);
+    measure("tools.edge_snap", pixels, 1000, [&]() {
+        for(int i = 0; i < 1000; i++)
+            gradient.snap(QPointF(i % 1000, (i * 7) % 800));
+    });
+
+    //the path from an anchor to points farther and farther away, the search restarts for each repetition
+    LiveWire wire;
+    wire.setGradient(gradient);
+    measure("tools.live_wire", pixels, 100, [&]() {
+        wire.setAnchor(QPointF(500, 400));
+        for(int i = 1; i <= 100; i++)
+            wire.pathTo(QPointF(500 + i * 3, 400 + i * 2));
+    });
+
+    //a 120x80 box followed into the next frame, the camera moved a few pixels
+    QImage next(image.size(), image.format());
+    next.fill(Qt::black);
+    {
+        QPainter painter(&next);
+        painter.drawImage(QPoint(6, -4), image);
+    }
+    TemplateMatcher first(image);
+    TemplateMatcher second(next);
+    measure("tools.match_pyramid", pixels, 1, [&]() {
+        TemplateMatcher pyramid(next);
+    });
+    QRectF box(440, 360, 120, 80);
+    measure("tools.match_box", pixels, 1, [&]() {
+        second.locate(first, box, box);
+    });
+}
+
+void Benchmark::benchGeometry(int shapes, int vertices){
+
+    SyntheticData data(shapes * vertices);
+    QVector<AnnotationShape> shapeList = data.shapes(shapes, vertices, QStringList());
+    QVector<QPolygonF> outlines;
+    for(const AnnotationShape &shape : shapeList)
+        outlines.append(MaskRasterizer::outline(shape));
+    QString name = QString("geometry.%1_vertices").arg(vertices);
+
+    measure(name + ".area", shapes, shapes, [&]() {
+        for(const QPolygonF &outline : outlines)
+            Geometry::area(outline);
+    });
+    measure(name + ".convex", shapes, shapes, [&]() {
+        for(const QPolygonF &outline : outlines)
+            Geometry::isConvex(outline);
+    });
+    measure(name + ".bounding_rects", shapes, shapes, [&]() {
+        Geometry::boundingRects(outlines);
+    });
+
+    //a mouse position against every outline, as when picking a vertex or testing a click
+    QPointF mouse(SCENE_WIDTH / 2, SCENE_HEIGHT / 2);
+    measure(name + ".nearest_point", shapes, shapes, [&]() {
+        for(const QPolygonF &outline : outlines)
+            Geometry::nearestPoint(outline, mouse);
+    });
+    measure(name + ".contains", shapes, shapes, [&]() {
+        for(const QPolygonF &outline : outlines)
+            Geometry::contains(outline, mouse);
+    });
+
+    //each outline with the next one, most pairs are rejected by their bounding boxes
+    measure(name + ".iou_neighbours", shapes, shapes, [&]() {
+        for(int i = 0; i + 1 < outlines.size(); i++)
+            Geometry::iou(outlines[i], outlines[i + 1]);
+    });
+    //each outline with a shifted copy, the pairs always overlap
+    QVector<QPolygonF> shifted;
+    for(const QPolygonF &outline : outlines)
+        shifted.append(outline.translated(5, 3));
+    measure(name + ".iou_overlapping", shapes, shapes, [&]() {
+        for(int i = 0; i < outlines.size(); i++)
+            Geometry::iou(outlines[i], shifted[i]);
+    });
+    measure(name + ".rotated_rect_iou", shapes, shapes, [&]() {
+        for(int i = 0; i < shapes; i++)
+            Geometry::iou(QRectF(i % 500, 100, 120, 80), i % 90, QRectF(i % 500 + 10, 105, 110, 90), 0);
+    });
+}
+
+void Benchmark::benchOverlaps(int shapes, int vertices){
+
+    //the check run on the scene after every change, every tenth shape drawn twice
+    SyntheticData data(shapes * vertices);
+    QVector<AnnotationShape> shapeList = data.shapes(shapes, vertices, QStringList());
+    for(int i = 0; i < shapes; i += 10)
+        shapeList.append(shapeList[i]);
+    measure(QString("overlaps.%1_vertices.check").arg(vertices), shapeList.size(), 1, [&]() {
+        OverlapChecker::check(shapeList);
+    });
+}
+
+QVector<QVector<AnnotationShape> > Benchmark::annotatorSets(int shapes, int vertices){
+
+    //a second annotator: every shape a few pixels away, every seventh one left out, the shapes spread over 20 classes
+    SyntheticData data(shapes * vertices);
+    QVector<AnnotationShape> shapeList = data.shapes(shapes, vertices, QStringList());
+    QVector<QVector<AnnotationShape> > sets(2);
+    for(int i = 0; i < shapeList.size(); i++){
+        AnnotationShape shape = shapeList[i];
+        shape.object = QString("class%1").arg(i % 20);
+        sets[0].append(shape);
+        if(i % 7 == 6)
+            continue;
+        for(int c = 0; c < shape.coordinates.size() && (shape.type != SHAPE_RECT || c < 2); c++)
+            shape.coordinates[c] += 2;
+        sets[1].append(shape);
+    }
+    return sets;
+}
+
+void Benchmark::benchAgreement(int shapes, int vertices){
+
+    QVector<QVector<AnnotationShape> > sets = annotatorSets(shapes, vertices);
+    measure(QString("agreement.%1_vertices.compare_image").arg(vertices), shapes, 1, [&]() {
+        QHash<QString, ClassAgreement> classes;
+        AgreementEngine::compareImage(sets, AGREEMENT_IOU_THRESHOLD, &classes);
+    });
+}
+
+void Benchmark::benchStatistics(int shapes, int vertices){
+
+    //what the scene does after every change: measure its shapes and replace them in the statistics of a 1000 image dataset
+    QVector<QVector<AnnotationShape> > sets = annotatorSets(shapes, vertices);
+    QString name = QString("statistics.%1_vertices").arg(vertices);
+    measure(name + ".measure", shapes, 1, [&]() {
+        ImageStatistics::measure(sets[0]);
+    });
+    DatasetStatistics statistics;
+    QStringList paths;
+    for(int i = 0; i < 1000; i++)
+        paths.append(QString("image%1.jpg").arg(i));
+    statistics.seed(paths, QVector<ImageStatistics>(paths.size(), ImageStatistics::measure(sets[0])));
+    ImageStatistics edited[2] = { ImageStatistics::measure(sets[0]), ImageStatistics::measure(sets[1]) };
+    int edit = 0;
+    measure(name + ".update", shapes, 1, [&]() {
+        statistics.setUnsaved(paths[0], edited[++edit % 2]); //alternating, an unchanged contribution returns early
+    });
+}
+
+QJsonObject Benchmark::run(){
+
+    results = QJsonArray();
+
+    for(int size : sizes){
+        benchCatalog(size);
+        benchPane(size);
+        benchClasses(qMin(size, 50000));
+    }
+
+    benchAnnotations(100, 8);
+    benchAnnotations(1000, 8);
+    benchAnnotations(100, 256);
+    benchScene(100);
+    benchScene(1000);
+    benchTools();
+    benchGeometry(1000, 8);
+    benchGeometry(100, 256);
+    benchOverlaps(1000, 8);
+    benchOverlaps(100, 256);
+    benchAgreement(1000, 8);
+    benchAgreement(100, 256);
+    benchStatistics(1000, 8);
+    benchStatistics(100, 256);
+
+    QJsonObject report;
+    report.insert("application", QCoreApplication::applicationName());
+    report.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("qtVersion", QString(qVersion()));
+    report.insert("cpu", QSysInfo::currentCpuArchitecture());
+    report.insert("os", QSysInfo::prettyProductName());
+    report.insert("threads", QThread::idealThreadCount());
+    report.insert("results", results);
+    return report;
+}
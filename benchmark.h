@@ -0,0 +1,105 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "annotationfile.h"
+
+#include <QString>
+#include <QList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVector>
+
+#include <functional>
+
+/*!
+ * \brief The Benchmark class times the catalog, class search, image pane, annotation file, scene and image tool code on synthetic data and reports the results as json, so runs of different builds can be compared
+ */
+class Benchmark
+{
+public:
+    /*!
+     * \brief Benchmark constructor sets the problem sizes to run
+     * \param theSizes are the catalog sizes (e.g. 10000 and 100000), the annotation and scene cases are sized from them
+     * \param theMinTime is how long each case is repeated for, in milliseconds
+     */
+    Benchmark(const QList<int> &theSizes, int theMinTime);
+    /*!
+     * \brief run method runs every case
+     * \return returns the report (build information plus one result per case and size)
+     */
+    QJsonObject run();
+
+private:
+    /*!
+     * \brief measure method repeats a case until the minimum time is reached and records the time per operation (median and minimum over the repetitions)
+     * \param name is the case name
+     * \param size is the problem size
+     * \param operations is the number of operations done by one call of body
+     * \param body runs the case once
+     */
+    void measure(const QString &name, int size, int operations, const std::function<void()> &body);
+    /*!
+     * \brief skip method records a case that is not run at a size, with the reason
+     */
+    void skip(const QString &name, int size, const QString &reason);
+    /*!
+     * \brief benchCatalog method times catalog insert, lookup, filter and sort
+     */
+    void benchCatalog(int size);
+    /*!
+     * \brief benchPane method times filling the image pane
+     */
+    void benchPane(int size);
+    /*!
+     * \brief benchClasses method times building and searching the class index
+     */
+    void benchClasses(int size);
+    /*!
+     * \brief benchAnnotations method times json annotation save and load round trips
+     */
+    void benchAnnotations(int shapes, int vertices);
+    /*!
+     * \brief benchScene method times loading shapes into the scene, collecting them for saving and the mouse handlers
+     */
+    void benchScene(int shapes);
+    /*!
+     * \brief benchTools method times the tools that look at the image pixels on a synthetic 1000x800 image
+     */
+    void benchTools();
+    /*!
+     * \brief benchGeometry method times the geometry routines over the outlines of synthetic shapes
+     */
+    void benchGeometry(int shapes, int vertices);
+    /*!
+     * \brief benchOverlaps method times the duplicate and class conflict check run on the scene after every change
+     */
+    void benchOverlaps(int shapes, int vertices);
+    /*!
+     * \brief benchAgreement method times matching the shapes of two annotators on one image
+     */
+    void benchAgreement(int shapes, int vertices);
+    /*!
+     * \brief benchStatistics method times measuring the shapes of an image and replacing them in the dataset statistics
+     */
+    void benchStatistics(int shapes, int vertices);
+    /*!
+     * \brief annotatorSets method gets synthetic shapes and a second annotator's copy of them, shifted and with some left out
+     */
+    static QVector<QVector<AnnotationShape> > annotatorSets(int shapes, int vertices);
+
+private:
+    /*!
+     * \brief sizes are the catalog sizes to run
+     */
+    QList<int> sizes;
+    /*!
+     * \brief minTime is the minimum time spent on each case, in milliseconds
+     */
+    int minTime;
+    /*!
+     * \brief results stores one object per case
+     */
+    QJsonArray results;
+};
+
+#endif // BENCHMARK_H
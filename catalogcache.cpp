@@ -0,0 +1,107 @@
+#include "catalogcache.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#define CATALOG_CACHE_MAGIC     0x4c434348
+#define CATALOG_CACHE_VERSION   3
+
+CatalogEntry::CatalogEntry() : size(-1), modified(0), perceptualHash(0), hasPerceptualHash(false), captured(-1), width(0), height(0), hasMetadata(false)
+{
+}
+
+QDataStream &operator<<(QDataStream &out, const CatalogEntry &entry){
+    out << entry.path << entry.size << entry.modified << entry.contentHash << entry.perceptualHash << entry.hasPerceptualHash
+        << entry.captured << entry.width << entry.height << entry.hasMetadata;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, CatalogEntry &entry){
+    in >> entry.path >> entry.size >> entry.modified >> entry.contentHash >> entry.perceptualHash >> entry.hasPerceptualHash
+       >> entry.captured >> entry.width >> entry.height >> entry.hasMetadata;
+    return in;
+}
+
+CatalogCache::CatalogCache() : changed(false)
+{
+}
+
+bool CatalogCache::load(const QString &fileName){
+
+    TRACE_SCOPE("load catalog cache", "import");
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32 magic, version;
+    in >> magic >> version;
+    if(magic != CATALOG_CACHE_MAGIC || version != CATALOG_CACHE_VERSION)
+        return false; //written by another version, it is rebuilt as images are imported
+
+    QHash<QString, CatalogEntry> loaded;
+    in >> loaded;
+    if(in.status() != QDataStream::Ok)
+        return false;
+
+    QMutexLocker locker(&mutex);
+    entries = loaded;
+    changed = false;
+    return true;
+}
+
+bool CatalogCache::save(const QString &fileName){
+
+    QMutexLocker locker(&mutex);
+    if(!changed)
+        return true;
+
+    TRACE_SCOPE("save catalog cache", "import");
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName); //written to a temporary file and renamed, so a crash never leaves half a cache
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out << quint32(CATALOG_CACHE_MAGIC) << quint32(CATALOG_CACHE_VERSION) << entries;
+
+    if(!file.commit())
+        return false;
+
+    changed = false;
+    return true;
+}
+
+bool CatalogCache::lookup(CatalogEntry *entry) const{
+
+    QMutexLocker locker(&mutex);
+
+    QHash<QString, CatalogEntry>::const_iterator it = entries.constFind(entry->path);
+    if(it == entries.constEnd() || it->size != entry->size || it->modified != entry->modified)
+        return false;
+
+    *entry = it.value();
+    return true;
+}
+
+void CatalogCache::insert(const CatalogEntry &entry){
+    QMutexLocker locker(&mutex);
+    entries.insert(entry.path, entry);
+    changed = true;
+}
+
+int CatalogCache::size() const{
+    QMutexLocker locker(&mutex);
+    return entries.size();
+}
+
+QString CatalogCache::defaultLocation(){
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/catalog.cache";
+}
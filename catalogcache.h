@@ -0,0 +1,124 @@
+#ifndef CATALOGCACHE_H
+#define CATALOGCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QDataStream>
+#include <QMutex>
+
+/*!
+ * \brief The CatalogEntry struct holds what is known about an image file on disk, the size and modification time tell whether the cached values are still valid
+ */
+struct CatalogEntry
+{
+    /*!
+     * \brief CatalogEntry constructor initialises an entry with no file
+     */
+    CatalogEntry();
+    /*!
+     * \brief path is the full image path
+     */
+    QString path;
+    /*!
+     * \brief size is the file size in bytes
+     */
+    qint64 size;
+    /*!
+     * \brief modified is the last modification time in milliseconds since epoch
+     */
+    qint64 modified;
+    /*!
+     * \brief contentHash is the hash of the file content, empty when it hasn't been computed
+     */
+    QByteArray contentHash;
+    /*!
+     * \brief perceptualHash is the difference hash of the decoded image, valid when hasPerceptualHash is true
+     */
+    quint64 perceptualHash;
+    /*!
+     * \brief hasPerceptualHash is true when perceptualHash has been computed
+     */
+    bool hasPerceptualHash;
+    /*!
+     * \brief captured is the capture time read from the file header in milliseconds since epoch, -1 when the file has none
+     */
+    qint64 captured;
+    /*!
+     * \brief width is the image width read from the file header, 0 when not known
+     */
+    int width;
+    /*!
+     * \brief height is the image height read from the file header, 0 when not known
+     */
+    int height;
+    /*!
+     * \brief hasMetadata is true when captured, width and height have been read
+     */
+    bool hasMetadata;
+};
+
+QDataStream &operator<<(QDataStream &out, const CatalogEntry &entry);
+QDataStream &operator>>(QDataStream &in, CatalogEntry &entry);
+
+/*!
+ * \brief The CatalogCache class keeps the computed values of image files between sessions (keyed by path and validated with size and modification time) so importing the same files again doesn't read them again
+ *
+ * The methods can be called from any thread (background imports and the gui share the cache).
+ */
+class CatalogCache
+{
+public:
+    /*!
+     * \brief CatalogCache constructor creates an empty cache
+     */
+    CatalogCache();
+    /*!
+     * \brief load method reads the cache from a file, a missing or incompatible file leaves the cache empty
+     * \param fileName is the cache file
+     * \return returns true if the cache was read
+     */
+    bool load(const QString &fileName);
+    /*!
+     * \brief save method writes the cache to a file if it has changed since it was loaded
+     * \param fileName is the cache file
+     * \return returns true if the file is up to date
+     */
+    bool save(const QString &fileName);
+    /*!
+     * \brief lookup method fills in the cached values of an entry when the path, size and modification time all match (values that were never computed stay empty)
+     * \param entry is the entry with path, size and modified already set
+     * \return returns true if the cached values were used
+     */
+    bool lookup(CatalogEntry *entry) const;
+    /*!
+     * \brief insert method adds or replaces the entry of a file
+     * \param entry is the entry to store
+     */
+    void insert(const CatalogEntry &entry);
+    /*!
+     * \brief size method gets the number of cached files
+     */
+    int size() const;
+    /*!
+     * \brief defaultLocation method gets the cache file used by the application
+     * \return returns the path of the cache file
+     */
+    static QString defaultLocation();
+
+private:
+    /*!
+     * \brief entries maps an image path to its entry
+     */
+    QHash<QString, CatalogEntry> entries;
+    /*!
+     * \brief changed is true when entries were inserted since the last load or save
+     */
+    bool changed;
+    /*!
+     * \brief mutex protects entries and changed
+     */
+    mutable QMutex mutex;
+};
+
+#endif // CATALOGCACHE_H
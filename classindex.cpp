@@ -0,0 +1,218 @@
+#include "classindex.h"
+#include "memorystats.h"
+
+#include <algorithm>
+
+ClassIndex::ClassIndex() : removedCount(0)
+{
+}
+
+QString ClassIndex::fold(const QString &name){
+    return name.toLower();
+}
+
+quint64 ClassIndex::trigramKey(const QChar *c){
+    return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | quint64(c[2].unicode());
+}
+
+QVector<quint64> ClassIndex::trigrams(const QString &folded){
+
+    QVector<quint64> keys;
+    for(int i = 0; i + 3 <= folded.size(); i++){
+        keys.append(trigramKey(folded.constData() + i));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+int ClassIndex::lowerBound(const QString &folded) const{
+
+    QVector<int>::const_iterator it = std::lower_bound(sortedIds.constBegin(), sortedIds.constEnd(), folded,
+                                                       [this](int id, const QString &text) {
+        return foldedNames[id] < text;
+    });
+    return int(it - sortedIds.constBegin());
+}
+
+void ClassIndex::insert(const QString &className){
+
+    if(className.isEmpty() || ids.contains(className))
+        return;
+
+    int id = names.size();
+    QString folded = fold(className);
+
+    names.append(className);
+    foldedNames.append(folded);
+    alive.append(true);
+    ids.insert(className, id);
+    sortedIds.insert(lowerBound(folded), id);
+
+    for(quint64 key : trigrams(folded)){
+        postings[key].append(id); //ids only grow, so the posting lists stay sorted
+    }
+}
+
+void ClassIndex::remove(const QString &className){
+
+    QHash<QString, int>::iterator it = ids.find(className);
+    if(it == ids.end())
+        return;
+
+    int id = it.value();
+    ids.erase(it);
+    alive[id] = false;
+
+    for(int i = lowerBound(foldedNames[id]); i < sortedIds.size(); i++){
+        if(sortedIds[i] == id){
+            sortedIds.remove(i);
+            break;
+        }
+    }
+
+    removedCount++;
+    compact();
+}
+
+void ClassIndex::clear(){
+    names.clear();
+    foldedNames.clear();
+    alive.clear();
+    ids.clear();
+    sortedIds.clear();
+    postings.clear();
+    removedCount = 0;
+}
+
+int ClassIndex::size() const{
+    return ids.size();
+}
+
+void ClassIndex::compact(){
+
+    //Removed ids are only skipped while searching, rebuild once they take up half of the index
+    if(removedCount < 64 || removedCount * 2 < names.size())
+        return;
+
+    QVector<QString> liveNames;
+    for(int i = 0; i < names.size(); i++){
+        if(alive[i])
+            liveNames.append(names[i]);
+    }
+
+    clear();
+    for(const QString &name : liveNames)
+        insert(name);
+}
+
+int ClassIndex::scoreName(const QString &folded, const QString &query){
+
+    if(folded == query)
+        return 1000;
+
+    int extra = qMin(folded.size() - query.size(), 99);
+    if(folded.startsWith(query))
+        return 900 - extra;
+
+    int best = 0;
+    int idx = folded.indexOf(query);
+    while(idx > 0){
+        QChar before = folded.at(idx - 1);
+        if(before == '/' || before == '_' || before == '-' || before == '.' || before.isSpace()){
+            return 800 - extra; //start of a segment, e.g. "sed" in "vehicle/car/sedan"
+        }
+        if(best == 0)
+            best = 700 - qMin(idx, 99);
+        idx = folded.indexOf(query, idx + 1);
+    }
+    return best;
+}
+
+QStringList ClassIndex::search(const QString &query, int limit) const{
+
+    QStringList result;
+    QString q = fold(query.trimmed());
+    if(q.isEmpty() || limit <= 0)
+        return result;
+
+    QVector<Match> matches;
+
+    if(q.size() < 3){
+        //Too short for trigrams. Prefix matches come from the sorted order and rank first,
+        //so the linear scan is only needed when they don't fill the result.
+        for(int i = lowerBound(q); i < sortedIds.size(); i++){
+            int id = sortedIds[i];
+            if(!foldedNames[id].startsWith(q))
+                break;
+            matches.append(Match{id, scoreName(foldedNames[id], q)});
+        }
+
+        if(matches.size() < limit){
+            matches.clear();
+            for(int id : sortedIds){
+                int score = scoreName(foldedNames[id], q);
+                if(score > 0)
+                    matches.append(Match{id, score});
+            }
+        }
+    }else{
+        //Count the query trigrams shared by each name. Names sharing all of them are checked
+        //for a real substring, the rest are typo tolerant matches ranked by similarity.
+        QVector<quint64> queryGrams = trigrams(q);
+        QVector<quint16> shared(names.size(), 0);
+        QVector<int> touched;
+
+        for(quint64 key : queryGrams){
+            QHash<quint64, QVector<int> >::const_iterator it = postings.constFind(key);
+            if(it == postings.constEnd())
+                continue;
+            for(int id : it.value()){
+                if(!alive[id])
+                    continue;
+                if(shared[id]++ == 0)
+                    touched.append(id);
+            }
+        }
+
+        int needed = queryGrams.size();
+        for(int id : touched){
+            int score = 0;
+            if(shared[id] == needed)
+                score = scoreName(foldedNames[id], q);
+
+            if(score == 0 && shared[id] * 2 >= needed){
+                int nameGrams = qMax(foldedNames[id].size() - 2, 1);
+                score = 100 + (400 * shared[id]) / qMax(needed, nameGrams);
+            }
+            if(score > 0)
+                matches.append(Match{id, score});
+        }
+    }
+
+    auto better = [this](const Match &a, const Match &b) {
+        if(a.score != b.score)
+            return a.score > b.score;
+        return foldedNames[a.id] < foldedNames[b.id];
+    };
+
+    int count = qMin(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), better);
+
+    for(int i = 0; i < count; i++)
+        result.append(names[matches[i].id]);
+
+    return result;
+}
+
+qint64 ClassIndex::memoryUsed() const{
+
+    qint64 bytes = names.size() * qint64(sizeof(bool) + sizeof(int));
+    for(int i = 0; i < names.size(); i++)
+        bytes += MemoryStats::stringBytes(names[i]) + MemoryStats::stringBytes(foldedNames[i]);
+
+    bytes += ids.size() * qint64(sizeof(QString) + sizeof(int) + 2 * sizeof(void*)); //hash nodes
+    for(QHash<quint64, QVector<int> >::const_iterator it = postings.constBegin(); it != postings.constEnd(); ++it)
+        bytes += sizeof(quint64) + sizeof(QVector<int>) + 2 * sizeof(void*) + it.value().capacity() * qint64(sizeof(int));
+    return bytes;
+}
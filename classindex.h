@@ -0,0 +1,116 @@
+#ifndef CLASSINDEX_H
+#define CLASSINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+/*!
+ * \brief The ClassIndex class keeps a search index over the class names so the class pane can be filtered while typing (prefix order plus a trigram index for substring and fuzzy matches)
+ */
+class ClassIndex
+{
+public:
+    /*!
+     * \brief ClassIndex constructor creates an empty index
+     */
+    ClassIndex();
+    /*!
+     * \brief insert method adds a class name to the index, names that are already indexed are ignored
+     * \param className is the class name
+     */
+    void insert(const QString &className);
+    /*!
+     * \brief remove method removes a class name from the index
+     * \param className is the class name
+     */
+    void remove(const QString &className);
+    /*!
+     * \brief clear method removes all the class names from the index
+     */
+    void clear();
+    /*!
+     * \brief size method gets the number of indexed class names
+     * \return returns the number of class names
+     */
+    int size() const;
+    /*!
+     * \brief search method finds the class names matching the query, ranked from best to worst (exact, prefix, path segment prefix, substring and then typo tolerant matches)
+     * \param query is the text typed in the search box
+     * \param limit is the maximum number of names returned
+     * \return returns the matching class names
+     */
+    QStringList search(const QString &query, int limit) const;
+    /*!
+     * \brief memoryUsed method estimates the memory taken by the index
+     * \return returns the number of bytes
+     */
+    qint64 memoryUsed() const;
+
+private:
+    /*!
+     * \brief The Match struct is a scored candidate used while ranking
+     */
+    struct Match
+    {
+        int id;
+        int score;
+    };
+    /*!
+     * \brief fold method normalises a name for matching (case insensitive)
+     */
+    static QString fold(const QString &name);
+    /*!
+     * \brief trigramKey method packs three characters into one hash key
+     */
+    static quint64 trigramKey(const QChar *c);
+    /*!
+     * \brief trigrams method gets the distinct trigram keys of a folded name
+     */
+    static QVector<quint64> trigrams(const QString &folded);
+    /*!
+     * \brief scoreName method scores how well a folded name matches the folded query without using the trigram index, returns 0 if it doesn't match
+     */
+    static int scoreName(const QString &folded, const QString &query);
+    /*!
+     * \brief lowerBound method finds the first position in sortedIds whose name is not less than the folded text
+     */
+    int lowerBound(const QString &folded) const;
+    /*!
+     * \brief compact method drops the removed names once they make up a large part of the index
+     */
+    void compact();
+
+private:
+    /*!
+     * \brief names stores the original class names, indexed by id
+     */
+    QVector<QString> names;
+    /*!
+     * \brief foldedNames stores the lower case class names, indexed by id
+     */
+    QVector<QString> foldedNames;
+    /*!
+     * \brief alive is false for ids whose class has been removed
+     */
+    QVector<bool> alive;
+    /*!
+     * \brief ids maps a class name to its id
+     */
+    QHash<QString, int> ids;
+    /*!
+     * \brief sortedIds stores the live ids ordered by folded name, used for prefix lookups
+     */
+    QVector<int> sortedIds;
+    /*!
+     * \brief postings maps each trigram to the ids of the names containing it (ids are in ascending order)
+     */
+    QHash<quint64, QVector<int> > postings;
+    /*!
+     * \brief removedCount is the number of dead ids still present in the posting lists
+     */
+    int removedCount;
+};
+
+#endif // CLASSINDEX_H
@@ -0,0 +1,29 @@
+#include "contenthasher.h"
+#include "trace.h"
+
+#include <QFile>
+#include <QCryptographicHash>
+
+#define HASH_BLOCK_SIZE (1 << 20)
+
+QByteArray ContentHasher::hashFile(const QString &path){
+
+    TRACE_SCOPE("hash content", "import");
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    QByteArray block(HASH_BLOCK_SIZE, Qt::Uninitialized);
+
+    qint64 read;
+    while((read = file.read(block.data(), block.size())) > 0){
+        hash.addData(block.constData(), int(read));
+    }
+
+    if(read < 0)
+        return QByteArray();
+
+    return hash.result();
+}
@@ -0,0 +1,21 @@
+#ifndef CONTENTHASHER_H
+#define CONTENTHASHER_H
+
+#include <QString>
+#include <QByteArray>
+
+/*!
+ * \brief The ContentHasher class computes the identity of an image from its bytes, so the same picture is recognised whatever its name or folder
+ */
+class ContentHasher
+{
+public:
+    /*!
+     * \brief hashFile method hashes a file by streaming it in fixed size blocks (safe to call from worker threads)
+     * \param path is the file path
+     * \return returns the hash or an empty array if the file can't be read
+     */
+    static QByteArray hashFile(const QString &path);
+};
+
+#endif // CONTENTHASHER_H
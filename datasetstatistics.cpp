@@ -0,0 +1,242 @@
+#include "datasetstatistics.h"
+#include "maskrasterizer.h"
+#include "projectdatabase.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+ImageStatistics ImageStatistics::measure(const QVector<AnnotationShape> &shapes){
+
+    ImageStatistics result;
+    for(const AnnotationShape &shape : shapes){
+        if(shape.confidence >= 0)
+            continue;
+
+        //a rectangle is measured before rotating, the other shapes by their bounding box
+        double width, height;
+        if(shape.type == SHAPE_RECT && shape.coordinates.size() >= 4){
+            width = qAbs(shape.coordinates[2]);
+            height = qAbs(shape.coordinates[3]);
+        }else{
+            QPolygonF outline = MaskRasterizer::outline(shape);
+            if(outline.isEmpty())
+                continue;
+            QRectF box = outline.boundingRect();
+            width = box.width();
+            height = box.height();
+        }
+        if(width <= 0 || height <= 0)
+            continue;
+
+        int size = qBound(0, int(std::floor(std::log2(std::sqrt(width * height)))), STATS_SIZE_BINS - 1);
+        int aspect = qBound(0, qRound(std::log2(width / height)) + STATS_ASPECT_BINS / 2, STATS_ASPECT_BINS - 1);
+        result.sizeBins.append(quint8(size));
+        result.aspectBins.append(quint8(aspect));
+
+        auto it = std::find_if(result.classes.begin(), result.classes.end(),
+                               [&](const QPair<QString, int> &c) { return c.first == shape.object; });
+        if(it == result.classes.end())
+            result.classes.append(qMakePair(shape.object, 1));
+        else
+            it->second++;
+    }
+    return result;
+}
+
+bool ImageStatistics::isEmpty() const{
+    return sizeBins.isEmpty();
+}
+
+bool ImageStatistics::operator==(const ImageStatistics &other) const{
+    return classes == other.classes && sizeBins == other.sizeBins && aspectBins == other.aspectBins;
+}
+
+DatasetStatistics::DatasetStatistics(QObject *parent)
+    : QObject(parent), annotated(0), sizes(STATS_SIZE_BINS, 0), aspects(STATS_ASPECT_BINS, 0), totalImages(0), totalShapes(0)
+{
+}
+
+void DatasetStatistics::apply(const ImageStatistics &statistics, int sign){
+
+    for(const QPair<QString, int> &c : statistics.classes){
+        qint64 &shapes = shapesPerClass[c.first];
+        int &withClass = imagesPerClass[c.first];
+        shapes += sign * c.second;
+        withClass += sign;
+        if(shapes <= 0){
+            shapesPerClass.remove(c.first);
+            imagesPerClass.remove(c.first);
+        }
+    }
+    for(quint8 bin : statistics.sizeBins)
+        sizes[bin] += sign;
+    for(quint8 bin : statistics.aspectBins)
+        aspects[bin] += sign;
+    totalShapes += sign * statistics.sizeBins.size();
+}
+
+void DatasetStatistics::setImageCount(int count){
+    if(count == totalImages)
+        return;
+    totalImages = count;
+    emit changed();
+}
+
+ImageStatistics DatasetStatistics::counted(const QString &imagePath) const{
+    QHash<QString, ImageStatistics>::const_iterator it = unsaved.constFind(imagePath);
+    return it != unsaved.constEnd() ? it.value() : images.value(imagePath);
+}
+
+bool DatasetStatistics::replace(const ImageStatistics &before, const ImageStatistics &after){
+    if(before == after)
+        return false; //e.g. saved as it was
+    apply(before, -1);
+    apply(after, 1);
+    annotated += int(!after.isEmpty()) - int(!before.isEmpty());
+    return true;
+}
+
+void DatasetStatistics::setImage(const QString &imagePath, const ImageStatistics &statistics){
+
+    ImageStatistics before = counted(imagePath);
+    if(statistics.isEmpty())
+        images.remove(imagePath);
+    else
+        images.insert(imagePath, statistics);
+    if(!unsaved.contains(imagePath) && replace(before, statistics))
+        emit changed();
+}
+
+void DatasetStatistics::setUnsaved(const QString &imagePath, const ImageStatistics &statistics){
+
+    ImageStatistics before = counted(imagePath);
+    bool known = unsaved.contains(imagePath);
+    unsaved.insert(imagePath, statistics);
+    if(replace(before, statistics) || !known)
+        emit changed();
+}
+
+void DatasetStatistics::discardUnsaved(const QString &imagePath){
+
+    QHash<QString, ImageStatistics>::iterator it = unsaved.find(imagePath);
+    if(it == unsaved.end())
+        return;
+    replace(it.value(), images.value(imagePath));
+    unsaved.erase(it);
+    emit changed();
+}
+
+void DatasetStatistics::seed(const QStringList &imagePaths, const QVector<ImageStatistics> &statistics){
+
+    TRACE_SCOPE("seed statistics", "statistics");
+    for(int i = 0; i < imagePaths.size(); i++){
+        if(images.contains(imagePaths[i]) || statistics[i].isEmpty())
+            continue;
+        images.insert(imagePaths[i], statistics[i]);
+        if(!unsaved.contains(imagePaths[i])) //the edits still count until they are saved or discarded
+            replace(ImageStatistics(), statistics[i]);
+    }
+    emit changed();
+}
+
+QVector<ImageStatistics> DatasetStatistics::scan(const QStringList &annotationFiles){
+
+    TRACE_SCOPE("scan statistics", "statistics");
+    QVector<ImageStatistics> result(annotationFiles.size());
+    ImageStatistics *out = result.data(); //each task writes its own entry, detached before the tasks start
+    TaskScheduler::instance()->parallelFor(annotationFiles.size(), [&](int i) {
+        QVector<AnnotationShape> shapes;
+        if(AnnotationFile::read(annotationFiles[i], &shapes))
+            out[i] = ImageStatistics::measure(shapes);
+    });
+    return result;
+}
+
+QVector<ImageStatistics> DatasetStatistics::scanProject(const QString &projectFile, QStringList *imagePaths){
+
+    TRACE_SCOPE("scan project statistics", "statistics");
+    QHash<QString, QByteArray> stored;
+    {
+        ProjectDatabase reader; //a connection is used by the thread that opened it
+        if(!reader.open(projectFile))
+            return QVector<ImageStatistics>();
+        stored = reader.annotationJson();
+    }
+
+    *imagePaths = stored.keys();
+    QVector<QByteArray> json;
+    json.reserve(stored.size());
+    for(const QString &path : *imagePaths)
+        json.append(stored.value(path));
+
+    QVector<ImageStatistics> result(json.size());
+    ImageStatistics *out = result.data();
+    TaskScheduler::instance()->parallelFor(json.size(), [&](int i) {
+        out[i] = ImageStatistics::measure(AnnotationFile::parse(json[i]));
+    });
+    return result;
+}
+
+int DatasetStatistics::imageCount() const{
+    return qMax(totalImages, annotated); //images annotated before they were counted
+}
+
+int DatasetStatistics::annotatedCount() const{
+    return annotated;
+}
+
+int DatasetStatistics::unsavedCount() const{
+    return unsaved.size();
+}
+
+qint64 DatasetStatistics::shapeCount() const{
+    return totalShapes;
+}
+
+QStringList DatasetStatistics::classes() const{
+    QStringList names = shapesPerClass.keys();
+    std::sort(names.begin(), names.end(), [&](const QString &l, const QString &r) {
+        qint64 a = shapesPerClass.value(l);
+        qint64 b = shapesPerClass.value(r);
+        return a != b ? a > b : l < r;
+    });
+    return names;
+}
+
+qint64 DatasetStatistics::shapesOf(const QString &className) const{
+    return shapesPerClass.value(className);
+}
+
+int DatasetStatistics::imagesOf(const QString &className) const{
+    return imagesPerClass.value(className);
+}
+
+QVector<qint64> DatasetStatistics::sizeHistogram() const{
+    return sizes;
+}
+
+QVector<qint64> DatasetStatistics::aspectHistogram() const{
+    return aspects;
+}
+
+QString DatasetStatistics::sizeBinName(int bin){
+    if(bin == STATS_SIZE_BINS - 1)
+        return QString(">= %1 px").arg(1 << bin);
+    if(bin == 0)
+        return "< 2 px";
+    return QString("%1-%2 px").arg(1 << bin).arg(1 << (bin + 1));
+}
+
+QString DatasetStatistics::aspectBinName(int bin){
+    int power = bin - STATS_ASPECT_BINS / 2;
+    QString name = power >= 0 ? QString("%1:1").arg(1 << power) : QString("1:%1").arg(1 << -power);
+    if(bin == 0)
+        return "<= " + name;
+    if(bin == STATS_ASPECT_BINS - 1)
+        return ">= " + name;
+    return name;
+}
@@ -0,0 +1,220 @@
+#ifndef DATASETSTATISTICS_H
+#define DATASETSTATISTICS_H
+
+#include "annotationfile.h"
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief STATS_SIZE_BINS is the number of box size bins, bin i holds the boxes whose side (square root of the area, in scene pixels) is from 2^i to 2^(i+1), the last one the larger boxes
+ */
+#define STATS_SIZE_BINS 11
+/*!
+ * \brief STATS_ASPECT_BINS is the number of aspect ratio bins, the width / height ratio rounded to a power of two from 1/16 to 16
+ */
+#define STATS_ASPECT_BINS 9
+
+/*!
+ * \brief The ImageStatistics struct is what the shapes of one image add to the dataset statistics
+ */
+struct ImageStatistics
+{
+    /*!
+     * \brief measure method gets the contribution of shapes, lines and pre-labels not accepted are left out
+     * \param shapes are the shapes of an image in scene coordinates
+     * \return returns the classes and the bins of the shapes
+     */
+    static ImageStatistics measure(const QVector<AnnotationShape> &shapes);
+    /*!
+     * \brief isEmpty method determines whether there is no shape
+     */
+    bool isEmpty() const;
+    /*!
+     * \brief operator== method determines whether two contributions are the same
+     */
+    bool operator==(const ImageStatistics &other) const;
+
+    /*!
+     * \brief classes are the classes of the image with their number of shapes
+     */
+    QVector<QPair<QString, int> > classes;
+    /*!
+     * \brief sizeBins is the size bin of each shape
+     */
+    QVector<quint8> sizeBins;
+    /*!
+     * \brief aspectBins is the aspect ratio bin of each shape
+     */
+    QVector<quint8> aspectBins;
+};
+
+/*!
+ * \brief The DatasetStatistics class keeps the counts used to balance the labelling effort: shapes and images per class, box size and aspect ratio histograms and the unannotated images
+ *
+ * The contribution of each image is kept, changing the shapes of an image takes its old contribution out of the totals and adds the
+ * new one, so the totals are never recomputed. They are seeded by a parallel scan of the annotation files, then follow the saves.
+ * The edits not saved yet are kept apart: while an image has some they count instead of its saved shapes, until they are saved or
+ * discarded. It is used on the gui thread only.
+ */
+class DatasetStatistics : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief DatasetStatistics constructor creates empty statistics
+     */
+    explicit DatasetStatistics(QObject *parent = nullptr);
+    /*!
+     * \brief setImageCount method sets the number of images of the dataset, annotated or not
+     * \param count is the number of images
+     */
+    void setImageCount(int count);
+    /*!
+     * \brief setImage method replaces the saved contribution of an image, as written to its annotation file or the project
+     * \param imagePath is the image path
+     * \param statistics is its new contribution
+     */
+    void setImage(const QString &imagePath, const ImageStatistics &statistics);
+    /*!
+     * \brief setUnsaved method sets the contribution of the edits of an image not saved yet, it counts instead of the saved one
+     * \param imagePath is the image path
+     * \param statistics is the contribution of the edited shapes
+     */
+    void setUnsaved(const QString &imagePath, const ImageStatistics &statistics);
+    /*!
+     * \brief discardUnsaved method drops the unsaved contribution of an image, once saved or when the edits are discarded, its saved one counts again
+     * \param imagePath is the image path
+     */
+    void discardUnsaved(const QString &imagePath);
+    /*!
+     * \brief seed method adds the saved contribution of images found by a scan, the images already known keep theirs (they were saved since the scan started)
+     * \param imagePaths are the images
+     * \param statistics are their contributions in the same order
+     */
+    void seed(const QStringList &imagePaths, const QVector<ImageStatistics> &statistics);
+    /*!
+     * \brief scan method reads annotation files and measures them, in parallel, it can run on any thread
+     * \param annotationFiles are the json files
+     * \return returns the contribution of each file, empty for a file that could not be read
+     */
+    static QVector<ImageStatistics> scan(const QStringList &annotationFiles);
+    /*!
+     * \brief scanProject method reads the shapes stored in a project with its own connection and measures them, in parallel, it can run on any thread
+     * \param projectFile is the project file
+     * \param imagePaths receives the annotated images
+     * \return returns the contribution of each image in the same order
+     */
+    static QVector<ImageStatistics> scanProject(const QString &projectFile, QStringList *imagePaths);
+    /*!
+     * \brief imageCount method gets the number of images of the dataset
+     */
+    int imageCount() const;
+    /*!
+     * \brief annotatedCount method gets the number of images with at least one shape
+     */
+    int annotatedCount() const;
+    /*!
+     * \brief unsavedCount method gets the number of images counted with edits not saved yet
+     */
+    int unsavedCount() const;
+    /*!
+     * \brief shapeCount method gets the number of shapes of the dataset
+     */
+    qint64 shapeCount() const;
+    /*!
+     * \brief classes method gets the classes with at least one shape, the most used first
+     */
+    QStringList classes() const;
+    /*!
+     * \brief shapesOf method gets the number of shapes of a class
+     */
+    qint64 shapesOf(const QString &className) const;
+    /*!
+     * \brief imagesOf method gets the number of images with a shape of a class
+     */
+    int imagesOf(const QString &className) const;
+    /*!
+     * \brief sizeHistogram method gets the number of shapes in each size bin
+     */
+    QVector<qint64> sizeHistogram() const;
+    /*!
+     * \brief aspectHistogram method gets the number of shapes in each aspect ratio bin
+     */
+    QVector<qint64> aspectHistogram() const;
+    /*!
+     * \brief sizeBinName method gets the label of a size bin, such as "32-64 px"
+     */
+    static QString sizeBinName(int bin);
+    /*!
+     * \brief aspectBinName method gets the label of an aspect ratio bin, such as "4:1"
+     */
+    static QString aspectBinName(int bin);
+
+signals:
+    /*!
+     * \brief changed signal is emitted after the totals changed
+     */
+    void changed();
+
+private:
+    /*!
+     * \brief apply method adds a contribution to the totals, or takes it out
+     * \param statistics is the contribution
+     * \param sign is 1 to add it, -1 to take it out
+     */
+    void apply(const ImageStatistics &statistics, int sign);
+    /*!
+     * \brief counted method gets the contribution of an image in the totals, its unsaved one if any
+     */
+    ImageStatistics counted(const QString &imagePath) const;
+    /*!
+     * \brief replace method replaces a contribution in the totals by another one
+     * \return returns true if the totals changed
+     */
+    bool replace(const ImageStatistics &before, const ImageStatistics &after);
+
+private:
+    /*!
+     * \brief images are the saved contributions of the images with shapes
+     */
+    QHash<QString, ImageStatistics> images;
+    /*!
+     * \brief unsaved are the contributions of the images with edits not saved yet, possibly without shapes
+     */
+    QHash<QString, ImageStatistics> unsaved;
+    /*!
+     * \brief annotated is the number of images counted with at least one shape
+     */
+    int annotated;
+    /*!
+     * \brief shapesPerClass is the number of shapes of each class
+     */
+    QHash<QString, qint64> shapesPerClass;
+    /*!
+     * \brief imagesPerClass is the number of images with a shape of each class
+     */
+    QHash<QString, int> imagesPerClass;
+    /*!
+     * \brief sizes is the size histogram
+     */
+    QVector<qint64> sizes;
+    /*!
+     * \brief aspects is the aspect ratio histogram
+     */
+    QVector<qint64> aspects;
+    /*!
+     * \brief totalImages is the number of images of the dataset
+     */
+    int totalImages;
+    /*!
+     * \brief totalShapes is the number of shapes of the dataset
+     */
+    qint64 totalShapes;
+};
+
+#endif // DATASETSTATISTICS_H
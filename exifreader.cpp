@@ -0,0 +1,222 @@
+#include "exifreader.h"
+#include "trace.h"
+
+#include <QFile>
+
+#define TAG_IMAGE_WIDTH         0x0100
+#define TAG_IMAGE_LENGTH        0x0101
+#define TAG_DATE_TIME           0x0132
+#define TAG_EXIF_IFD            0x8769
+#define TAG_DATE_TIME_ORIGINAL  0x9003
+#define TAG_PIXEL_X_DIMENSION   0xA002
+#define TAG_PIXEL_Y_DIMENSION   0xA003
+
+#define TIFF_SHORT  3
+#define TIFF_LONG   4
+
+ExifInfo::ExifInfo() : width(0), height(0)
+{
+}
+
+/*!
+ * \brief The TiffParser class reads values from a TIFF structure with bounds checks, in the byte order given by its header
+ */
+class TiffParser
+{
+public:
+    TiffParser(const uchar *theData, int theSize) : data(theData), size(theSize), littleEndian(true)
+    {
+    }
+
+    quint32 u16(qint64 offset) const{
+        if(offset < 0 || offset + 2 > size)
+            return 0;
+        const uchar *p = data + offset;
+        return littleEndian ? quint32(p[0] | (p[1] << 8)) : quint32((p[0] << 8) | p[1]);
+    }
+
+    quint32 u32(qint64 offset) const{
+        if(offset < 0 || offset + 4 > size)
+            return 0;
+        const uchar *p = data + offset;
+        if(littleEndian)
+            return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+        return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+    }
+
+    //SHORT or LONG value stored in the entry itself
+    quint32 number(qint64 entry) const{
+        return u16(entry + 2) == TIFF_SHORT ? u16(entry + 8) : u32(entry + 8);
+    }
+
+    //ASCII value, stored in the entry when it fits in four bytes
+    QByteArray text(qint64 entry) const{
+        quint32 count = u32(entry + 4);
+        qint64 offset = count <= 4 ? entry + 8 : qint64(u32(entry + 8));
+        if(count == 0 || offset < 0 || offset + count > quint32(size))
+            return QByteArray();
+        return QByteArray(reinterpret_cast<const char*>(data + offset), int(count));
+    }
+
+    const uchar *data;
+    int size;
+    bool littleEndian;
+};
+
+bool ExifReader::parseTiff(const uchar *data, int size, ExifInfo *info){
+
+    if(size < 8)
+        return false;
+
+    TiffParser tiff(data, size);
+    if(data[0] == 'I' && data[1] == 'I')
+        tiff.littleEndian = true;
+    else if(data[0] == 'M' && data[1] == 'M')
+        tiff.littleEndian = false;
+    else
+        return false;
+
+    if(tiff.u16(2) != 42)
+        return false;
+
+    QByteArray original, modified;
+    quint32 width = 0, height = 0, pixelX = 0, pixelY = 0;
+
+    //IFD0 first, then the Exif IFD it points to
+    qint64 ifd = tiff.u32(4);
+    qint64 exifIfd = 0;
+    for(int level = 0; level < 2 && ifd > 0; level++){
+        int count = int(tiff.u16(ifd));
+        for(int i = 0; i < count; i++){
+            qint64 entry = ifd + 2 + 12 * i;
+            if(entry + 12 > size)
+                break;
+
+            switch(tiff.u16(entry))
+            {
+            case TAG_IMAGE_WIDTH:           width = tiff.number(entry); break;
+            case TAG_IMAGE_LENGTH:          height = tiff.number(entry); break;
+            case TAG_DATE_TIME:             modified = tiff.text(entry); break;
+            case TAG_EXIF_IFD:              exifIfd = tiff.u32(entry + 8); break;
+            case TAG_DATE_TIME_ORIGINAL:    original = tiff.text(entry); break;
+            case TAG_PIXEL_X_DIMENSION:     pixelX = tiff.number(entry); break;
+            case TAG_PIXEL_Y_DIMENSION:     pixelY = tiff.number(entry); break;
+            default: break;
+            }
+        }
+        ifd = exifIfd != ifd ? exifIfd : 0; //guard against an IFD pointing to itself
+    }
+
+    QDateTime captured = parseDateTime(original);
+    if(!captured.isValid())
+        captured = parseDateTime(modified);
+    if(captured.isValid())
+        info->captured = captured;
+
+    if(pixelX > 0 && pixelY > 0){
+        info->width = int(pixelX);
+        info->height = int(pixelY);
+    }else if(width > 0 && height > 0){
+        info->width = int(width);
+        info->height = int(height);
+    }
+    return true;
+}
+
+QDateTime ExifReader::parseDateTime(const QByteArray &text){
+
+    if(text.size() < 19)
+        return QDateTime();
+
+    //"yyyy:MM:dd hh:mm:ss", unknown parts are written as spaces or zeros
+    QDateTime dateTime = QDateTime::fromString(QString::fromLatin1(text.left(19)), "yyyy:MM:dd hh:mm:ss");
+    return dateTime.isValid() ? dateTime : QDateTime();
+}
+
+/*!
+ * \brief readJpeg walks the JPEG segment headers up to the image data, reading only the Exif segment and the frame header
+ */
+static bool readJpeg(QFile &file, ExifInfo *info){
+
+    bool gotExif = false;
+    bool gotFrame = false;
+
+    while(!(gotExif && gotFrame)){
+        uchar marker[4];
+        if(file.read(reinterpret_cast<char*>(marker), 2) != 2 || marker[0] != 0xFF)
+            break;
+        while(marker[1] == 0xFF){ //fill bytes
+            if(!file.getChar(reinterpret_cast<char*>(&marker[1])))
+                return true;
+        }
+
+        uchar type = marker[1];
+        if(type == 0xD9 || type == 0xDA) //end of image or start of the compressed data
+            break;
+        if(type == 0x01 || (type >= 0xD0 && type <= 0xD7)) //markers without a length
+            continue;
+
+        if(file.read(reinterpret_cast<char*>(marker + 2), 2) != 2)
+            break;
+        int length = (marker[2] << 8) | marker[3];
+        if(length < 2)
+            break;
+        qint64 next = file.pos() + length - 2;
+
+        if(type == 0xE1 && !gotExif && length > 8){
+            QByteArray payload = file.read(length - 2);
+            if(payload.startsWith(QByteArray("Exif\0\0", 6))){
+                ExifInfo exif;
+                if(ExifReader::parseTiff(reinterpret_cast<const uchar*>(payload.constData()) + 6, payload.size() - 6, &exif)){
+                    info->captured = exif.captured;
+                    if(!gotFrame){
+                        info->width = exif.width;
+                        info->height = exif.height;
+                    }
+                    gotExif = true;
+                }
+            }
+        }else if(((type >= 0xC0 && type <= 0xC3) || (type >= 0xC5 && type <= 0xC7) || (type >= 0xC9 && type <= 0xCB) || (type >= 0xCD && type <= 0xCF)) && length >= 7){
+            uchar frame[5]; //precision, height, width
+            if(file.read(reinterpret_cast<char*>(frame), 5) != 5)
+                break;
+            info->height = (frame[1] << 8) | frame[2];
+            info->width = (frame[3] << 8) | frame[4];
+            gotFrame = true;
+        }
+
+        if(!file.seek(next))
+            break;
+    }
+    return true;
+}
+
+bool ExifReader::read(const QString &path, ExifInfo *info){
+
+    TRACE_SCOPE("read exif", "import");
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray head = file.peek(24);
+    const uchar *h = reinterpret_cast<const uchar*>(head.constData());
+
+    if(head.size() >= 2 && h[0] == 0xFF && h[1] == 0xD8){
+        file.seek(2);
+        return readJpeg(file, info);
+    }
+
+    if(head.size() >= 24 && head.startsWith("\x89PNG\r\n\x1a\n") && head.mid(12, 4) == "IHDR"){
+        info->width = int((h[16] << 24) | (h[17] << 16) | (h[18] << 8) | h[19]);
+        info->height = int((h[20] << 24) | (h[21] << 16) | (h[22] << 8) | h[23]);
+        return true;
+    }
+
+    if(head.startsWith(QByteArray("II*\0", 4)) || head.startsWith(QByteArray("MM\0*", 4))){
+        QByteArray tiff = file.read(256 * 1024); //the IFDs of camera TIFFs are near the start
+        return parseTiff(reinterpret_cast<const uchar*>(tiff.constData()), tiff.size(), info);
+    }
+
+    return false;
+}
@@ -0,0 +1,59 @@
+#ifndef EXIFREADER_H
+#define EXIFREADER_H
+
+#include <QString>
+#include <QDateTime>
+
+/*!
+ * \brief The ExifInfo struct holds the metadata read from an image header
+ */
+struct ExifInfo
+{
+    /*!
+     * \brief ExifInfo constructor initialises an empty result
+     */
+    ExifInfo();
+    /*!
+     * \brief captured is the capture time (EXIF DateTimeOriginal, or DateTime when there is no original time), invalid when not found
+     */
+    QDateTime captured;
+    /*!
+     * \brief width is the image width in pixels, 0 when not found
+     */
+    int width;
+    /*!
+     * \brief height is the image height in pixels, 0 when not found
+     */
+    int height;
+};
+
+/*!
+ * \brief The ExifReader class reads the capture time and dimensions of JPEG, TIFF and PNG files from their header bytes only, the pixels are never decoded
+ */
+class ExifReader
+{
+public:
+    /*!
+     * \brief read method reads the metadata of an image file (safe to call from worker threads)
+     * \param path is the image path
+     * \param info receives the metadata found
+     * \return returns true if the file was recognised
+     */
+    static bool read(const QString &path, ExifInfo *info);
+    /*!
+     * \brief parseTiff method reads the capture time and dimensions from a TIFF structure (a TIFF file or the payload of a JPEG Exif segment)
+     * \param data points to the TIFF header
+     * \param size is the number of bytes available
+     * \param info receives the metadata found
+     * \return returns true if the TIFF header is valid
+     */
+    static bool parseTiff(const uchar *data, int size, ExifInfo *info);
+    /*!
+     * \brief parseDateTime method converts an EXIF date ("yyyy:MM:dd hh:mm:ss") to a date time
+     * \param text is the date text
+     * \return returns the date time, invalid if the text is not a date
+     */
+    static QDateTime parseDateTime(const QByteArray &text);
+};
+
+#endif // EXIFREADER_H
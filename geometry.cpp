@@ -0,0 +1,320 @@
+#include "geometry.h"
+
+#include <QTransform>
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+//GEOMETRY_NO_SIMD builds the scalar code on any processor, the tests are run with both
+#if !defined(GEOMETRY_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define GEOMETRY_USE_SSE2
+#endif
+
+static_assert(std::is_same<qreal, double>::value && sizeof(QPointF) == 2 * sizeof(double),
+              "the polygons are read as packed doubles");
+
+const double *Geometry::packed(const QPolygonF &polygon){
+    return reinterpret_cast<const double*>(polygon.constData());
+}
+
+double Geometry::signedArea(const double *xy, int count){
+
+    if(count < 3)
+        return 0;
+
+    //sum of x[i] * y[i + 1] - y[i] * x[i + 1], the last point pairs with the first one
+    double sum = 0;
+    int i = 0;
+#ifdef GEOMETRY_USE_SSE2
+    __m128d products = _mm_setzero_pd();
+    for(; i + 1 < count; i++){
+        __m128d point = _mm_loadu_pd(xy + 2 * i);
+        __m128d next = _mm_loadu_pd(xy + 2 * i + 2);
+        products = _mm_add_pd(products, _mm_mul_pd(point, _mm_shuffle_pd(next, next, 1))); //x * next y, y * next x
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, products);
+    sum = lanes[0] - lanes[1];
+#endif
+    for(; i + 1 < count; i++)
+        sum += xy[2 * i] * xy[2 * i + 3] - xy[2 * i + 1] * xy[2 * i + 2];
+    sum += xy[2 * (count - 1)] * xy[1] - xy[2 * (count - 1) + 1] * xy[0];
+    return sum / 2;
+}
+
+double Geometry::area(const QPolygonF &polygon){
+    return std::fabs(signedArea(packed(polygon), polygon.size()));
+}
+
+bool Geometry::isConvex(const double *xy, int count){
+
+    //The cross products AB x BC of every three adjacent points must not have both signs, and the edges must turn around once:
+    //a star turns the same way at every point but twice around, the x direction of its edges then changes sign more than twice.
+    bool negative = false;
+    bool positive = false;
+    int flips = 0;
+    double previousDx = 0;
+    for(int i = 0; i < count; i++){ //the direction of the last edge, the first one is compared with it
+        int next = i + 1 < count ? i + 1 : 0;
+        if(xy[2 * next] != xy[2 * i])
+            previousDx = xy[2 * next] - xy[2 * i];
+    }
+    for(int a = 0; a < count; a++){
+        int b = a + 1 < count ? a + 1 : 0;
+        int c = b + 1 < count ? b + 1 : 0;
+        double dx = xy[2 * b] - xy[2 * a];
+        double cross = dx * (xy[2 * c + 1] - xy[2 * b + 1])
+                     - (xy[2 * b + 1] - xy[2 * a + 1]) * (xy[2 * c] - xy[2 * b]);
+        negative |= cross < 0;
+        positive |= cross > 0;
+        if(dx != 0){
+            flips += (dx > 0) != (previousDx > 0);
+            previousDx = dx;
+        }
+    }
+    return !(negative && positive) && flips <= 2;
+}
+
+bool Geometry::isConvex(const QPolygonF &polygon){
+    return isConvex(packed(polygon), polygon.size());
+}
+
+bool Geometry::contains(const double *xy, int count, const QPointF &point){
+
+    double px = point.x();
+    double py = point.y();
+    bool inside = false;
+    for(int i = 0, j = count - 1; i < count; j = i++){
+        double xi = xy[2 * i], yi = xy[2 * i + 1];
+        double xj = xy[2 * j], yj = xy[2 * j + 1];
+        if((yi > py) != (yj > py) && px < (xj - xi) * (py - yi) / (yj - yi) + xi)
+            inside = !inside;
+    }
+    return inside;
+}
+
+bool Geometry::contains(const QPolygonF &polygon, const QPointF &point){
+    return contains(packed(polygon), polygon.size(), point);
+}
+
+QVector<bool> Geometry::containsPoints(const QPolygonF &polygon, const QVector<QPointF> &points){
+
+    QVector<bool> inside(points.size(), false);
+    QRectF bounds = boundingRect(packed(polygon), polygon.size());
+    for(int i = 0; i < points.size(); i++){
+        const QPointF &p = points[i];
+        if(p.x() >= bounds.left() && p.x() <= bounds.right() && p.y() >= bounds.top() && p.y() <= bounds.bottom())
+            inside[i] = contains(polygon, p);
+    }
+    return inside;
+}
+
+QRectF Geometry::boundingRect(const double *xy, int count){
+
+    if(count <= 0)
+        return QRectF();
+
+    double minimum[2] = { xy[0], xy[1] };
+    double maximum[2] = { xy[0], xy[1] };
+    int i = 1;
+#ifdef GEOMETRY_USE_SSE2
+    __m128d low = _mm_loadu_pd(xy);
+    __m128d high = low;
+    for(; i < count; i++){
+        __m128d point = _mm_loadu_pd(xy + 2 * i);
+        low = _mm_min_pd(low, point);
+        high = _mm_max_pd(high, point);
+    }
+    _mm_storeu_pd(minimum, low);
+    _mm_storeu_pd(maximum, high);
+#endif
+    for(; i < count; i++){
+        for(int k = 0; k < 2; k++){
+            minimum[k] = qMin(minimum[k], xy[2 * i + k]);
+            maximum[k] = qMax(maximum[k], xy[2 * i + k]);
+        }
+    }
+    return QRectF(QPointF(minimum[0], minimum[1]), QPointF(maximum[0], maximum[1]));
+}
+
+QVector<QRectF> Geometry::boundingRects(const QVector<QPolygonF> &polygons){
+
+    QVector<QRectF> rects;
+    rects.reserve(polygons.size());
+    for(const QPolygonF &polygon : polygons)
+        rects.append(boundingRect(packed(polygon), polygon.size()));
+    return rects;
+}
+
+int Geometry::nearestPoint(const double *xy, int count, const QPointF &point, double *distanceSquared){
+
+    int nearest = -1;
+    double best = std::numeric_limits<double>::max();
+    int i = 0;
+#ifdef GEOMETRY_USE_SSE2
+    //two points per step: the squared x and y differences are regrouped so one add gives both distances
+    __m128d target = _mm_set_pd(point.y(), point.x());
+    double distances[2];
+    for(; i + 2 <= count; i += 2){
+        __m128d first = _mm_sub_pd(_mm_loadu_pd(xy + 2 * i), target);
+        __m128d second = _mm_sub_pd(_mm_loadu_pd(xy + 2 * i + 2), target);
+        first = _mm_mul_pd(first, first);
+        second = _mm_mul_pd(second, second);
+        _mm_storeu_pd(distances, _mm_add_pd(_mm_unpacklo_pd(first, second), _mm_unpackhi_pd(first, second)));
+        if(distances[0] < best){
+            best = distances[0];
+            nearest = i;
+        }
+        if(distances[1] < best){
+            best = distances[1];
+            nearest = i + 1;
+        }
+    }
+#endif
+    for(; i < count; i++){
+        double dx = xy[2 * i] - point.x();
+        double dy = xy[2 * i + 1] - point.y();
+        double d = dx * dx + dy * dy;
+        if(d < best){
+            best = d;
+            nearest = i;
+        }
+    }
+    if(distanceSquared)
+        *distanceSquared = best;
+    return nearest;
+}
+
+int Geometry::nearestPoint(const QPolygonF &polygon, const QPointF &point, double *distanceSquared){
+    return nearestPoint(packed(polygon), polygon.size(), point, distanceSquared);
+}
+
+QPolygonF Geometry::rotatedRect(const QRectF &rect, double rotation){
+
+    QPolygonF corners;
+    corners << rect.topLeft() << rect.topRight() << rect.bottomRight() << rect.bottomLeft();
+    if(rotation == 0)
+        return corners;
+
+    QTransform t;
+    t.translate(rect.center().x(), rect.center().y());
+    t.rotate(rotation);
+    t.translate(-rect.center().x(), -rect.center().y());
+    return t.map(corners);
+}
+
+QPolygonF Geometry::oriented(const QPolygonF &polygon){
+
+    if(signedArea(packed(polygon), polygon.size()) >= 0)
+        return polygon;
+    QPolygonF reversed;
+    reversed.reserve(polygon.size());
+    for(int i = polygon.size() - 1; i >= 0; i--)
+        reversed.append(polygon[i]);
+    return reversed;
+}
+
+QPolygonF Geometry::clipConvex(const QPolygonF &subject, const QPolygonF &clip){
+
+    QPolygonF output = subject;
+    QPolygonF input;
+    for(int e = 0; e < clip.size() && !output.isEmpty(); e++){
+        QPointF c1 = clip[e];
+        QPointF c2 = clip[(e + 1) % clip.size()];
+        double ex = c2.x() - c1.x();
+        double ey = c2.y() - c1.y();
+        auto side = [&](const QPointF &p) { return ex * (p.y() - c1.y()) - ey * (p.x() - c1.x()); }; //>= 0 inside
+
+        input.swap(output);
+        output.clear();
+        QPointF previous = input.last();
+        double previousSide = side(previous);
+        for(const QPointF &current : input){
+            double currentSide = side(current);
+            if((currentSide >= 0) != (previousSide >= 0)){
+                double t = previousSide / (previousSide - currentSide);
+                output.append(previous + (current - previous) * t);
+            }
+            if(currentSide >= 0)
+                output.append(current);
+            previous = current;
+            previousSide = currentSide;
+        }
+    }
+    return output;
+}
+
+double Geometry::convexIntersectionArea(const QPolygonF &a, const QPolygonF &b){
+    return area(clipConvex(a, b));
+}
+
+double Geometry::intersectionArea(const QPolygonF &a, const QPolygonF &b){
+
+    if(a.size() < 3 || b.size() < 3)
+        return 0;
+    QRectF boundsA = boundingRect(packed(a), a.size());
+    QRectF boundsB = boundingRect(packed(b), b.size());
+    if(boundsA.right() <= boundsB.left() || boundsB.right() <= boundsA.left()
+            || boundsA.bottom() <= boundsB.top() || boundsB.bottom() <= boundsA.top())
+        return 0;
+
+    if(isConvex(a) && isConvex(b))
+        return convexIntersectionArea(oriented(a), oriented(b));
+
+    //The triangles (origin, p[i], p[i + 1]) add up to the polygon with their signs, so do the products of the triangle pairs
+    QPointF origin = a[0];
+    auto fan = [&](const QPolygonF &polygon, QVector<QPolygonF> *triangles, QVector<double> *signs, QVector<QRectF> *bounds) {
+        for(int i = 0; i < polygon.size(); i++){
+            QPolygonF triangle;
+            triangle << origin << polygon[i] << polygon[(i + 1) % polygon.size()];
+            double s = signedArea(packed(triangle), 3);
+            if(std::fabs(s) < GEOMETRY_EPSILON)
+                continue;
+            triangles->append(oriented(triangle));
+            signs->append(s > 0 ? 1 : -1);
+            bounds->append(boundingRect(packed(triangle), 3));
+        }
+    };
+    QVector<QPolygonF> trianglesA, trianglesB;
+    QVector<double> signsA, signsB;
+    QVector<QRectF> rectsA, rectsB;
+    fan(a, &trianglesA, &signsA, &rectsA);
+    fan(b, &trianglesB, &signsB, &rectsB);
+
+    double sum = 0;
+    for(int i = 0; i < trianglesA.size(); i++){
+        for(int j = 0; j < trianglesB.size(); j++){
+            const QRectF &ra = rectsA[i];
+            const QRectF &rb = rectsB[j];
+            if(ra.right() <= rb.left() || rb.right() <= ra.left() || ra.bottom() <= rb.top() || rb.bottom() <= ra.top())
+                continue;
+            sum += signsA[i] * signsB[j] * convexIntersectionArea(trianglesA[i], trianglesB[j]);
+        }
+    }
+
+    //the fans of opposite orientations give a negative sum
+    double orientation = (signedArea(packed(a), a.size()) >= 0) == (signedArea(packed(b), b.size()) >= 0) ? 1 : -1;
+    return qMax(0.0, sum * orientation);
+}
+
+double Geometry::iou(const QPolygonF &a, const QPolygonF &b){
+
+    double intersection = intersectionArea(a, b);
+    double united = area(a) + area(b) - intersection;
+    return united > GEOMETRY_EPSILON ? intersection / united : 0;
+}
+
+double Geometry::iou(const QRectF &a, double rotationA, const QRectF &b, double rotationB){
+
+    if(rotationA == 0 && rotationB == 0){
+        QRectF na = a.normalized();
+        QRectF nb = b.normalized();
+        QRectF common = na.intersected(nb);
+        double intersection = common.width() * common.height();
+        double united = na.width() * na.height() + nb.width() * nb.height() - intersection;
+        return united > GEOMETRY_EPSILON ? intersection / united : 0;
+    }
+    return iou(rotatedRect(a, rotationA), rotatedRect(b, rotationB));
+}
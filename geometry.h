@@ -0,0 +1,161 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+
+/*!
+ * \brief GEOMETRY_EPSILON is the area below which a polygon or an intersection is considered empty, in square pixels
+ */
+#define GEOMETRY_EPSILON 1e-9
+
+/*!
+ * \brief The Geometry class holds the shape computations shared by the editing, validation, statistics and comparison tools
+ *
+ * The routines work on packed coordinate arrays (x0, y0, x1, y1, ...), the layout of both QPolygonF and the coordinates of an
+ * AnnotationShape, so a polygon is never copied to be measured. The loops over the points handle a point (two doubles) per SSE2
+ * register, with scalar code on other processors. The polygons are closed, the first point is not repeated at the end.
+ */
+class Geometry
+{
+public:
+    /*!
+     * \brief signedArea method gets the area of a polygon with the shoelace formula
+     * \param xy are the packed coordinates
+     * \param count is the number of points
+     * \return returns the area, positive when the points turn counterclockwise in y-up coordinates (clockwise on the screen)
+     */
+    static double signedArea(const double *xy, int count);
+    /*!
+     * \brief area method gets the area of a polygon
+     * \param polygon is the polygon
+     * \return returns the area in square pixels, whatever the orientation
+     */
+    static double area(const QPolygonF &polygon);
+    /*!
+     * \brief isConvex method determines whether a polygon is convex, collinear and repeated points are allowed
+     * \param xy are the packed coordinates
+     * \param count is the number of points
+     * \return returns true if every turn has the same direction and the edges turn around once, a self-intersecting star is not convex
+     */
+    static bool isConvex(const double *xy, int count);
+    /*!
+     * \brief isConvex method determines whether a polygon is convex
+     * \param polygon is the polygon
+     * \return returns true if every turn has the same direction and the edges turn around once
+     */
+    static bool isConvex(const QPolygonF &polygon);
+    /*!
+     * \brief contains method determines whether a point is inside a polygon (even-odd rule)
+     *
+     * A point on an edge or a vertex is inside only on the left and top sides (a unit square holds [0, 1) x [0, 1)), so a point on
+     * the edge shared by two polygons is in exactly one of them.
+     * \param xy are the packed coordinates
+     * \param count is the number of points
+     * \param point is the point
+     * \return returns true if the point is inside
+     */
+    static bool contains(const double *xy, int count, const QPointF &point);
+    /*!
+     * \brief contains method determines whether a point is inside a polygon (even-odd rule)
+     * \param polygon is the polygon
+     * \param point is the point
+     * \return returns true if the point is inside
+     */
+    static bool contains(const QPolygonF &polygon, const QPointF &point);
+    /*!
+     * \brief containsPoints method tests many points against one polygon, the bounding box rejects most of the points far from it
+     * \param polygon is the polygon
+     * \param points are the points
+     * \return returns a flag per point, true if it is inside
+     */
+    static QVector<bool> containsPoints(const QPolygonF &polygon, const QVector<QPointF> &points);
+    /*!
+     * \brief boundingRect method gets the smallest axis-aligned rectangle holding the points
+     * \param xy are the packed coordinates
+     * \param count is the number of points
+     * \return returns the rectangle, null when there is no point
+     */
+    static QRectF boundingRect(const double *xy, int count);
+    /*!
+     * \brief boundingRects method gets the bounding rectangles of many polygons
+     * \param polygons are the polygons
+     * \return returns a rectangle per polygon
+     */
+    static QVector<QRectF> boundingRects(const QVector<QPolygonF> &polygons);
+    /*!
+     * \brief nearestPoint method finds the point of a list closest to another one
+     * \param xy are the packed coordinates
+     * \param count is the number of points
+     * \param point is the point
+     * \param distanceSquared receives the squared distance to the nearest point, may be null
+     * \return returns the index of the nearest point, -1 when there is no point
+     */
+    static int nearestPoint(const double *xy, int count, const QPointF &point, double *distanceSquared = nullptr);
+    /*!
+     * \brief nearestPoint method finds the vertex of a polygon closest to a point
+     * \param polygon is the polygon
+     * \param point is the point
+     * \param distanceSquared receives the squared distance to the nearest vertex, may be null
+     * \return returns the index of the nearest vertex, -1 for an empty polygon
+     */
+    static int nearestPoint(const QPolygonF &polygon, const QPointF &point, double *distanceSquared = nullptr);
+    /*!
+     * \brief rotatedRect method gets the corners of a rectangle turned around its center, as the scene rotates the rectangle items
+     * \param rect is the rectangle before rotating
+     * \param rotation is the rotation in degrees, clockwise on the screen
+     * \return returns the four corners from the top left one
+     */
+    static QPolygonF rotatedRect(const QRectF &rect, double rotation);
+    /*!
+     * \brief intersectionArea method gets the area common to two polygons, which may be concave
+     *
+     * Convex polygons are clipped against each other. Otherwise each polygon is split into the signed triangles fanning from a
+     * common point, the intersection is the signed sum of the intersections of the triangle pairs (exact for simple polygons, a
+     * self-intersecting polygon counts each region as many times as it winds around it, as area() does).
+     * \param a is the first polygon
+     * \param b is the second polygon
+     * \return returns the area in square pixels
+     */
+    static double intersectionArea(const QPolygonF &a, const QPolygonF &b);
+    /*!
+     * \brief iou method gets the intersection over union of two polygons
+     * \param a is the first polygon
+     * \param b is the second polygon
+     * \return returns a value from 0 (disjoint) to 1 (the same)
+     */
+    static double iou(const QPolygonF &a, const QPolygonF &b);
+    /*!
+     * \brief iou method gets the intersection over union of two rectangles turned around their centers
+     * \param a is the first rectangle before rotating
+     * \param rotationA is the rotation of the first rectangle in degrees
+     * \param b is the second rectangle before rotating
+     * \param rotationB is the rotation of the second rectangle in degrees
+     * \return returns a value from 0 (disjoint) to 1 (the same)
+     */
+    static double iou(const QRectF &a, double rotationA, const QRectF &b, double rotationB);
+
+private:
+    /*!
+     * \brief packed method gets the coordinates of a polygon, QPointF holds two qreal next to each other
+     */
+    static const double *packed(const QPolygonF &polygon);
+    /*!
+     * \brief clipConvex method clips a polygon by a convex one (Sutherland-Hodgman)
+     * \param subject is the polygon clipped
+     * \param clip is the convex polygon, counterclockwise in y-up coordinates (positive signed area)
+     * \return returns the part of subject inside clip
+     */
+    static QPolygonF clipConvex(const QPolygonF &subject, const QPolygonF &clip);
+    /*!
+     * \brief convexIntersectionArea method gets the area common to two convex polygons
+     */
+    static double convexIntersectionArea(const QPolygonF &a, const QPolygonF &b);
+    /*!
+     * \brief oriented method gets a polygon with a positive signed area, reversed if needed
+     */
+    static QPolygonF oriented(const QPolygonF &polygon);
+};
+
+#endif // GEOMETRY_H
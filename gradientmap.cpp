@@ -0,0 +1,140 @@
+#include "gradientmap.h"
+#include "trace.h"
+
+#include <QtMath>
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GRADIENT_USE_SSE2
+#endif
+
+GradientMap::GradientMap() : width(0), height(0)
+{
+}
+
+bool GradientMap::isNull() const{
+    return data.isEmpty();
+}
+
+QSize GradientMap::size() const{
+    return QSize(width, height);
+}
+
+int GradientMap::magnitude(int x, int y) const{
+    if(x < 0 || y < 0 || x >= width || y >= height)
+        return 0;
+    return data[y * width + x];
+}
+
+qint64 GradientMap::memoryUsed() const{
+    return sizeof(GradientMap) + data.capacity();
+}
+
+void GradientMap::sobelRow(const quint8 *above, const quint8 *row, const quint8 *below, int width, quint8 *out){
+
+    int x = 1;
+
+#ifdef GRADIENT_USE_SSE2
+    //Eight pixels at a time in 16 bit lanes, |gx| + |gy| is at most 2040 and is divided by 8
+    const __m128i zero = _mm_setzero_si128();
+    auto load = [&](const quint8 *p) {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero);
+    };
+    auto absolute = [&](__m128i v) {
+        return _mm_max_epi16(v, _mm_sub_epi16(zero, v));
+    };
+
+    for(; x + 8 < width; x += 8){
+        __m128i aL = load(above + x - 1), aC = load(above + x), aR = load(above + x + 1);
+        __m128i rL = load(row + x - 1), rR = load(row + x + 1);
+        __m128i bL = load(below + x - 1), bC = load(below + x), bR = load(below + x + 1);
+
+        __m128i gx = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(aR, bR), _mm_slli_epi16(rR, 1)),
+                                   _mm_add_epi16(_mm_add_epi16(aL, bL), _mm_slli_epi16(rL, 1)));
+        __m128i gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(bL, bR), _mm_slli_epi16(bC, 1)),
+                                   _mm_add_epi16(_mm_add_epi16(aL, aR), _mm_slli_epi16(aC, 1)));
+        __m128i sum = _mm_srli_epi16(_mm_add_epi16(absolute(gx), absolute(gy)), 3);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(sum, zero));
+    }
+#endif
+
+    for(; x < width - 1; x++){
+        int gx = (above[x + 1] + 2 * row[x + 1] + below[x + 1]) - (above[x - 1] + 2 * row[x - 1] + below[x - 1]);
+        int gy = (below[x - 1] + 2 * below[x] + below[x + 1]) - (above[x - 1] + 2 * above[x] + above[x + 1]);
+        out[x] = quint8(qMin(255, (qAbs(gx) + qAbs(gy)) >> 3));
+    }
+}
+
+GradientMap GradientMap::compute(const QImage &image){
+
+    GradientMap map;
+    if(image.isNull())
+        return map;
+
+    TRACE_SCOPE("gradient map", "image");
+    QImage pixels = image.convertToFormat(QImage::Format_RGB32);
+    int w = pixels.width();
+    int h = pixels.height();
+
+    //luma, the same weights as qGray
+    QVector<quint8> gray(w * h);
+    for(int y = 0; y < h; y++){
+        const QRgb *in = reinterpret_cast<const QRgb*>(pixels.constScanLine(y));
+        quint8 *out = gray.data() + y * w;
+        for(int x = 0; x < w; x++)
+            out[x] = quint8((qRed(in[x]) * 11 + qGreen(in[x]) * 16 + qBlue(in[x]) * 5) / 32);
+    }
+
+    map.width = w;
+    map.height = h;
+    map.data.resize(w * h);
+    std::memset(map.data.data(), 0, map.data.size()); //the border pixels have no gradient
+
+    for(int y = 1; y < h - 1; y++){
+        const quint8 *row = gray.constData() + y * w;
+        sobelRow(row - w, row, row + w, w, map.data.data() + y * w);
+    }
+    return map;
+}
+
+QPointF GradientMap::snap(const QPointF &point, int radius, int minStrength) const{
+
+    if(isNull())
+        return point;
+
+    int cx = qFloor(point.x());
+    int cy = qFloor(point.y());
+    int best = minStrength - 1;
+    int bestDistance = 0;
+    int bestX = -1;
+    int bestY = -1;
+
+    //Only the window around the point is read, (2 * radius + 1)^2 bytes per mouse event
+    int top = qMax(0, cy - radius);
+    int bottom = qMin(height - 1, cy + radius);
+    int left = qMax(0, cx - radius);
+    int right = qMin(width - 1, cx + radius);
+    for(int y = top; y <= bottom; y++){
+        const quint8 *row = data.constData() + y * width;
+        int dy = y - cy;
+        for(int x = left; x <= right; x++){
+            int dx = x - cx;
+            int distance = dx * dx + dy * dy;
+            if(distance > radius * radius)
+                continue;
+            int m = row[x];
+            if(m > best || (m == best && bestX >= 0 && distance < bestDistance)){
+                best = m;
+                bestDistance = distance;
+                bestX = x;
+                bestY = y;
+            }
+        }
+    }
+
+    if(bestX < 0)
+        return point;
+    return QPointF(bestX + 0.5, bestY + 0.5);
+}
@@ -0,0 +1,88 @@
+#ifndef GRADIENTMAP_H
+#define GRADIENTMAP_H
+
+#include <QImage>
+#include <QPointF>
+#include <QVector>
+
+/*!
+ * \brief SNAP_RADIUS is the distance in pixels searched around the mouse for an edge to snap to
+ */
+#define SNAP_RADIUS 8
+/*!
+ * \brief SNAP_MIN_STRENGTH is the weakest gradient magnitude (0 to 255) treated as an edge, the mouse position is kept when nothing stronger is near
+ */
+#define SNAP_MIN_STRENGTH 24
+
+/*!
+ * \brief The GradientMap class stores the Sobel gradient magnitude of an image, used to snap polygon vertices to the object edges
+ *
+ * The map is computed once per decoded image on a worker thread and cached with it. Copies share the data, so a map can be
+ * handed from the worker to the gui thread without copying.
+ */
+class GradientMap
+{
+public:
+    /*!
+     * \brief GradientMap constructor creates a null map
+     */
+    GradientMap();
+    /*!
+     * \brief compute method computes the gradient magnitude of an image, it doesn't use any shared state and can run on any thread
+     * \param image is the image, its pixels are scene coordinates
+     * \return returns the map, a null map for a null image
+     */
+    static GradientMap compute(const QImage &image);
+    /*!
+     * \brief isNull method determines whether the map is empty
+     * \return returns true if there is no map
+     */
+    bool isNull() const;
+    /*!
+     * \brief size method gets the size of the image the map was computed from
+     * \return returns the size, empty for a null map
+     */
+    QSize size() const;
+    /*!
+     * \brief magnitude method gets the gradient magnitude of a pixel
+     * \param x is the column
+     * \param y is the row
+     * \return returns the magnitude (0 to 255), 0 outside the image
+     */
+    int magnitude(int x, int y) const;
+    /*!
+     * \brief snap method finds the strongest edge pixel within a radius of a point, the nearest one when several are as strong
+     * \param point is the point in scene coordinates
+     * \param radius is the search radius in pixels
+     * \param minStrength is the weakest magnitude accepted as an edge
+     * \return returns the center of the edge pixel, the point itself if there is no edge near it
+     */
+    QPointF snap(const QPointF &point, int radius = SNAP_RADIUS, int minStrength = SNAP_MIN_STRENGTH) const;
+    /*!
+     * \brief memoryUsed method gets the size of the map
+     * \return returns the number of bytes
+     */
+    qint64 memoryUsed() const;
+
+private:
+    /*!
+     * \brief sobelRow method computes the magnitudes of one row from the gray rows above, at and below it (the first and last pixels are left out)
+     */
+    static void sobelRow(const quint8 *above, const quint8 *row, const quint8 *below, int width, quint8 *out);
+
+private:
+    /*!
+     * \brief width is the image width
+     */
+    int width;
+    /*!
+     * \brief height is the image height
+     */
+    int height;
+    /*!
+     * \brief data stores the magnitudes row by row, |gx| + |gy| scaled down to a byte
+     */
+    QVector<quint8> data;
+};
+
+#endif // GRADIENTMAP_H
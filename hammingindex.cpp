@@ -0,0 +1,80 @@
+#include "hammingindex.h"
+
+#define HAMMING_TABLES  4
+#define HAMMING_BUCKETS 65536
+
+HammingIndex::HammingIndex()
+{
+}
+
+quint16 HammingIndex::chunk(quint64 hash, int table){
+    return quint16(hash >> (16 * table));
+}
+
+void HammingIndex::build(const QVector<quint64> &theHashes){
+
+    hashes = theHashes;
+
+    for(int t = 0; t < HAMMING_TABLES; t++){
+        //Counting sort of the ids by chunk value
+        QVector<int> &offs = offsets[t];
+        offs.fill(0, HAMMING_BUCKETS + 1);
+        for(quint64 h : hashes)
+            offs[chunk(h, t) + 1]++;
+        for(int b = 0; b < HAMMING_BUCKETS; b++)
+            offs[b + 1] += offs[b];
+
+        QVector<int> fill = offs;
+        ids[t].resize(hashes.size());
+        bucketHashes[t].resize(hashes.size());
+        for(int i = 0; i < hashes.size(); i++){
+            int k = fill[chunk(hashes[i], t)]++;
+            ids[t][k] = i;
+            bucketHashes[t][k] = hashes[i];
+        }
+    }
+}
+
+int HammingIndex::size() const{
+    return hashes.size();
+}
+
+void HammingIndex::probe(int table, quint16 value, quint64 hash, int radius, int chunkRadius, QVector<int> *result) const{
+
+    const QVector<int> &offs = offsets[table];
+    const quint64 *bucket = bucketHashes[table].constData();
+    for(int k = offs[value]; k < offs[value + 1]; k++){
+        quint64 other = bucket[k];
+        if(qPopulationCount(other ^ hash) > radius)
+            continue;
+
+        //An earlier table whose chunk is close enough has reported this id already
+        bool seen = false;
+        for(int t = 0; t < table && !seen; t++)
+            seen = qPopulationCount(quint16(chunk(other, t) ^ chunk(hash, t))) <= chunkRadius;
+
+        if(!seen)
+            result->append(ids[table][k]);
+    }
+}
+
+void HammingIndex::query(quint64 hash, int radius, QVector<int> *result) const{
+
+    result->clear();
+    if(hashes.isEmpty() || radius < 0)
+        return;
+
+    int chunkRadius = qMin(radius / HAMMING_TABLES, 2);
+
+    for(int t = 0; t < HAMMING_TABLES; t++){
+        quint16 value = chunk(hash, t);
+        probe(t, value, hash, radius, chunkRadius, result);
+
+        for(int i = 0; chunkRadius >= 1 && i < 16; i++){
+            probe(t, quint16(value ^ (1 << i)), hash, radius, chunkRadius, result);
+
+            for(int j = i + 1; chunkRadius >= 2 && j < 16; j++)
+                probe(t, quint16(value ^ (1 << i) ^ (1 << j)), hash, radius, chunkRadius, result);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef HAMMINGINDEX_H
+#define HAMMINGINDEX_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/*!
+ * \brief The HammingIndex class finds the 64 bit hashes within a Hamming distance of a query (multi-index hashing)
+ *
+ * Each hash is split into four 16 bit chunks with one table per chunk. Two hashes at distance r or less
+ * have at least one chunk at distance r/4 or less, so only the buckets within that chunk distance are probed.
+ * The tables are stored as flat arrays (bucket offsets plus ids), which is compact enough for millions of hashes.
+ */
+class HammingIndex
+{
+public:
+    /*!
+     * \brief HammingIndex constructor creates an empty index
+     */
+    HammingIndex();
+    /*!
+     * \brief build method indexes the hashes, their positions are the ids returned by query
+     * \param theHashes are the hashes to index
+     */
+    void build(const QVector<quint64> &theHashes);
+    /*!
+     * \brief query method finds the indexed hashes within a distance of a hash (safe to call from several threads at once)
+     * \param hash is the query hash
+     * \param radius is the largest distance accepted (up to 11)
+     * \param result receives the ids found, each id once
+     */
+    void query(quint64 hash, int radius, QVector<int> *result) const;
+    /*!
+     * \brief size method gets the number of indexed hashes
+     */
+    int size() const;
+
+private:
+    /*!
+     * \brief probe method collects the ids of one bucket that are within radius and not already reported by an earlier table
+     */
+    void probe(int table, quint16 value, quint64 hash, int radius, int chunkRadius, QVector<int> *result) const;
+    /*!
+     * \brief chunk method gets one 16 bit chunk of a hash
+     */
+    static quint16 chunk(quint64 hash, int table);
+
+private:
+    /*!
+     * \brief hashes stores the indexed hashes by id
+     */
+    QVector<quint64> hashes;
+    /*!
+     * \brief offsets stores, per table, where each of the 65536 buckets starts in ids (plus the end)
+     */
+    QVector<int> offsets[4];
+    /*!
+     * \brief ids stores, per table, the ids ordered by bucket
+     */
+    QVector<int> ids[4];
+    /*!
+     * \brief bucketHashes stores, per table, the hashes in the same order as ids so a bucket is scanned sequentially
+     */
+    QVector<quint64> bucketHashes[4];
+};
+
+#endif // HAMMINGINDEX_H
@@ -12,3 +12,7 @@ IClass::IClass(QString theClass)
 QString IClass::getName(){
     return className;
 }
+
+QString IClass::getKey() const{
+    return className;
+}
@@ -22,6 +22,11 @@ public:
      * \return returns the class name
      */
     QString getName();
+    /*!
+     * \brief getKey method gets the identity of the class used to refuse duplicates, which is the class name
+     * \return returns the class name
+     */
+    QString getKey() const;
 
 private:
     /*!
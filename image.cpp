@@ -4,18 +4,40 @@ Image::Image(){
 
 }
 
-Image::Image(QString imgName,QString imgPath, QDate imgDate) : imageName(imgName), imagePath(imgPath), imageDate(imgDate)
+Image::Image(QString imgName,QString imgPath, QDateTime imgDate) : imageName(imgName), imagePath(imgPath), imageDate(imgDate)
 {
 }
 
-QString Image::getName(){
+QString Image::getName() const{
     return imageName;
 }
 
-QString Image::getPath(){
+QString Image::getPath() const{
     return imagePath;
 }
 
-QDate Image::getDate(){
+QDateTime Image::getDate() const{
     return imageDate;
 }
+
+void Image::setSize(const QSize &size){
+    imageSize = size;
+}
+
+QSize Image::getSize() const{
+    return imageSize;
+}
+
+void Image::setHash(const QByteArray &hash){
+    contentHash = hash;
+}
+
+QByteArray Image::getHash() const{
+    return contentHash;
+}
+
+QString Image::getKey() const{
+    if(contentHash.isEmpty())
+        return imagePath;
+    return QString::fromLatin1(contentHash.toHex());
+}
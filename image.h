@@ -3,7 +3,9 @@
 
 
 #include <QString>
-#include <QDate>
+#include <QDateTime>
+#include <QSize>
+#include <QByteArray>
 
 class Image{
 public:
@@ -12,24 +14,49 @@ public:
      */
     Image();
     /*!
-     * \brief Image constructor intialises image name,path and date
+     * \brief Image constructor intialises image name,path and date (the capture time when the file has one)
      */
-    Image(QString, QString, QDate);
+    Image(QString, QString, QDateTime);
     /*!
      * \brief getName method gets the image name
      * \return returns the image name
      */
-    QString getName();
+    QString getName() const;
     /*!
      * \brief getPath method gets the image path
      * \return returns the image path
      */
-    QString getPath();
+    QString getPath() const;
     /*!
      * \brief getDate method gets the image date
-     * \return returns the image date
+     * \return returns the image date and time
      */
-    QDate getDate();
+    QDateTime getDate() const;
+    /*!
+     * \brief setSize method sets the image dimensions read from the file header
+     * \param size is the image size in pixels
+     */
+    void setSize(const QSize &size);
+    /*!
+     * \brief getSize method gets the image dimensions
+     * \return returns the image size in pixels, invalid if it's not known
+     */
+    QSize getSize() const;
+    /*!
+     * \brief setHash method sets the content hash of the image file
+     * \param hash is the content hash
+     */
+    void setHash(const QByteArray &hash);
+    /*!
+     * \brief getHash method gets the content hash of the image file
+     * \return returns the content hash, empty if it's not known
+     */
+    QByteArray getHash() const;
+    /*!
+     * \brief getKey method gets the identity of the image, used to refuse duplicates (the content hash, or the path when the hash is not known)
+     * \return returns the image key
+     */
+    QString getKey() const;
 private:
     /*!
      * \brief imageName variable stores the image name
@@ -42,7 +69,15 @@ private:
     /*!
      * \brief imageDate variable stores the image date
      */
-    QDate imageDate;
+    QDateTime imageDate;
+    /*!
+     * \brief imageSize variable stores the image dimensions
+     */
+    QSize imageSize;
+    /*!
+     * \brief contentHash variable stores the hash of the image file content
+     */
+    QByteArray contentHash;
 };
 
 #endif // IMAGE_H
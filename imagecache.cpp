@@ -0,0 +1,70 @@
+#include "imagecache.h"
+#include "perfcounters.h"
+#include "trace.h"
+
+ImageCache::ImageCache(int limitKB) : cache(limitKB)
+{
+    publish();
+}
+
+QString ImageCache::key(const QString &path, const QSize &size){
+    return QString::number(size.width()) + 'x' + QString::number(size.height()) + ':' + path;
+}
+
+QPixmap ImageCache::pixmap(const QString &path, const QSize &size){
+
+    CachedImage *cached = cache.object(key(path, size));
+    if(cached)
+        return cached->pixmap;
+
+    QImage image = decode(path, size);
+    if(image.isNull())
+        return QPixmap();
+
+    QPixmap pix = QPixmap::fromImage(image);
+    insert(path, size, pix, GradientMap::compute(image));
+    return pix;
+}
+
+GradientMap ImageCache::gradient(const QString &path, const QSize &size) const{
+    CachedImage *cached = cache.object(key(path, size));
+    return cached ? cached->gradient : GradientMap();
+}
+
+QImage ImageCache::decode(const QString &path, const QSize &size){
+
+    QImage image;
+    {
+        TRACE_SCOPE("decode image", "image");
+        image.load(path);
+    }
+
+    if(image.isNull())
+        return image;
+
+    TRACE_SCOPE("scale image", "image");
+    return image.scaled(size, Qt::KeepAspectRatio);
+}
+
+void ImageCache::insert(const QString &path, const QSize &size, const QPixmap &pix, const GradientMap &gradient){
+
+    qint64 bytes = qint64(pix.width()) * pix.height() * pix.depth() / 8 + gradient.memoryUsed();
+    int costKB = qMax(1, int(bytes / 1024));
+    cache.insert(key(path, size), new CachedImage{pix, gradient}, costKB); //the cache owns the copy
+    publish();
+}
+
+bool ImageCache::contains(const QString &path, const QSize &size) const{
+    return cache.contains(key(path, size));
+}
+
+void ImageCache::clear(){
+    cache.clear();
+    publish();
+}
+
+void ImageCache::publish(){
+    PerfCounters::imageCacheBytes.store(qint64(cache.totalCost()) * 1024, std::memory_order_relaxed);
+    PerfCounters::imageCacheLimit.store(qint64(cache.maxCost()) * 1024, std::memory_order_relaxed);
+    PerfCounters::imageCacheCount.store(cache.count(), std::memory_order_relaxed);
+}
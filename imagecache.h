@@ -0,0 +1,97 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QCache>
+#include <QPixmap>
+#include <QImage>
+#include <QString>
+
+#include "gradientmap.h"
+
+/*!
+ * \brief IMAGE_CACHE_LIMIT_KB is the memory budget of the decoded images, in KB
+ */
+#define IMAGE_CACHE_LIMIT_KB (256 * 1024)
+
+/*!
+ * \brief The CachedImage struct is a decoded image with the data computed from its pixels
+ */
+struct CachedImage
+{
+    /*!
+     * \brief pixmap is the image scaled to the scene size
+     */
+    QPixmap pixmap;
+    /*!
+     * \brief gradient is its gradient map, used for edge snapping
+     */
+    GradientMap gradient;
+};
+
+/*!
+ * \brief The ImageCache class keeps the most recently displayed images decoded and scaled to the scene size, so going back to an image does not decode it again
+ */
+class ImageCache
+{
+public:
+    /*!
+     * \brief ImageCache constructor creates an empty cache
+     * \param limitKB is the memory budget in KB, the least recently used images are dropped beyond it
+     */
+    ImageCache(int limitKB = IMAGE_CACHE_LIMIT_KB);
+    /*!
+     * \brief pixmap method gets an image scaled to fit the size, decoding it if it is not cached
+     * \param path is the image path
+     * \param size is the size the image is scaled to fit (keeping the aspect ratio)
+     * \return returns the scaled image, a null pixmap if the file can't be decoded
+     */
+    QPixmap pixmap(const QString &path, const QSize &size);
+    /*!
+     * \brief gradient method gets the gradient map of a cached image
+     * \param path is the image path
+     * \param size is the size the image was scaled to fit
+     * \return returns the map, a null map if the image is not cached
+     */
+    GradientMap gradient(const QString &path, const QSize &size) const;
+    /*!
+     * \brief decode method decodes an image and scales it to fit the size, it doesn't use the cache and can run on any thread
+     * \param path is the image path
+     * \param size is the size the image is scaled to fit (keeping the aspect ratio)
+     * \return returns the scaled image, a null image if the file can't be decoded
+     */
+    static QImage decode(const QString &path, const QSize &size);
+    /*!
+     * \brief insert method adds a scaled image to the cache
+     * \param path is the image path
+     * \param size is the size it was scaled to fit
+     * \param pix is the scaled image
+     * \param gradient is its gradient map, computed on the thread that decoded it
+     */
+    void insert(const QString &path, const QSize &size, const QPixmap &pix, const GradientMap &gradient);
+    /*!
+     * \brief contains method determines whether an image is cached
+     */
+    bool contains(const QString &path, const QSize &size) const;
+    /*!
+     * \brief clear method drops every cached image
+     */
+    void clear();
+
+private:
+    /*!
+     * \brief key method gets the cache key of an image at a size
+     */
+    static QString key(const QString &path, const QSize &size);
+    /*!
+     * \brief publish method updates the image cache counters of the performance overlay
+     */
+    void publish();
+
+private:
+    /*!
+     * \brief cache stores the scaled images and their gradient maps, the cost of an entry is their size in KB
+     */
+    QCache<QString, CachedImage> cache;
+};
+
+#endif // IMAGECACHE_H
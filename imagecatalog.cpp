@@ -0,0 +1,159 @@
+#include "imagecatalog.h"
+#include "memorystats.h"
+#include "trace.h"
+
+#include <algorithm>
+
+ImageCatalog::Snapshot::Snapshot()
+{
+    std::shared_ptr<State> empty = std::make_shared<State>();
+    empty->size = 0;
+    empty->version = 0;
+    state = empty;
+}
+
+ImageCatalog::Snapshot::Snapshot(const std::shared_ptr<const State> &theState) : state(theState)
+{
+}
+
+int ImageCatalog::Snapshot::size() const{
+    return state->size;
+}
+
+const Image &ImageCatalog::Snapshot::at(int i) const{
+    return state->chunks[i / CATALOG_CHUNK_SIZE]->at(i % CATALOG_CHUNK_SIZE);
+}
+
+QVector<Image> ImageCatalog::Snapshot::items() const{
+
+    QVector<Image> result;
+    result.reserve(state->size);
+    for(const std::shared_ptr<const QVector<Image> > &chunk : state->chunks)
+        result += *chunk;
+    return result;
+}
+
+quint64 ImageCatalog::Snapshot::version() const{
+    return state->version;
+}
+
+ImageCatalog::ImageCatalog()
+{
+    current = Snapshot().state;
+}
+
+ImageCatalog::Snapshot ImageCatalog::snapshot() const{
+    return Snapshot(std::atomic_load(&current));
+}
+
+void ImageCatalog::publish(const std::shared_ptr<const State> &state){
+    std::atomic_store(&current, state); //readers holding the previous version keep it alive
+}
+
+QVector<std::shared_ptr<const QVector<Image> > > ImageCatalog::chunked(const QVector<Image> &images){
+
+    QVector<std::shared_ptr<const QVector<Image> > > chunks;
+    for(int start = 0; start < images.size(); start += CATALOG_CHUNK_SIZE)
+        chunks.append(std::make_shared<const QVector<Image> >(images.mid(start, CATALOG_CHUNK_SIZE)));
+    return chunks;
+}
+
+int ImageCatalog::add(const QVector<Image> &images, QStringList *existing){
+
+    TRACE_SCOPE("catalog add", "catalog");
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    QVector<Image> added;
+    for(const Image &img : images){
+        QString key = img.getKey();
+        QHash<QString, QString>::const_iterator it = keys.constFind(key);
+        if(existing)
+            existing->append(it == keys.constEnd() ? QString() : it.value());
+        if(it != keys.constEnd())
+            continue;
+
+        keys.insert(key, img.getPath());
+        added.append(img);
+    }
+
+    if(added.isEmpty())
+        return 0;
+
+    //Only the last chunk is copied, the full ones are shared with the previous version
+    std::shared_ptr<const State> old = std::atomic_load(&current);
+    std::shared_ptr<State> next = std::make_shared<State>();
+    next->chunks = old->chunks;
+    next->size = old->size + added.size();
+    next->version = old->version + 1;
+
+    QVector<Image> tail;
+    if(!next->chunks.isEmpty() && next->chunks.last()->size() < CATALOG_CHUNK_SIZE){
+        tail = *next->chunks.last();
+        next->chunks.removeLast();
+    }
+    tail += added;
+    next->chunks += chunked(tail);
+
+    publish(next);
+    return added.size();
+}
+
+void ImageCatalog::sort(Order order){
+
+    TRACE_SCOPE("catalog sort", "catalog");
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    std::shared_ptr<const State> old = std::atomic_load(&current);
+    QVector<Image> images = Snapshot(old).items();
+
+    switch(order){
+    case Order::NameAscending:
+        std::stable_sort(images.begin(), images.end(), [](const Image &a, const Image &b) {
+            return a.getName().compare(b.getName(), Qt::CaseInsensitive) < 0;
+        });
+        break;
+    case Order::NameDescending:
+        std::stable_sort(images.begin(), images.end(), [](const Image &a, const Image &b) {
+            return a.getName().compare(b.getName(), Qt::CaseInsensitive) > 0;
+        });
+        break;
+    case Order::DateAscending:
+        std::stable_sort(images.begin(), images.end(), [](const Image &a, const Image &b) {
+            return a.getDate() < b.getDate();
+        });
+        break;
+    case Order::DateDescending:
+        std::stable_sort(images.begin(), images.end(), [](const Image &a, const Image &b) {
+            return a.getDate() > b.getDate();
+        });
+        break;
+    }
+
+    std::shared_ptr<State> next = std::make_shared<State>();
+    next->chunks = chunked(images);
+    next->size = images.size();
+    next->version = old->version + 1;
+    publish(next);
+}
+
+bool ImageCatalog::contains(const QString &key) const{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return keys.contains(key);
+}
+
+int ImageCatalog::size() const{
+    return snapshot().size();
+}
+
+qint64 ImageCatalog::memoryUsed() const{
+
+    Snapshot snap = snapshot();
+    qint64 bytes = sizeof(State) + snap.state->chunks.size() * qint64(sizeof(QVector<Image>));
+    for(int i = 0; i < snap.size(); i++)
+        bytes += MemoryStats::itemBytes(snap.at(i));
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    for(QHash<QString, QString>::const_iterator it = keys.constBegin(); it != keys.constEnd(); ++it)
+        bytes += MemoryStats::stringBytes(it.key()); //the paths are shared with the images
+    return bytes;
+}
@@ -0,0 +1,151 @@
+#ifndef IMAGECATALOG_H
+#define IMAGECATALOG_H
+
+#include "image.h"
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+#include <memory>
+#include <mutex>
+
+/*!
+ * \brief CATALOG_CHUNK_SIZE is the number of images per chunk, a new snapshot only copies the chunks that changed
+ */
+#define CATALOG_CHUNK_SIZE 1024
+
+/*!
+ * \brief The ImageCatalog class stores the imported images. Readers on any thread take a snapshot, an immutable view that never changes, without locking
+ *
+ * There is a single writer at a time (the gui thread). Each change builds a new version sharing the unchanged chunks with the previous one
+ * and publishes it atomically, snapshots taken earlier keep the version they were taken from until they are released.
+ */
+class ImageCatalog
+{
+private:
+    /*!
+     * \brief The State struct is one published version of the catalog, it is never modified once published
+     */
+    struct State
+    {
+        QVector<std::shared_ptr<const QVector<Image> > > chunks;
+        int size;
+        quint64 version;
+    };
+
+public:
+    /*!
+     * \brief The Order enum is the order of the images
+     */
+    enum class Order { NameAscending, NameDescending, DateAscending, DateDescending };
+
+    /*!
+     * \brief The Snapshot class is a consistent view of the catalog, cheap to copy and safe to read from any thread
+     */
+    class Snapshot
+    {
+    public:
+        /*!
+         * \brief Snapshot constructor creates an empty snapshot
+         */
+        Snapshot();
+        /*!
+         * \brief size method gets the number of images
+         * \return returns the number of images
+         */
+        int size() const;
+        /*!
+         * \brief at method gets an image
+         * \param i is the position of the image, from 0 to size - 1
+         * \return returns the image
+         */
+        const Image &at(int i) const;
+        /*!
+         * \brief items method gets a copy of all the images in their order
+         * \return returns the images
+         */
+        QVector<Image> items() const;
+        /*!
+         * \brief version method gets the version the snapshot was taken from, it grows with every change
+         * \return returns the version
+         */
+        quint64 version() const;
+
+    private:
+        friend class ImageCatalog;
+        /*!
+         * \brief Snapshot constructor views a published version
+         */
+        explicit Snapshot(const std::shared_ptr<const State> &theState);
+        /*!
+         * \brief state is the version being viewed
+         */
+        std::shared_ptr<const State> state;
+    };
+
+    /*!
+     * \brief ImageCatalog constructor creates an empty catalog
+     */
+    ImageCatalog();
+    /*!
+     * \brief snapshot method gets the current version of the catalog, it doesn't lock
+     * \return returns the snapshot
+     */
+    Snapshot snapshot() const;
+    /*!
+     * \brief add method appends the images whose key (see Image::getKey) is not in the catalog yet and publishes them as one new version
+     * \param images are the images
+     * \param existing receives for each image the path of the image with the same key, empty when the image was added
+     * \return returns the number of images added
+     */
+    int add(const QVector<Image> &images, QStringList *existing = nullptr);
+    /*!
+     * \brief sort method reorders the images and publishes the new order
+     * \param order is the order
+     */
+    void sort(Order order);
+    /*!
+     * \brief contains method determines whether an image with the key is in the catalog
+     * \param key is the image key
+     * \return returns true if it is
+     */
+    bool contains(const QString &key) const;
+    /*!
+     * \brief size method gets the number of images in the current version
+     * \return returns the number of images
+     */
+    int size() const;
+    /*!
+     * \brief memoryUsed method estimates the memory taken by the current version (older versions still held by readers are not counted)
+     * \return returns the number of bytes
+     */
+    qint64 memoryUsed() const;
+
+private:
+    /*!
+     * \brief publish method makes a new version visible to the readers
+     */
+    void publish(const std::shared_ptr<const State> &state);
+    /*!
+     * \brief chunked method splits images into chunks
+     */
+    static QVector<std::shared_ptr<const QVector<Image> > > chunked(const QVector<Image> &images);
+
+private:
+    /*!
+     * \brief current is the published version, read and replaced with the atomic shared_ptr functions
+     */
+    std::shared_ptr<const State> current;
+    /*!
+     * \brief writeMutex serialises the writers and protects keys
+     */
+    mutable std::mutex writeMutex;
+    /*!
+     * \brief keys maps the key of every image to its path
+     */
+    QHash<QString, QString> keys;
+};
+
+#endif // IMAGECATALOG_H
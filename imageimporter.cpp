@@ -0,0 +1,68 @@
+#include "imageimporter.h"
+#include "contenthasher.h"
+#include "exifreader.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+
+ImageImporter::ImageImporter(CatalogCache *theCache) : cache(theCache)
+{
+}
+
+CatalogEntry ImageImporter::probeFile(const CatalogEntry &entry){
+
+    CatalogEntry result = entry;
+    if(result.contentHash.isEmpty())
+        result.contentHash = ContentHasher::hashFile(entry.path);
+
+    if(!result.hasMetadata){
+        ExifInfo info; //header bytes only, the pixels are not decoded
+        ExifReader::read(entry.path, &info);
+        result.captured = info.captured.isValid() ? info.captured.toMSecsSinceEpoch() : -1;
+        result.width = info.width;
+        result.height = info.height;
+        result.hasMetadata = true;
+    }
+    return result;
+}
+
+QVector<CatalogEntry> ImageImporter::probe(const QStringList &paths){
+
+    TRACE_SCOPE("probe images", "import");
+
+    QVector<CatalogEntry> entries(paths.size());
+    QVector<CatalogEntry> missing;
+    QVector<int> missingAt;
+
+    for(int i = 0; i < paths.size(); i++){
+        QFileInfo info(paths[i]);
+        CatalogEntry &entry = entries[i];
+        entry.path = paths[i];
+        entry.size = info.size();
+        entry.modified = info.lastModified().toMSecsSinceEpoch();
+
+        if(!cache->lookup(&entry) || entry.contentHash.isEmpty() || !entry.hasMetadata){
+            missing.append(entry);
+            missingAt.append(i);
+        }
+    }
+
+    if(missing.isEmpty())
+        return entries;
+
+    //Probe the files not in the cache on the workers, reading is the expensive part
+    QVector<CatalogEntry> computed(missing.size());
+    TaskScheduler::instance()->parallelFor(missing.size(), [&](int i) {
+        computed[i] = probeFile(missing[i]);
+    });
+
+    for(int i = 0; i < computed.size(); i++){
+        entries[missingAt[i]] = computed[i];
+        if(!computed[i].contentHash.isEmpty())
+            cache->insert(computed[i]);
+    }
+
+    return entries;
+}
@@ -0,0 +1,42 @@
+#ifndef IMAGEIMPORTER_H
+#define IMAGEIMPORTER_H
+
+#include "catalogcache.h"
+
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief The ImageImporter class gathers the catalog entries of the files being imported (content hash, capture time and dimensions). Values found in the cache are reused and the rest are computed on worker threads
+ */
+class ImageImporter
+{
+public:
+    /*!
+     * \brief ImageImporter constructor takes the cache used to skip unchanged files
+     * \param theCache is the catalog cache (not owned)
+     */
+    ImageImporter(CatalogCache *theCache);
+    /*!
+     * \brief probe method gets the entries of the given files in the same order, files that can't be read get an empty content hash
+     * \param paths are the image paths
+     * \return returns the catalog entries
+     */
+    QVector<CatalogEntry> probe(const QStringList &paths);
+
+private:
+    /*!
+     * \brief probeFile method computes the values of a single entry (runs on a worker thread)
+     * \param entry is the entry with path, size and modified set
+     * \return returns the completed entry
+     */
+    static CatalogEntry probeFile(const CatalogEntry &entry);
+
+private:
+    /*!
+     * \brief cache is the catalog cache used and updated by probe
+     */
+    CatalogCache *cache;
+};
+
+#endif // IMAGEIMPORTER_H
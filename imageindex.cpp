@@ -0,0 +1,286 @@
+#include "imageindex.h"
+#include "memorystats.h"
+
+#include <algorithm>
+#include <iterator>
+
+ImageIndex::ImageIndex()
+{
+}
+
+quint64 ImageIndex::trigramKey(const QChar *c){
+    return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | quint64(c[2].unicode());
+}
+
+void ImageIndex::insert(const QString &path, const QString &name, const QDateTime &date){
+
+    if(ids.contains(path))
+        return;
+
+    int id = foldedNames.size();
+    QString folded = name.toLower();
+
+    foldedNames.append(folded);
+    dates.append(date);
+    annotated.append(false);
+    classes.append(QStringList());
+    paths.append(path);
+    group.append(id);
+    groupSize.append(1);
+    ids.insert(path, id);
+
+    for(int i = 0; i + 3 <= folded.size(); i++){
+        QVector<int> &list = postings[trigramKey(folded.constData() + i)];
+        if(list.isEmpty() || list.last() != id) //a trigram repeated in the same name is stored once
+            list.append(id);
+    }
+}
+
+void ImageIndex::clear(){
+    foldedNames.clear();
+    dates.clear();
+    annotated.clear();
+    classes.clear();
+    paths.clear();
+    group.clear();
+    groupSize.clear();
+    ids.clear();
+    postings.clear();
+}
+
+int ImageIndex::size() const{
+    return foldedNames.size();
+}
+
+int ImageIndex::id(const QString &path) const{
+    return ids.value(path, -1);
+}
+
+void ImageIndex::setAnnotated(const QString &path, const QStringList &classNames){
+
+    int i = id(path);
+    if(i < 0)
+        return;
+
+    QStringList folded;
+    for(const QString &name : classNames){
+        if(!folded.contains(name.toLower()))
+            folded.append(name.toLower());
+    }
+
+    annotated[i] = true;
+    classes[i] = folded;
+}
+
+bool ImageIndex::isAnnotated(const QString &path) const{
+    int i = id(path);
+    return i >= 0 && annotated[i];
+}
+
+void ImageIndex::setGroups(const QStringList &groupPaths, const QVector<int> &groups){
+
+    for(int i = 0; i < size(); i++){
+        group[i] = i;
+        groupSize[i] = 1;
+    }
+
+    for(int i = 0; i < groupPaths.size(); i++){
+        int member = id(groupPaths[i]);
+        int leader = id(groupPaths[groups[i]]);
+        if(member < 0 || leader < 0 || member == leader)
+            continue;
+        group[member] = leader;
+        groupSize[leader]++;
+    }
+}
+
+QString ImageIndex::groupOf(const QString &path) const{
+    int i = id(path);
+    if(i < 0)
+        return path;
+    return paths[group[i]];
+}
+
+ImageIndex::Query ImageIndex::parse(const QString &text){
+
+    Query q;
+    q.status = Status::Any;
+    q.duplicates = Duplicates::Any;
+
+    for(const QString &word : text.toLower().split(' ', Qt::SkipEmptyParts)){
+        if(word == "is:annotated"){
+            q.status = Status::Annotated;
+        }else if(word == "is:unannotated"){
+            q.status = Status::Unannotated;
+        }else if(word == "is:unique"){
+            q.duplicates = Duplicates::Unique;
+        }else if(word == "is:duplicate"){
+            q.duplicates = Duplicates::Duplicate;
+        }else if(word.startsWith("class:") && word.size() > 6){
+            q.classes.append(word.mid(6));
+        }else if(word.startsWith("after:")){
+            q.after = QDate::fromString(word.mid(6), "yyyy-MM-dd");
+        }else if(word.startsWith("before:")){
+            q.before = QDate::fromString(word.mid(7), "yyyy-MM-dd");
+        }else{
+            q.terms.append(word);
+        }
+    }
+    return q;
+}
+
+QVector<int> ImageIndex::candidates(const QStringList &parts, bool *ok) const{
+
+    //Gather the posting lists of every trigram, then intersect them starting from the shortest
+    QVector<const QVector<int>*> lists;
+    static const QVector<int> empty;
+
+    for(const QString &part : parts){
+        for(int i = 0; i + 3 <= part.size(); i++){
+            QHash<quint64, QVector<int> >::const_iterator it = postings.constFind(trigramKey(part.constData() + i));
+            lists.append(it == postings.constEnd() ? &empty : &it.value());
+        }
+    }
+
+    *ok = !lists.isEmpty();
+    if(lists.isEmpty())
+        return QVector<int>();
+
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+        return a->size() < b->size();
+    });
+
+    QVector<int> result = *lists[0];
+    for(int i = 1; i < lists.size() && !result.isEmpty(); i++){
+        QVector<int> next;
+        std::set_intersection(result.constBegin(), result.constEnd(), lists[i]->constBegin(), lists[i]->constEnd(),
+                              std::back_inserter(next));
+        result = next;
+    }
+    return result;
+}
+
+bool ImageIndex::globMatch(const QString &name, const QString &pattern){
+
+    int n = 0, p = 0;
+    int starP = -1, starN = 0;
+
+    while(n < name.size()){
+        if(p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])){
+            n++;
+            p++;
+        }else if(p < pattern.size() && pattern[p] == '*'){
+            starP = p++;
+            starN = n;
+        }else if(starP >= 0){
+            p = starP + 1; //let the last * swallow one more character
+            n = ++starN;
+        }else{
+            return false;
+        }
+    }
+
+    while(p < pattern.size() && pattern[p] == '*')
+        p++;
+
+    return p == pattern.size();
+}
+
+QBitArray ImageIndex::matchTerm(const QString &term) const{
+
+    QBitArray bits(size(), false);
+    bool isGlob = term.contains('*') || term.contains('?');
+
+    QStringList parts;
+    if(isGlob){
+        QString literal;
+        for(const QChar &c : term){
+            if(c == '*' || c == '?'){
+                parts.append(literal);
+                literal.clear();
+            }else{
+                literal.append(c);
+            }
+        }
+        parts.append(literal);
+    }else{
+        parts.append(term);
+    }
+
+    bool indexed;
+    QVector<int> found = candidates(parts, &indexed);
+
+    if(indexed){
+        for(int i : found){
+            if(isGlob ? globMatch(foldedNames[i], term) : foldedNames[i].contains(term))
+                bits.setBit(i);
+        }
+    }else{
+        //Term too short for the trigram index, check every name
+        for(int i = 0; i < size(); i++){
+            if(isGlob ? globMatch(foldedNames[i], term) : foldedNames[i].contains(term))
+                bits.setBit(i);
+        }
+    }
+    return bits;
+}
+
+QBitArray ImageIndex::filter(const QString &text) const{
+
+    Query q = parse(text);
+    QBitArray bits(size(), true);
+
+    for(const QString &term : q.terms){
+        bits &= matchTerm(term);
+    }
+
+    bool checkStatus = q.status != Status::Any || !q.classes.isEmpty() || q.duplicates != Duplicates::Any;
+    bool checkDate = q.after.isValid() || q.before.isValid();
+    if(!checkStatus && !checkDate)
+        return bits;
+
+    for(int i = 0; i < size(); i++){
+        if(!bits.testBit(i))
+            continue;
+
+        bool keep = true;
+        if(q.status == Status::Annotated && !annotated[i])
+            keep = false;
+        else if(q.status == Status::Unannotated && annotated[i])
+            keep = false;
+
+        if(q.duplicates == Duplicates::Unique && group[i] != i)
+            keep = false; //only the first image of a group is shown
+        else if(q.duplicates == Duplicates::Duplicate && groupSize[group[i]] < 2)
+            keep = false;
+
+        for(int c = 0; keep && c < q.classes.size(); c++){
+            keep = classes[i].contains(q.classes[c]);
+        }
+
+        if(keep && q.after.isValid() && dates[i].date() < q.after)
+            keep = false;
+        if(keep && q.before.isValid() && dates[i].date() > q.before)
+            keep = false;
+
+        if(!keep)
+            bits.clearBit(i);
+    }
+    return bits;
+}
+
+qint64 ImageIndex::memoryUsed() const{
+
+    //the paths are shared with the catalog, only the folded names and class lists are the index's own
+    qint64 bytes = size() * qint64(sizeof(QDateTime) + sizeof(bool) + sizeof(QStringList) + sizeof(QString) + 2 * sizeof(int));
+    for(int i = 0; i < size(); i++){
+        bytes += MemoryStats::stringBytes(foldedNames[i]);
+        for(const QString &name : classes[i])
+            bytes += MemoryStats::stringBytes(name);
+    }
+
+    bytes += ids.size() * qint64(sizeof(QString) + sizeof(int) + 2 * sizeof(void*)); //hash nodes
+    for(QHash<quint64, QVector<int> >::const_iterator it = postings.constBegin(); it != postings.constEnd(); ++it)
+        bytes += sizeof(quint64) + sizeof(QVector<int>) + 2 * sizeof(void*) + it.value().capacity() * qint64(sizeof(int));
+    return bytes;
+}
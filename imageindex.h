@@ -0,0 +1,168 @@
+#ifndef IMAGEINDEX_H
+#define IMAGEINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <QDateTime>
+#include <QBitArray>
+
+/*!
+ * \brief The ImageIndex class indexes the image file names (trigram index) together with the annotation status and date of each image, so the image pane can be filtered quickly
+ *
+ * The filter text is a list of space separated terms which are all required:
+ * a plain word matches file names containing it, a word with * or ? is matched as a glob against the whole file name,
+ * is:annotated / is:unannotated filter by status, class:NAME keeps images annotated with that class,
+ * after:yyyy-MM-dd / before:yyyy-MM-dd filter by date, is:unique hides the near-duplicates of an image
+ * and is:duplicate keeps only images that have near-duplicates.
+ */
+class ImageIndex
+{
+public:
+    /*!
+     * \brief ImageIndex constructor creates an empty index
+     */
+    ImageIndex();
+    /*!
+     * \brief insert method adds an image to the index, images already indexed are ignored
+     * \param path is the image path which identifies the image
+     * \param name is the file name that is searched
+     * \param date is the image date
+     */
+    void insert(const QString &path, const QString &name, const QDateTime &date);
+    /*!
+     * \brief clear method removes all the images from the index
+     */
+    void clear();
+    /*!
+     * \brief size method gets the number of indexed images
+     * \return returns the number of images
+     */
+    int size() const;
+    /*!
+     * \brief id method gets the id of an image, the ids are the bit positions of the array returned by filter
+     * \param path is the image path
+     * \return returns the id or -1 if the image is not indexed
+     */
+    int id(const QString &path) const;
+    /*!
+     * \brief setAnnotated method records that an image has been annotated and with which classes
+     * \param path is the image path
+     * \param classes are the class names of the shapes on the image
+     */
+    void setAnnotated(const QString &path, const QStringList &classes);
+    /*!
+     * \brief isAnnotated method determines whether an image has been annotated
+     * \param path is the image path
+     * \return returns true if the image is annotated
+     */
+    bool isAnnotated(const QString &path) const;
+    /*!
+     * \brief setGroups method records the near-duplicate groups of the images
+     * \param paths are the image paths
+     * \param groups are, for each path, the index in paths of the first image of its group
+     */
+    void setGroups(const QStringList &paths, const QVector<int> &groups);
+    /*!
+     * \brief groupOf method gets the near-duplicate group of an image
+     * \param path is the image path
+     * \return returns the path of the first image of the group (the image itself when it has no near-duplicate)
+     */
+    QString groupOf(const QString &path) const;
+    /*!
+     * \brief filter method finds the images matching the filter text
+     * \param text is the filter text (see the class description for the syntax)
+     * \return returns a bit per image id, set when the image matches
+     */
+    QBitArray filter(const QString &text) const;
+    /*!
+     * \brief memoryUsed method estimates the memory taken by the index
+     * \return returns the number of bytes
+     */
+    qint64 memoryUsed() const;
+
+private:
+    /*!
+     * \brief The Status enum is the annotation status asked for by the filter
+     */
+    enum class Status { Any, Annotated, Unannotated };
+    /*!
+     * \brief The Duplicates enum is the near-duplicate condition asked for by the filter
+     */
+    enum class Duplicates { Any, Unique, Duplicate };
+    /*!
+     * \brief The Query struct is the parsed filter text
+     */
+    struct Query
+    {
+        QStringList terms;
+        QStringList classes;
+        Status status;
+        Duplicates duplicates;
+        QDate after;
+        QDate before;
+    };
+    /*!
+     * \brief parse method splits the filter text into name terms and conditions
+     */
+    static Query parse(const QString &text);
+    /*!
+     * \brief matchTerm method finds the images whose name matches a single (folded) term
+     */
+    QBitArray matchTerm(const QString &term) const;
+    /*!
+     * \brief candidates method intersects the posting lists of all trigrams of the given literal parts
+     * \param parts are the literal parts of a term
+     * \param ok is set to false when no part is long enough to use the index (every image is then a candidate)
+     */
+    QVector<int> candidates(const QStringList &parts, bool *ok) const;
+    /*!
+     * \brief globMatch method matches a whole name against a glob pattern with * and ?
+     */
+    static bool globMatch(const QString &name, const QString &pattern);
+    /*!
+     * \brief trigramKey method packs three characters into one hash key
+     */
+    static quint64 trigramKey(const QChar *c);
+
+private:
+    /*!
+     * \brief foldedNames stores the lower case file names, indexed by id
+     */
+    QVector<QString> foldedNames;
+    /*!
+     * \brief dates stores the image dates, indexed by id
+     */
+    QVector<QDateTime> dates;
+    /*!
+     * \brief annotated is true for the ids of annotated images
+     */
+    QVector<bool> annotated;
+    /*!
+     * \brief classes stores the lower case class names annotated on each image, indexed by id
+     */
+    QVector<QStringList> classes;
+    /*!
+     * \brief paths stores the image paths, indexed by id
+     */
+    QVector<QString> paths;
+    /*!
+     * \brief group stores the id of the first image of each image's near-duplicate group, indexed by id
+     */
+    QVector<int> group;
+    /*!
+     * \brief groupSize stores the number of images in the group led by each id
+     */
+    QVector<int> groupSize;
+    /*!
+     * \brief ids maps an image path to its id
+     */
+    QHash<QString, int> ids;
+    /*!
+     * \brief postings maps each trigram to the ids of the names containing it (ids are in ascending order)
+     */
+    QHash<quint64, QVector<int> > postings;
+};
+
+#endif // IMAGEINDEX_H
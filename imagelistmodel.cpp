@@ -0,0 +1,50 @@
+#include "imagelistmodel.h"
+
+ImageListModel::ImageListModel(QObject *parent) : QAbstractTableModel(parent)
+{
+}
+
+void ImageListModel::setImages(const QVector<Image> &theImages){
+    beginResetModel();
+    images = theImages;
+    endResetModel();
+}
+
+Image ImageListModel::imageAt(int row) const{
+    if(row < 0 || row >= images.size())
+        return Image();
+    return images[row];
+}
+
+int ImageListModel::rowCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : images.size();
+}
+
+int ImageListModel::columnCount(const QModelIndex &parent) const{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant ImageListModel::data(const QModelIndex &index, int role) const{
+
+    if(!index.isValid() || index.row() >= images.size())
+        return QVariant();
+
+    const Image &img = images[index.row()];
+
+    if(role == Qt::DisplayRole){
+        if(index.column() == 0)
+            return img.getName();
+        return img.getDate().toString("yyyy-MM-dd hh:mm:ss");
+    }else if(role == Qt::ToolTipRole){
+        return img.getPath();
+    }
+    return QVariant();
+}
+
+QVariant ImageListModel::headerData(int section, Qt::Orientation orientation, int role) const{
+
+    if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    return section == 0 ? QString("Name") : QString("Date");
+}
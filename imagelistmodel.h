@@ -0,0 +1,55 @@
+#ifndef IMAGELISTMODEL_H
+#define IMAGELISTMODEL_H
+
+#include "image.h"
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+/*!
+ * \brief The ImageListModel class provides the rows of the image pane (name and date columns). The view only creates what is visible, so the pane stays fast with very large catalogs
+ */
+class ImageListModel : public QAbstractTableModel
+{
+public:
+    /*!
+     * \brief ImageListModel constructor creates an empty model
+     * \param parent is the parent object
+     */
+    ImageListModel(QObject *parent = nullptr);
+    /*!
+     * \brief setImages method replaces the rows shown in the image pane
+     * \param images are the images in display order
+     */
+    void setImages(const QVector<Image> &images);
+    /*!
+     * \brief imageAt method gets the image displayed on a row
+     * \param row is the row number
+     * \return returns the image on that row
+     */
+    Image imageAt(int row) const;
+    /*!
+     * \brief rowCount method gets the number of rows in the pane
+     */
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    /*!
+     * \brief columnCount method gets the number of columns (name and date)
+     */
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    /*!
+     * \brief data method gets the text shown in a cell, the tooltip shows the full image path
+     */
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    /*!
+     * \brief headerData method gets the column titles
+     */
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    /*!
+     * \brief images stores the images shown in the pane
+     */
+    QVector<Image> images;
+};
+
+#endif // IMAGELISTMODEL_H
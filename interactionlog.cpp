@@ -0,0 +1,263 @@
+#include "interactionlog.h"
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QGraphicsView>
+#include <QGraphicsSceneMouseEvent>
+#include <QKeyEvent>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QPixmap>
+#include <QMap>
+
+#include <algorithm>
+
+InteractionRecorder::InteractionRecorder(Scene *theScene, QObject *parent) : QObject(parent), scene(theScene), recording(false)
+{
+}
+
+void InteractionRecorder::start(){
+
+    shapes = scene->shapes();
+    sceneRect = scene->sceneRect();
+    events = QJsonArray();
+    clock.start();
+
+    if(!recording)
+        scene->installEventFilter(this);
+    recording = true;
+}
+
+void InteractionRecorder::stop(){
+
+    if(recording)
+        scene->removeEventFilter(this);
+    recording = false;
+}
+
+bool InteractionRecorder::isRecording() const{
+    return recording;
+}
+
+int InteractionRecorder::eventCount() const{
+    return events.size();
+}
+
+bool InteractionRecorder::eventFilter(QObject *obj, QEvent *event){
+
+    if(obj != scene)
+        return QObject::eventFilter(obj, event);
+
+    QJsonObject e;
+    switch(event->type()){
+    case QEvent::GraphicsSceneMousePress:
+        e.insert("type", "press");
+        break;
+    case QEvent::GraphicsSceneMouseMove:
+        e.insert("type", "move");
+        break;
+    case QEvent::GraphicsSceneMouseRelease:
+        e.insert("type", "release");
+        break;
+    case QEvent::KeyPress:
+        e.insert("type", "keypress");
+        break;
+    case QEvent::KeyRelease:
+        e.insert("type", "keyrelease");
+        break;
+    default:
+        return QObject::eventFilter(obj, event);
+    }
+
+    e.insert("t", double(clock.elapsed()));
+    e.insert("mode", int(scene->mode())); //the mode is set from the toolbar, outside the scene events
+
+    if(event->type() == QEvent::KeyPress || event->type() == QEvent::KeyRelease){
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        e.insert("key", keyEvent->key());
+        e.insert("modifiers", int(keyEvent->modifiers()));
+        e.insert("text", keyEvent->text());
+        e.insert("autoRepeat", keyEvent->isAutoRepeat());
+    }else{
+        //items are dragged relative to the last and the button down positions, so those are kept too
+        QGraphicsSceneMouseEvent *mouseEvent = static_cast<QGraphicsSceneMouseEvent*>(event);
+        e.insert("x", mouseEvent->scenePos().x());
+        e.insert("y", mouseEvent->scenePos().y());
+        e.insert("lastX", mouseEvent->lastScenePos().x());
+        e.insert("lastY", mouseEvent->lastScenePos().y());
+        e.insert("downX", mouseEvent->buttonDownScenePos(Qt::LeftButton).x());
+        e.insert("downY", mouseEvent->buttonDownScenePos(Qt::LeftButton).y());
+        e.insert("button", int(mouseEvent->button()));
+        e.insert("buttons", int(mouseEvent->buttons()));
+        e.insert("modifiers", int(mouseEvent->modifiers()));
+    }
+
+    events.append(e);
+    return false;
+}
+
+bool InteractionRecorder::save(const QString &fileName) const{
+
+    QJsonObject rect;
+    rect.insert("x", sceneRect.x());
+    rect.insert("y", sceneRect.y());
+    rect.insert("width", sceneRect.width());
+    rect.insert("height", sceneRect.height());
+
+    QJsonObject root;
+    root.insert("version", INTERACTION_LOG_VERSION);
+    root.insert("sceneRect", rect);
+    root.insert("annotations", QJsonDocument::fromJson(AnnotationFile::serialize(shapes)).object());
+    root.insert("events", events);
+
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+InteractionReplay::InteractionReplay()
+{
+}
+
+bool InteractionReplay::load(const QString &fileName){
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if(root.value("version").toInt() != INTERACTION_LOG_VERSION)
+        return false;
+
+    QJsonObject rect = root.value("sceneRect").toObject();
+    sceneRect = QRectF(rect.value("x").toDouble(), rect.value("y").toDouble(),
+                       rect.value("width").toDouble(), rect.value("height").toDouble());
+    shapes = AnnotationFile::parse(QJsonDocument(root.value("annotations").toObject()).toJson(QJsonDocument::Compact));
+    events = root.value("events").toArray();
+    return true;
+}
+
+void InteractionReplay::setShapes(const QVector<AnnotationShape> &theShapes){
+    shapes = theShapes;
+}
+
+QJsonObject InteractionReplay::percentiles(QVector<qint64> times){
+
+    QJsonObject result;
+    result.insert("count", times.size());
+    if(times.isEmpty())
+        return result;
+
+    std::sort(times.begin(), times.end());
+    auto rank = [&times](double p) {
+        int i = int(p * times.size() + 0.999999) - 1; //nearest rank
+        return double(times[qBound(0, i, times.size() - 1)]);
+    };
+
+    qint64 total = 0;
+    for(qint64 t : times)
+        total += t;
+
+    result.insert("p50_ns", rank(0.50));
+    result.insert("p99_ns", rank(0.99));
+    result.insert("max_ns", double(times.last()));
+    result.insert("total_ns", double(total));
+    return result;
+}
+
+QJsonObject InteractionReplay::run(int repeat){
+
+    TRACE_SCOPE("replay interactions", "replay");
+
+    QMap<QString, QVector<qint64> > handlerTimes;
+    QVector<qint64> allTimes;
+    QVector<qint64> repaintTimes;
+
+    QRectF rect = sceneRect.isEmpty() ? QRectF(0, 0, 1000, 800) : sceneRect;
+
+    for(int r = 0; r < qMax(repeat, 1); r++){
+
+        //A view is shown (offscreen when run with -platform offscreen) so the scene changes are really painted
+        Scene scene;
+        QPixmap background(rect.size().toSize());
+        background.fill(Qt::gray);
+        scene.addPixmap(background)->setPos(rect.topLeft());
+        scene.addShapes(shapes);
+
+        QGraphicsView view(&scene);
+        view.resize(rect.size().toSize() + QSize(4, 4));
+        view.show();
+        QCoreApplication::processEvents();
+
+        for(const QJsonValue &value : events){
+            QJsonObject e = value.toObject();
+            QString type = e.value("type").toString();
+
+            Scene::Mode mode = Scene::Mode(e.value("mode").toInt());
+            if(scene.mode() != mode)
+                scene.setMode(mode);
+
+            QElapsedTimer timer;
+            qint64 handler;
+
+            if(type == "keypress" || type == "keyrelease"){
+                QKeyEvent keyEvent(type == "keypress" ? QEvent::KeyPress : QEvent::KeyRelease, e.value("key").toInt(),
+                                   Qt::KeyboardModifiers(e.value("modifiers").toInt()), e.value("text").toString(),
+                                   e.value("autoRepeat").toBool());
+                timer.start();
+                QCoreApplication::sendEvent(&scene, &keyEvent);
+                handler = timer.nsecsElapsed();
+            }else{
+                QEvent::Type eventType = type == "press" ? QEvent::GraphicsSceneMousePress
+                                       : type == "release" ? QEvent::GraphicsSceneMouseRelease
+                                       : QEvent::GraphicsSceneMouseMove;
+                QPointF pos(e.value("x").toDouble(), e.value("y").toDouble());
+                QPointF lastPos(e.value("lastX").toDouble(), e.value("lastY").toDouble());
+                QPointF downPos(e.value("downX").toDouble(), e.value("downY").toDouble());
+
+                QGraphicsSceneMouseEvent mouseEvent(eventType);
+                mouseEvent.setWidget(view.viewport());
+                mouseEvent.setScenePos(pos);
+                mouseEvent.setScreenPos(view.mapToGlobal(view.mapFromScene(pos)));
+                mouseEvent.setLastScenePos(lastPos);
+                mouseEvent.setLastScreenPos(view.mapToGlobal(view.mapFromScene(lastPos)));
+                mouseEvent.setButtonDownScenePos(Qt::LeftButton, downPos);
+                mouseEvent.setButtonDownScreenPos(Qt::LeftButton, view.mapToGlobal(view.mapFromScene(downPos)));
+                mouseEvent.setButton(Qt::MouseButton(e.value("button").toInt()));
+                mouseEvent.setButtons(Qt::MouseButtons(e.value("buttons").toInt()));
+                mouseEvent.setModifiers(Qt::KeyboardModifiers(e.value("modifiers").toInt()));
+
+                timer.start();
+                QCoreApplication::sendEvent(&scene, &mouseEvent);
+                handler = timer.nsecsElapsed();
+            }
+
+            handlerTimes[type].append(handler);
+            allTimes.append(handler);
+
+            //the scene schedules its repaint, run it now to measure it
+            timer.start();
+            QCoreApplication::processEvents();
+            repaintTimes.append(timer.nsecsElapsed());
+        }
+    }
+
+    QJsonObject handlers;
+    for(QMap<QString, QVector<qint64> >::const_iterator it = handlerTimes.constBegin(); it != handlerTimes.constEnd(); ++it)
+        handlers.insert(it.key(), percentiles(it.value()));
+
+    QJsonObject report;
+    report.insert("events", events.size());
+    report.insert("shapes", shapes.size());
+    report.insert("repeat", qMax(repeat, 1));
+    report.insert("qtVersion", QString(qVersion()));
+    report.insert("platform", QGuiApplication::platformName());
+    report.insert("handlers", handlers);
+    report.insert("all", percentiles(allTimes));
+    report.insert("repaint", percentiles(repaintTimes));
+    return report;
+}
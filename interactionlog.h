@@ -0,0 +1,136 @@
+#ifndef INTERACTIONLOG_H
+#define INTERACTIONLOG_H
+
+#include "scene.h"
+#include "annotationfile.h"
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonObject>
+
+/*!
+ * \brief INTERACTION_LOG_VERSION is written to the recordings, recordings of another version are refused
+ */
+#define INTERACTION_LOG_VERSION 1
+
+/*!
+ * \brief The InteractionRecorder class records the mouse and key events received by a scene, together with the shapes on the scene when recording started, so the session can be replayed later
+ */
+class InteractionRecorder : public QObject
+{
+public:
+    /*!
+     * \brief InteractionRecorder constructor
+     * \param theScene is the scene whose events are recorded
+     * \param parent is the parent object
+     */
+    InteractionRecorder(Scene *theScene, QObject *parent = nullptr);
+    /*!
+     * \brief start method drops any previous recording and starts recording
+     */
+    void start();
+    /*!
+     * \brief stop method stops recording, the recording is kept until the next start
+     */
+    void stop();
+    /*!
+     * \brief isRecording method determines whether events are being recorded
+     * \return returns true while recording
+     */
+    bool isRecording() const;
+    /*!
+     * \brief eventCount method gets the number of recorded events
+     * \return returns the number of events
+     */
+    int eventCount() const;
+    /*!
+     * \brief save method writes the recording to a json file
+     * \param fileName is the output file
+     * \return returns true if the file was written
+     */
+    bool save(const QString &fileName) const;
+
+protected:
+    /*!
+     * \brief eventFilter method records the scene mouse and key events, the events are passed on unchanged
+     */
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    /*!
+     * \brief scene is the recorded scene
+     */
+    Scene *scene;
+    /*!
+     * \brief shapes are the shapes on the scene when recording started
+     */
+    QVector<AnnotationShape> shapes;
+    /*!
+     * \brief sceneRect is the scene rectangle when recording started
+     */
+    QRectF sceneRect;
+    /*!
+     * \brief events are the recorded events
+     */
+    QJsonArray events;
+    /*!
+     * \brief clock measures the time since recording started
+     */
+    QElapsedTimer clock;
+    /*!
+     * \brief recording is true while recording
+     */
+    bool recording;
+};
+
+/*!
+ * \brief The InteractionReplay class replays a recording against a new scene (shown in a view so repaints happen) and measures the time the scene takes to handle each event and to repaint
+ */
+class InteractionReplay
+{
+public:
+    /*!
+     * \brief InteractionReplay constructor creates an empty replay
+     */
+    InteractionReplay();
+    /*!
+     * \brief load method reads a recording
+     * \param fileName is the recording file
+     * \return returns true if the file is a recording of this version
+     */
+    bool load(const QString &fileName);
+    /*!
+     * \brief setShapes method replaces the shapes stored in the recording, e.g. with those of an annotation file
+     * \param theShapes are the shapes loaded on the scene before replaying
+     */
+    void setShapes(const QVector<AnnotationShape> &theShapes);
+    /*!
+     * \brief run method replays the recording as fast as possible
+     * \param repeat is the number of times the recording is replayed, each time on a freshly loaded scene
+     * \return returns the report: p50, p99 and max handler time per event type and the total repaint time
+     */
+    QJsonObject run(int repeat);
+
+private:
+    /*!
+     * \brief percentiles method summarises a list of times in nanoseconds
+     */
+    static QJsonObject percentiles(QVector<qint64> times);
+
+private:
+    /*!
+     * \brief shapes are the shapes loaded before replaying
+     */
+    QVector<AnnotationShape> shapes;
+    /*!
+     * \brief sceneRect is the recorded scene rectangle
+     */
+    QRectF sceneRect;
+    /*!
+     * \brief events are the recorded events
+     */
+    QJsonArray events;
+};
+
+#endif // INTERACTIONLOG_H
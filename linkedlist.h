@@ -2,11 +2,13 @@
 #define LINKEDLIST_H
 
 #include "node.h"
+#include "nodepool.h"
+#include "memorystats.h"
 
 #include <QString>
-#include <QDate>
+#include <QDateTime>
 #include <QDebug>
-#include <QTreeWidgetItem>
+#include <QVector>
 #include <QListWidgetItem>
 
 
@@ -35,12 +37,10 @@ public:
      */
     void deleteNode(QString className);
     /*!
-     * \brief getImageItem method gets the image item from the linkedlist
-     * \param index is index of the image where it is stored
-     * \param imgItem is the images tree widget, which is passed to QTreeWidgetItem as type
-     * \return returns pointer to the tree widget item that going to be added to the image tree widget
+     * \brief getItems method gets a copy of all the items in the linkedlist in their current order
+     * \return returns the items
      */
-    QTreeWidgetItem *getImageItem(int index, QTreeWidget *imgItem);
+    QVector<T> getItems();
     /*!
      * \brief getClassItem method gets the class item from the linkedlist
      * \param index is index of the class where it is stored
@@ -50,7 +50,7 @@ public:
     QListWidgetItem *getClassItem(int index, QListWidget *clsItem);
     /*!
      * \brief nodeItemAlreadyExist determines whether the node to be added already exit in the linkedlist
-     * \param gName is the name of a class or an image
+     * \param gName is the key of a class or an image (see getKey)
      * \return return true if node item already exist and false if it doesn't
      */
     bool nodeItemAlreadyExist(QString gName);
@@ -81,6 +81,11 @@ public:
      * \return returns the size of the linkedlist
      */
     int getSize();
+    /*!
+     * \brief memoryUsed method estimates the memory taken by the linkedlist (the node blocks and the strings the items hold)
+     * \return returns the number of bytes
+     */
+    qint64 memoryUsed();
 
 private:
     /*!
@@ -91,6 +96,10 @@ private:
      * \brief tail is the end node of the linkedlist
      */
     node<T> *tail;
+    /*!
+     * \brief pool allocates the nodes
+     */
+    NodePool<T> pool;
 };
 
 
@@ -102,28 +111,19 @@ LinkedList<T>::LinkedList(){
 
 template <typename T>
 LinkedList<T>::~LinkedList(){
-
-        while (head != nullptr)
-        {
-            node<T> *tmpNode = head->next;
-            delete head;
-            head = tmpNode;
-        }
-
+        //the pool frees the nodes
+        head = nullptr;
+        tail = nullptr;
 }
 
 template <typename T>
 bool LinkedList<T>::nodeItemAlreadyExist(QString gName){
 
-    node<T> *temp=new node<T>;
-    temp=head;
-
-    while(temp!=nullptr)
+    for(node<T> *temp = head; temp != nullptr; temp = temp->next)
     {
-        if(gName == temp->data.getName()){
+        if(gName == temp->data.getKey()){
             return true;
         }
-        temp=temp->next;
     }
     return false;
 }
@@ -131,9 +131,7 @@ bool LinkedList<T>::nodeItemAlreadyExist(QString gName){
 template <typename T>
 void LinkedList<T>::createnode(T value){
 
-        node<T> *temp = new node<T>;
-        temp->data=value;
-        temp->next=nullptr;
+        node<T> *temp = pool.allocate(value);
 
         if(head==nullptr)
         {
@@ -151,39 +149,32 @@ void LinkedList<T>::createnode(T value){
 template <typename T>
 void LinkedList<T>::deleteNode(QString className){
 
-    node<T> *current=new node<T>;
-    node<T> *previous=new node<T>;
-    current=head;
-    for(int i=0;i<getSize();i++)
+    node<T> *previous = nullptr;
+    for(node<T> *current = head; current != nullptr; current = current->next)
     {
-        if(className == head->data.getName()){
-            node<T> *temp=new node<T>;
-            temp=head;
-            head=head->next;
-            delete temp;
-            break;
-        }else if(className == current->data.getName()){
-            previous->next=current->next;
-            delete current;
+        if(className == current->data.getName()){
+            if(previous == nullptr)
+                head = current->next;
+            else
+                previous->next = current->next;
+            if(tail == current)
+                tail = previous;
+            pool.release(current);
             break;
         }
-        previous=current;
-        current=current->next;
+        previous = current;
     }
 }
 
 template <typename T>
 QString LinkedList<T>::returnImgPath(QString imgName){
     QString imgPath;
-    node<T> *temp=new node<T>;
-    temp=head;
-    while(temp!=nullptr)
+    for(node<T> *temp = head; temp != nullptr; temp = temp->next)
     {
         if(imgName == temp->data.getName()){
             imgPath = temp->data.getPath();
             break;
         }
-        temp=temp->next;
     }
     return imgPath;
 }
@@ -229,7 +220,7 @@ void LinkedList<T>::sortByDateAscending(){
 
     for(i=head; i != nullptr; i = i->next){
         for(j=i->next; j != nullptr; j = j->next){
-            if(i->data.getDate().daysTo(QDate::currentDate()) > j->data.getDate().daysTo(QDate::currentDate())){
+            if(i->data.getDate() < j->data.getDate()){
                 std::swap(i->data,j->data);
             }
         }
@@ -243,7 +234,7 @@ void LinkedList<T>::sortByDateDescending(){
 
     for(i=head; i != nullptr; i = i->next){
         for(j=i->next; j != nullptr; j = j->next){
-            if(i->data.getDate().daysTo(QDate::currentDate()) < j->data.getDate().daysTo(QDate::currentDate())){
+            if(i->data.getDate() > j->data.getDate()){
                 std::swap(i->data,j->data);
             }
         }
@@ -253,51 +244,43 @@ void LinkedList<T>::sortByDateDescending(){
 template <typename T>
 int LinkedList<T>::getSize(){
 
-    int count = 0;
-    node<T> *temp=new node<T>;
-    temp=head;
-    while(temp!=nullptr)
-    {
-        count++;
-        temp = temp->next;
-    }
-    return count;
+    return pool.count(); //every node in use is in the linkedlist
 }
 
 template <typename T>
-QTreeWidgetItem *LinkedList<T>::getImageItem(int index, QTreeWidget *imgItem){
+qint64 LinkedList<T>::memoryUsed(){
 
-    QTreeWidgetItem *img;
+    qint64 bytes = pool.bytesReserved();
+    for(node<T> *temp = head; temp != nullptr; temp = temp->next)
+    {
+        bytes += MemoryStats::itemBytes(temp->data) - qint64(sizeof(T)); //the item itself is part of its node
+    }
+    return bytes;
+}
 
-    node<T> *temp=new node<T>;
-    temp=head;
-    img = new QTreeWidgetItem(imgItem);
+template <typename T>
+QVector<T> LinkedList<T>::getItems(){
 
-    for(int i = 0; i < index; i++)
+    QVector<T> items;
+    for(node<T> *temp = head; temp != nullptr; temp = temp->next)
     {
-        img->setText(0,temp->data.getName());
-        img->setText(1,temp->data.getDate().toString());
-
-        temp = temp->next;
+        items.append(temp->data);
     }
-
-  return img;
+    return items;
 }
 
 template <typename T>
 QListWidgetItem *LinkedList<T>::getClassItem(int index, QListWidget *clsItem){
 
-    QListWidgetItem *classItem;
-    node<T> *temp=new node<T>;
-    temp=head;
-    classItem = new QListWidgetItem(clsItem);
+    QListWidgetItem *classItem = new QListWidgetItem(clsItem);
 
-    for(int i = 0; i < index; i++)
+    node<T> *temp = head;
+    for(int i = 1; i < index && temp != nullptr; i++)
     {
-        classItem->setText(temp->data.getName());
-
         temp = temp->next;
     }
+    if(temp != nullptr)
+        classItem->setText(temp->data.getName());
 
     return classItem;
 }
@@ -0,0 +1,172 @@
+#include "livewire.h"
+#include "polygonsimplifier.h"
+#include "trace.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+namespace {
+
+//The eight steps, the diagonal ones cost 3 halves of a straight one (close to sqrt(2))
+const int stepX[8] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+const int stepY[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+const int stepWeight[8] = { 2, 2, 2, 2, 3, 3, 3, 3 };
+
+}
+
+LiveWire::LiveWire()
+    : width(0), height(0), queued(0), current(0), generation(0), anchor(-1), settledPixels(0)
+{
+    buckets.resize(LIVEWIRE_BUCKETS);
+}
+
+void LiveWire::setGradient(const GradientMap &theGradient){
+
+    gradient = theGradient;
+    width = gradient.size().width();
+    height = gradient.size().height();
+    anchor = -1;
+    settledPixels = 0;
+    for(QVector<int> &bucket : buckets)
+        bucket.clear();
+    queued = 0;
+    cost.clear(); //built when the first anchor is set, most images are not traced
+}
+
+void LiveWire::buildCosts(){
+
+    TRACE_SCOPE("live wire costs", "tools");
+    quint8 table[256];
+    for(int m = 0; m < 256; m++)
+        table[m] = quint8(1 + (255 - m) * (LIVEWIRE_COST_RANGE - 1) / 255);
+
+    int pixels = width * height;
+    cost.resize(pixels);
+    distance.resize(pixels);
+    parent.resize(pixels);
+    reached.fill(0, pixels);
+    settled.fill(0, pixels);
+    generation = 0;
+
+    for(int y = 0; y < height; y++){
+        quint8 *row = cost.data() + y * width;
+        for(int x = 0; x < width; x++)
+            row[x] = table[gradient.magnitude(x, y)];
+    }
+}
+
+bool LiveWire::isValid() const{
+    return !gradient.isNull();
+}
+
+int LiveWire::settledCount() const{
+    return settledPixels;
+}
+
+int LiveWire::pixel(const QPointF &point) const{
+    int x = qBound(0, qFloor(point.x()), width - 1);
+    int y = qBound(0, qFloor(point.y()), height - 1);
+    return y * width + x;
+}
+
+QPointF LiveWire::center(int index) const{
+    return QPointF(index % width + 0.5, index / width + 0.5);
+}
+
+QPointF LiveWire::setAnchor(const QPointF &point){
+
+    if(!isValid())
+        return point;
+    if(cost.isEmpty())
+        buildCosts();
+
+    for(QVector<int> &bucket : buckets)
+        bucket.clear();
+    generation++;
+    anchor = pixel(point);
+    current = 0;
+    settledPixels = 0;
+
+    distance[anchor] = 0;
+    parent[anchor] = 0;
+    reached[anchor] = generation;
+    buckets[0].append(anchor);
+    queued = 1;
+    return center(anchor);
+}
+
+void LiveWire::expand(int target, int budget){
+
+    int anchorX = anchor % width;
+    int anchorY = anchor / width;
+
+    while(queued > 0 && budget > 0 && settled[target] != generation){
+        QVector<int> &bucket = buckets[current & (LIVEWIRE_BUCKETS - 1)];
+        if(bucket.isEmpty()){
+            current++;
+            continue;
+        }
+
+        int node = bucket.takeLast();
+        queued--;
+        if(settled[node] == generation || distance[node] != current)
+            continue; //settled already, queued again with a lower distance
+
+        settled[node] = generation;
+        settledPixels++;
+        budget--;
+
+        int x = node % width;
+        int y = node / width;
+        for(int d = 0; d < 8; d++){
+            int nx = x + stepX[d];
+            int ny = y + stepY[d];
+            if(nx < 0 || ny < 0 || nx >= width || ny >= height)
+                continue;
+            if(qAbs(nx - anchorX) > LIVEWIRE_RADIUS || qAbs(ny - anchorY) > LIVEWIRE_RADIUS)
+                continue;
+
+            int next = ny * width + nx;
+            if(settled[next] == generation)
+                continue;
+
+            //at least 2 more than current, so never the bucket being emptied
+            int nextDistance = current + cost[next] * stepWeight[d];
+            if(reached[next] != generation || nextDistance < distance[next]){
+                reached[next] = generation;
+                distance[next] = nextDistance;
+                parent[next] = quint8(d);
+                buckets[nextDistance & (LIVEWIRE_BUCKETS - 1)].append(next);
+                queued++;
+            }
+        }
+    }
+}
+
+QPolygonF LiveWire::pathTo(const QPointF &point, double epsilon){
+
+    QPolygonF path;
+    if(!isValid() || anchor < 0)
+        return path;
+
+    TRACE_SCOPE("live wire", "tools");
+    int target = pixel(point);
+    expand(target, LIVEWIRE_EXPANSIONS);
+
+    if(settled[target] != generation){
+        //out of reach or not searched yet, the next mouse event continues the search
+        path.append(center(anchor));
+        path.append(center(target));
+        return path;
+    }
+
+    for(int node = target; node != anchor; ){
+        path.append(center(node));
+        int d = parent[node];
+        node = (node / width - stepY[d]) * width + (node % width - stepX[d]);
+    }
+    path.append(center(anchor));
+    std::reverse(path.begin(), path.end());
+    return PolygonSimplifier::simplifyLine(path, epsilon);
+}
@@ -0,0 +1,152 @@
+#ifndef LIVEWIRE_H
+#define LIVEWIRE_H
+
+#include "gradientmap.h"
+
+#include <QPointF>
+#include <QPolygonF>
+#include <QVector>
+
+/*!
+ * \brief LIVEWIRE_RADIUS is the largest distance in pixels (along x or y) the path reaches from the anchor, farther points get a straight line
+ */
+#define LIVEWIRE_RADIUS 400
+/*!
+ * \brief LIVEWIRE_EXPANSIONS is the largest number of pixels settled for one mouse event, the search continues on the next event
+ */
+#define LIVEWIRE_EXPANSIONS 40000
+/*!
+ * \brief LIVEWIRE_COST_RANGE is the cost of crossing a pixel without any edge, a pixel on the strongest edge costs 1
+ */
+#define LIVEWIRE_COST_RANGE 31
+/*!
+ * \brief LIVEWIRE_BUCKETS is the number of buckets of the queue, a power of two larger than the cost of the most expensive step
+ */
+#define LIVEWIRE_BUCKETS 128
+/*!
+ * \brief LIVEWIRE_SIMPLIFY_EPSILON is the largest distance in pixels between the pixel path and the simplified one
+ */
+#define LIVEWIRE_SIMPLIFY_EPSILON 0.75
+
+/*!
+ * \brief The LiveWire class finds the path along the image edges between an anchor and the mouse (intelligent scissors)
+ *
+ * The path is the cheapest 8-connected path over a cost map made from the gradient map, pixels on strong edges are cheap.
+ * Dijkstra's search runs from the anchor with a bucket queue (the step costs are small integers) and is kept between mouse
+ * events: a point already settled is answered by following the parents, otherwise the search resumes until it settles the
+ * point or spends LIVEWIRE_EXPANSIONS pixels. Setting a new anchor restarts it without clearing the buffers (generation stamps).
+ */
+class LiveWire
+{
+public:
+    /*!
+     * \brief LiveWire constructor creates a live wire without an image
+     */
+    LiveWire();
+    /*!
+     * \brief setGradient method sets the gradient map of the displayed image, the anchor is dropped
+     * \param gradient is the map, a null map disables the live wire
+     */
+    void setGradient(const GradientMap &gradient);
+    /*!
+     * \brief isValid method determines whether there is an image to trace on
+     * \return returns true if there is
+     */
+    bool isValid() const;
+    /*!
+     * \brief setAnchor method starts the paths from a new point
+     * \param anchor is the point in scene coordinates, it is moved inside the image
+     * \return returns the center of the anchor pixel, where the paths start
+     */
+    QPointF setAnchor(const QPointF &anchor);
+    /*!
+     * \brief pathTo method gets the path from the anchor to a point
+     * \param target is the point in scene coordinates, it is moved inside the image
+     * \param epsilon is the simplification distance in pixels
+     * \return returns the path through the pixel centers from the anchor to the target, a straight line while the search hasn't reached the target yet
+     */
+    QPolygonF pathTo(const QPointF &target, double epsilon = LIVEWIRE_SIMPLIFY_EPSILON);
+    /*!
+     * \brief settledCount method gets the number of pixels the search from the current anchor has settled
+     * \return returns the number of pixels
+     */
+    int settledCount() const;
+
+private:
+    /*!
+     * \brief buildCosts method makes the cost map from the gradient map and sizes the search buffers
+     */
+    void buildCosts();
+    /*!
+     * \brief expand method continues the search until the target pixel is settled, the queue is empty or the budget is spent
+     */
+    void expand(int target, int budget);
+    /*!
+     * \brief pixel method gets the index of the image pixel nearest to a point
+     */
+    int pixel(const QPointF &point) const;
+    /*!
+     * \brief center method gets the center of a pixel in scene coordinates
+     */
+    QPointF center(int index) const;
+
+private:
+    /*!
+     * \brief width is the image width
+     */
+    int width;
+    /*!
+     * \brief height is the image height
+     */
+    int height;
+    /*!
+     * \brief gradient is the gradient map of the displayed image
+     */
+    GradientMap gradient;
+    /*!
+     * \brief cost is the cost of stepping onto each pixel, 1 on the strongest edges
+     */
+    QVector<quint8> cost;
+    /*!
+     * \brief distance is the cost of the cheapest path found so far from the anchor to each pixel
+     */
+    QVector<int> distance;
+    /*!
+     * \brief parent is the direction of the last step of that path
+     */
+    QVector<quint8> parent;
+    /*!
+     * \brief reached is the generation in which a pixel got a distance, older values are stale
+     */
+    QVector<quint32> reached;
+    /*!
+     * \brief settled is the generation in which a pixel got its final distance
+     */
+    QVector<quint32> settled;
+    /*!
+     * \brief buckets are the queued pixels by distance modulo LIVEWIRE_BUCKETS
+     */
+    QVector<QVector<int> > buckets;
+    /*!
+     * \brief queued is the number of pixels in the buckets, including the stale ones
+     */
+    int queued;
+    /*!
+     * \brief current is the distance being settled
+     */
+    int current;
+    /*!
+     * \brief generation is incremented for each anchor
+     */
+    quint32 generation;
+    /*!
+     * \brief anchor is the index of the anchor pixel, -1 without anchor
+     */
+    int anchor;
+    /*!
+     * \brief settledPixels is the number of pixels settled from the anchor
+     */
+    int settledPixels;
+};
+
+#endif // LIVEWIRE_H
@@ -0,0 +1,194 @@
+#include "magicwand.h"
+#include "polygonsimplifier.h"
+#include "trace.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WAND_USE_SSE2
+#endif
+
+MagicWand::MagicWand() : selected(0)
+{
+}
+
+void MagicWand::setImage(const QImage &theImage){
+
+    image = theImage.isNull() ? QImage() : theImage.convertToFormat(QImage::Format_RGB32);
+    int pixels = image.width() * image.height();
+    match.resize(pixels);
+    region.resize(pixels);
+    rowDone.resize(image.height());
+    selected = 0;
+}
+
+bool MagicWand::isValid() const{
+    return !image.isNull();
+}
+
+int MagicWand::regionSize() const{
+    return selected;
+}
+
+void MagicWand::matchRow(const quint32 *row, int width, quint32 seed, int tolerance, quint8 *out){
+
+    int x = 0;
+    seed |= 0xff000000; //the alpha byte always matches
+
+#ifdef WAND_USE_SSE2
+    //Four pixels at a time: per byte |pixel - seed| <= tolerance, a pixel matches when its four bytes do
+    const __m128i seeds = _mm_set1_epi32(int(seed));
+    const __m128i alpha = _mm_set1_epi32(int(0xff000000));
+    const __m128i limit = _mm_set1_epi8(char(tolerance));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi32(-1);
+
+    for(; x + 4 <= width; x += 4){
+        __m128i pixels = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x)), alpha);
+        __m128i diff = _mm_or_si128(_mm_subs_epu8(pixels, seeds), _mm_subs_epu8(seeds, pixels));
+        __m128i within = _mm_cmpeq_epi8(_mm_subs_epu8(diff, limit), zero);
+        int bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(within, ones)));
+        out[x] = bits & 1;
+        out[x + 1] = (bits >> 1) & 1;
+        out[x + 2] = (bits >> 2) & 1;
+        out[x + 3] = (bits >> 3) & 1;
+    }
+#endif
+
+    for(; x < width; x++){
+        quint32 p = row[x];
+        int dr = qAbs(int((p >> 16) & 0xff) - int((seed >> 16) & 0xff));
+        int dg = qAbs(int((p >> 8) & 0xff) - int((seed >> 8) & 0xff));
+        int db = qAbs(int(p & 0xff) - int(seed & 0xff));
+        out[x] = (dr <= tolerance && dg <= tolerance && db <= tolerance) ? 1 : 0;
+    }
+}
+
+void MagicWand::fill(const QPoint &seed, int tolerance){
+
+    int w = image.width();
+    int h = image.height();
+    quint32 seedColor = reinterpret_cast<const quint32*>(image.constScanLine(seed.y()))[seed.x()];
+
+    std::memset(region.data(), 0, region.size());
+    rowDone.fill(false);
+    selected = 0;
+
+    auto matches = [&](int y) -> const quint8* {
+        quint8 *row = match.data() + qint64(y) * w;
+        if(!rowDone[y]){
+            matchRow(reinterpret_cast<const quint32*>(image.constScanLine(y)), w, seedColor, tolerance, row);
+            rowDone[y] = true;
+        }
+        return row;
+    };
+
+    //Span fill: each popped seed is widened to the whole run of matching pixels on its row,
+    //then one seed is pushed per run of matching pixels just above and below
+    QVector<QPoint> stack;
+    stack.append(seed);
+
+    while(!stack.isEmpty()){
+        QPoint p = stack.takeLast();
+        quint8 *filled = region.data() + qint64(p.y()) * w;
+        const quint8 *ok = matches(p.y());
+        if(filled[p.x()] || !ok[p.x()])
+            continue;
+
+        int left = p.x();
+        while(left > 0 && ok[left - 1] && !filled[left - 1])
+            left--;
+        int right = p.x();
+        while(right < w - 1 && ok[right + 1] && !filled[right + 1])
+            right++;
+
+        std::memset(filled + left, 1, right - left + 1);
+        selected += right - left + 1;
+
+        for(int ny : {p.y() - 1, p.y() + 1}){
+            if(ny < 0 || ny >= h)
+                continue;
+            const quint8 *nextOk = matches(ny);
+            const quint8 *nextFilled = region.constData() + qint64(ny) * w;
+            bool inRun = false;
+            for(int x = left; x <= right; x++){
+                bool open = nextOk[x] && !nextFilled[x];
+                if(open && !inRun)
+                    stack.append(QPoint(x, ny));
+                inRun = open;
+            }
+        }
+    }
+}
+
+bool MagicWand::inRegion(int x, int y) const{
+    if(x < 0 || y < 0 || x >= image.width() || y >= image.height())
+        return false;
+    return region[qint64(y) * image.width() + x] != 0;
+}
+
+QPolygonF MagicWand::trace() const{
+
+    int w = image.width();
+    int start = -1;
+    for(int i = 0; i < region.size(); i++){
+        if(region[i]){
+            start = i;
+            break;
+        }
+    }
+    if(start < 0)
+        return QPolygonF();
+
+    //Walk the pixel corners keeping the region on the same side. The state of a corner is made
+    //of the four pixels around it: 1 up-left, 2 up-right, 4 down-left, 8 down-right
+    enum Direction { None, Up, Down, Left, Right };
+    int startX = start % w;
+    int startY = start / w;
+    int x = startX;
+    int y = startY;
+    Direction previous = None;
+    QPolygonF outline;
+
+    do{
+        int state = (inRegion(x - 1, y - 1) ? 1 : 0) | (inRegion(x, y - 1) ? 2 : 0)
+                  | (inRegion(x - 1, y) ? 4 : 0) | (inRegion(x, y) ? 8 : 0);
+
+        Direction next = None;
+        switch(state){
+        case 1: case 5: case 13: next = Up; break;
+        case 2: case 3: case 7: next = Right; break;
+        case 4: case 12: case 14: next = Left; break;
+        case 8: case 10: case 11: next = Down; break;
+        case 6: next = previous == Up ? Left : Right; break;    //diagonal pixels are not connected
+        case 9: next = previous == Right ? Up : Down; break;
+        default: return outline; //not on the boundary, can't happen for a non empty region
+        }
+
+        if(next != previous)
+            outline.append(QPointF(x, y));
+        previous = next;
+
+        switch(next){
+        case Up: y--; break;
+        case Down: y++; break;
+        case Left: x--; break;
+        case Right: x++; break;
+        default: break;
+        }
+    }while(x != startX || y != startY);
+
+    return outline;
+}
+
+QPolygonF MagicWand::select(const QPoint &seed, int tolerance, double epsilon){
+
+    if(image.isNull() || !image.rect().contains(seed))
+        return QPolygonF();
+
+    TRACE_SCOPE("magic wand", "tools");
+    fill(seed, qBound(0, tolerance, 255));
+    QPolygonF outline = trace();
+    return PolygonSimplifier::douglasPeucker(PolygonSimplifier::removeCollinear(outline), epsilon);
+}
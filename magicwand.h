@@ -0,0 +1,98 @@
+#ifndef MAGICWAND_H
+#define MAGICWAND_H
+
+#include <QImage>
+#include <QPoint>
+#include <QPolygonF>
+#include <QVector>
+
+/*!
+ * \brief WAND_TOLERANCE is the default largest difference of a color channel between the clicked pixel and the selected ones
+ */
+#define WAND_TOLERANCE 24
+/*!
+ * \brief WAND_SIMPLIFY_EPSILON is the largest distance in pixels between the traced outline and the simplified polygon
+ */
+#define WAND_SIMPLIFY_EPSILON 1.0
+
+/*!
+ * \brief The MagicWand class selects the region of similar color around a pixel and outlines it with a polygon
+ *
+ * The region is grown with a scanline fill over the pixels whose channels are all within the tolerance of the clicked pixel
+ * (4-connected, the rows are compared to the clicked color four pixels at a time). Its outer boundary is traced along the pixel
+ * edges (marching squares) and simplified, holes are not kept. The buffers are reused so the selection can be recomputed while
+ * the tolerance changes.
+ */
+class MagicWand
+{
+public:
+    /*!
+     * \brief MagicWand constructor creates a wand without an image
+     */
+    MagicWand();
+    /*!
+     * \brief setImage method sets the image the regions are selected on, its pixels are scene coordinates
+     * \param image is the image, a null image disables the wand
+     */
+    void setImage(const QImage &image);
+    /*!
+     * \brief isValid method determines whether there is an image to select on
+     * \return returns true if there is
+     */
+    bool isValid() const;
+    /*!
+     * \brief select method outlines the region around a pixel
+     * \param seed is the clicked pixel
+     * \param tolerance is the largest difference of a color channel (0 to 255)
+     * \param epsilon is the simplification distance in pixels
+     * \return returns the outline in pixel coordinates, empty if the seed is outside the image
+     */
+    QPolygonF select(const QPoint &seed, int tolerance, double epsilon = WAND_SIMPLIFY_EPSILON);
+    /*!
+     * \brief regionSize method gets the number of pixels selected by the last call to select
+     * \return returns the number of pixels
+     */
+    int regionSize() const;
+
+private:
+    /*!
+     * \brief matchRow method compares a row to the seed color, out is set to 1 for the pixels within the tolerance
+     */
+    static void matchRow(const quint32 *row, int width, quint32 seed, int tolerance, quint8 *out);
+    /*!
+     * \brief fill method grows the region from the seed into region
+     */
+    void fill(const QPoint &seed, int tolerance);
+    /*!
+     * \brief trace method follows the outer boundary of the region, one vertex per change of direction
+     */
+    QPolygonF trace() const;
+    /*!
+     * \brief inRegion method determines whether a pixel is selected, pixels outside the image are not
+     */
+    bool inRegion(int x, int y) const;
+
+private:
+    /*!
+     * \brief image is the image converted to 32 bit pixels
+     */
+    QImage image;
+    /*!
+     * \brief match is 1 for the pixels within the tolerance, computed for the rows the fill reaches
+     */
+    QVector<quint8> match;
+    /*!
+     * \brief rowDone is true for the rows of match computed for the current selection
+     */
+    QVector<bool> rowDone;
+    /*!
+     * \brief region is 1 for the selected pixels
+     */
+    QVector<quint8> region;
+    /*!
+     * \brief selected is the number of selected pixels
+     */
+    int selected;
+};
+
+#endif // MAGICWAND_H
@@ -1,11 +1,444 @@
 #include "mainwindow.h"
+#include "benchmark.h"
+#include "syntheticdata.h"
+#include "trace.h"
+#include "interactionlog.h"
+#include "maskrasterizer.h"
+#include "annotationindex.h"
+#include "annotationsimplifier.h"
+#include "overlapchecker.h"
+#include "agreementengine.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+/*!
+ * \brief writeReport writes a json report to a file, or to the standard output when no file is given
+ */
+static int writeReport(const QJsonObject &report, const QString &fileName){
+
+    QByteArray json = QJsonDocument(report).toJson();
+
+    if(fileName.isEmpty()){
+        QTextStream(stdout) << json;
+        return 0;
+    }
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        QTextStream(stderr) << "Cannot write " << file.fileName() << "\n";
+        return 1;
+    }
+    file.write(json);
+    return 0;
+}
+
+/*!
+ * \brief runBenchmark runs the benchmark suite and writes the json report
+ */
+static int runBenchmark(const QCommandLineParser &parser){
+
+    QList<int> sizes;
+    for(const QString &size : parser.value("benchmark-sizes").split(',', Qt::SkipEmptyParts)){
+        if(size.toInt() > 0)
+            sizes.append(size.toInt());
+    }
+
+    Benchmark benchmark(sizes, parser.value("benchmark-time").toInt());
+    return writeReport(benchmark.run(), parser.value("benchmark-output"));
+}
+
+/*!
+ * \brief runReplay replays a recording of scene interactions and writes the latency report
+ */
+static int runReplay(const QCommandLineParser &parser){
+
+    InteractionReplay replay;
+    if(!replay.load(parser.value("replay"))){
+        QTextStream(stderr) << "Cannot read the recording " << parser.value("replay") << "\n";
+        return 1;
+    }
+
+    if(parser.isSet("replay-annotations")){
+        QVector<AnnotationShape> shapes;
+        if(!AnnotationFile::read(parser.value("replay-annotations"), &shapes)){
+            QTextStream(stderr) << "Cannot read the annotation file " << parser.value("replay-annotations") << "\n";
+            return 1;
+        }
+        replay.setShapes(shapes);
+    }
+
+    return writeReport(replay.run(parser.value("replay-repeat").toInt()), parser.value("replay-output"));
+}
+
+/*!
+ * \brief generateDataset writes a synthetic .names file and annotation files
+ */
+static int generateDataset(const QCommandLineParser &parser){
+
+    SyntheticData data(parser.value("seed").toUInt());
+    bool ok = data.writeDataset(parser.value("generate-dataset"), parser.value("images").toInt(),
+                                parser.value("classes").toInt(), parser.value("shapes").toInt(),
+                                parser.value("vertices").toInt());
+    if(!ok)
+        QTextStream(stderr) << "Cannot write the dataset to " << parser.value("generate-dataset") << "\n";
+    return ok ? 0 : 1;
+}
+
+/*!
+ * \brief exportMasks writes the class ID masks of the annotated images of a folder
+ */
+static int exportMasks(const QCommandLineParser &parser){
+
+    QDir folder(parser.value("export-masks"));
+    QStringList imagePaths;
+    for(const QString &name : folder.entryList(QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.xpm", QDir::Files, QDir::Name))
+        imagePaths.append(folder.filePath(name));
+
+    //the annotation files are found as when importing the images
+    AnnotationIndex index;
+    QStringList annotated = index.discover(imagePaths);
+    QStringList annotationPaths;
+    for(const QString &imagePath : annotated)
+        annotationPaths.append(index.annotationFile(imagePath));
+
+    QStringList classNames;
+    if(parser.isSet("masks-classes")){
+        QFile names(parser.value("masks-classes"));
+        if(!names.open(QIODevice::ReadOnly | QIODevice::Text)){
+            QTextStream(stderr) << "Cannot read the class file " << names.fileName() << "\n";
+            return 1;
+        }
+        QTextStream in(&names);
+        while(!in.atEnd()){
+            QString line = in.readLine().trimmed();
+            if(!line.isEmpty() && !classNames.contains(line))
+                classNames.append(line);
+        }
+    }else{
+        for(const QString &annotationPath : annotationPaths){
+            QVector<AnnotationShape> shapes;
+            AnnotationFile::read(annotationPath, &shapes);
+            for(const AnnotationShape &shape : shapes){
+                if(!classNames.contains(shape.object))
+                    classNames.append(shape.object);
+            }
+        }
+        classNames.sort();
+    }
+    if(classNames.size() > MASK_MAX_CLASSES){
+        QTextStream(stderr) << classNames.size() << " classes, masks hold at most " << MASK_MAX_CLASSES << "\n";
+        return 1;
+    }
+
+    QString output = parser.isSet("masks-output") ? parser.value("masks-output") : folder.filePath("masks");
+    QElapsedTimer timer;
+    timer.start();
+    QStringList errors;
+    int written = MaskRasterizer(classNames).exportMasks(annotated, annotationPaths, output, &errors);
+
+    //the ID of each class, the order of the class file
+    QFile ids(QDir(output).filePath("classes.txt"));
+    if(ids.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+        QTextStream out(&ids);
+        for(int i = 0; i < classNames.size(); i++)
+            out << (i + 1) << " " << classNames[i] << "\n";
+    }
+
+    QTextStream err(stderr);
+    for(const QString &error : errors)
+        err << error << "\n";
+    err << written << " masks written to " << output << " in " << timer.elapsed() << " ms ("
+        << imagePaths.size() - annotated.size() << " images without annotation file)\n";
+    return errors.isEmpty() ? 0 : 1;
+}
+
+/*!
+ * \brief simplifyAnnotations simplifies and quantizes an annotation file, or the annotation files of a folder
+ */
+static int simplifyAnnotations(const QCommandLineParser &parser){
+
+    bool ok;
+    SimplifyOptions options;
+    options.method = SimplifyOptions::methodFromName(parser.value("simplify-method"), &ok);
+    if(!ok){
+        QTextStream(stderr) << "Unknown simplification method " << parser.value("simplify-method") << " (none, dp or vw)\n";
+        return 1;
+    }
+    options.tolerance = parser.value("simplify-tolerance").toDouble(&ok);
+    if(!ok || options.tolerance <= 0){
+        QTextStream(stderr) << "The tolerance must be a positive number of pixels\n";
+        return 1;
+    }
+    options.decimals = parser.value("simplify-decimals").toInt(&ok);
+    if(!ok || options.decimals < -1 || options.decimals > SIMPLIFY_MAX_DECIMALS){
+        QTextStream(stderr) << "The decimals must be between -1 and " << SIMPLIFY_MAX_DECIMALS << "\n";
+        return 1;
+    }
+
+    //the files are only overwritten when asked for, a wrong tolerance would otherwise lose the drawn vertices
+    if(parser.isSet("simplify-in-place") == parser.isSet("simplify-output")){
+        QTextStream(stderr) << "Give either an output folder (--simplify-output) or --simplify-in-place to overwrite the files\n";
+        return 1;
+    }
+
+    QFileInfo target(parser.value("simplify"));
+    QStringList fileNames;
+    if(target.isDir()){
+        QDir folder(target.filePath());
+        for(const QString &name : folder.entryList(QStringList() << "*.json", QDir::Files, QDir::Name))
+            fileNames.append(folder.filePath(name));
+    }else{
+        fileNames.append(target.filePath());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList errors;
+    SimplifyReport report = AnnotationSimplifier::simplifyFiles(fileNames, parser.value("simplify-output"), options, &errors);
+
+    QTextStream err(stderr);
+    for(const QString &error : errors)
+        err << error << "\n";
+    err << report.files << " files simplified in " << timer.elapsed() << " ms, " << report.summary() << "\n";
+    return errors.isEmpty() ? 0 : 1;
+}
+
+/*!
+ * \brief checkOverlaps reports the shapes drawn twice or with conflicting classes in the annotated images of a folder
+ */
+static int checkOverlaps(const QCommandLineParser &parser){
+
+    bool ok;
+    double threshold = parser.value("overlap-threshold").toDouble(&ok);
+    if(!ok || threshold <= 0 || threshold > 1){
+        QTextStream(stderr) << "The overlap threshold must be between 0 and 1\n";
+        return 1;
+    }
+
+    QDir folder(parser.value("check-overlaps"));
+    QStringList imagePaths;
+    for(const QString &name : folder.entryList(QStringList() << "*.png" << "*.jpg" << "*.jpeg" << "*.xpm", QDir::Files, QDir::Name))
+        imagePaths.append(folder.filePath(name));
+
+    AnnotationIndex index;
+    QStringList annotated = index.discover(imagePaths);
+    QStringList annotationPaths;
+    for(const QString &imagePath : annotated)
+        annotationPaths.append(index.annotationFile(imagePath));
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList errors;
+    QVector<OverlapFileReport> found = OverlapChecker::checkFiles(annotationPaths, threshold, &errors);
+
+    QJsonArray issues;
+    int duplicates = 0;
+    for(const OverlapFileReport &file : found){
+        QString image = annotated[annotationPaths.indexOf(file.fileName)];
+        for(const OverlapIssue &issue : file.issues){
+            QJsonObject first;
+            first.insert("index", issue.first);
+            first.insert("object", file.shapes[issue.first].object);
+            QJsonObject second;
+            second.insert("index", issue.second);
+            second.insert("object", file.shapes[issue.second].object);
+
+            QJsonObject o;
+            o.insert("image", image);
+            o.insert("annotation", file.fileName);
+            o.insert("kind", OverlapChecker::kindName(issue.kind));
+            o.insert("iou", issue.iou);
+            o.insert("first", first);
+            o.insert("second", second);
+            issues.append(o);
+            duplicates += issue.kind == OverlapIssue::Kind::Duplicate;
+        }
+    }
+
+    QJsonObject report;
+    report.insert("threshold", threshold);
+    report.insert("images", imagePaths.size());
+    report.insert("annotated", annotated.size());
+    report.insert("imagesWithIssues", found.size());
+    report.insert("duplicates", duplicates);
+    report.insert("conflicts", issues.size() - duplicates);
+    report.insert("elapsedMs", double(timer.elapsed()));
+    report.insert("issues", issues);
+
+    QTextStream err(stderr);
+    for(const QString &error : errors)
+        err << error << "\n";
+    err << duplicates << " duplicates and " << issues.size() - duplicates << " class conflicts in " << found.size()
+        << " of " << annotated.size() << " annotated images (" << timer.elapsed() << " ms)\n";
+
+    int written = writeReport(report, parser.value("overlap-output"));
+    return errors.isEmpty() ? written : 1;
+}
+
+/*!
+ * \brief compareAnnotators reports how much the annotation sets of several annotators agree and the images most worth reviewing
+ */
+static int compareAnnotators(const QCommandLineParser &parser){
+
+    QStringList folders = parser.values("agreement");
+    if(folders.size() < 2){
+        QTextStream(stderr) << "Give at least two annotation folders, e.g. --agreement first --agreement second\n";
+        return 1;
+    }
+    bool ok;
+    double threshold = parser.value("agreement-iou").toDouble(&ok);
+    if(!ok || threshold <= 0 || threshold > 1){
+        QTextStream(stderr) << "The agreement IoU must be between 0 and 1\n";
+        return 1;
+    }
+    int reviewCount = parser.value("agreement-review").toInt(&ok);
+    if(!ok || reviewCount < 0){
+        QTextStream(stderr) << "The number of images to review must be a positive number\n";
+        return 1;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList errors;
+    AgreementReport result = AgreementEngine(folders, threshold).run(&errors);
+
+    QJsonArray classes;
+    QStringList names = result.classes.keys();
+    names.sort();
+    for(const QString &name : names){
+        const ClassAgreement &counts = result.classes[name];
+        QJsonArray shapes;
+        for(qint64 count : counts.shapes)
+            shapes.append(double(count));
+
+        QJsonObject o;
+        o.insert("class", name);
+        o.insert("shapes", shapes);
+        o.insert("matched", double(counts.matched));
+        o.insert("precision", counts.precision());
+        o.insert("recall", counts.recall());
+        o.insert("agreement", counts.agreement());
+        o.insert("meanIou", counts.meanIou());
+        classes.append(o);
+    }
+
+    double total = 0;
+    QJsonArray review;
+    for(int i = 0; i < result.images.size(); i++){
+        const ImageAgreement &image = result.images[i];
+        total += image.disagreement;
+        if(i >= reviewCount || image.disagreement <= 0)
+            continue;
+        QJsonArray missing;
+        for(int s : image.missing)
+            missing.append(folders[s]);
+
+        QJsonObject o;
+        o.insert("file", image.fileName);
+        o.insert("disagreement", image.disagreement);
+        o.insert("shapes", image.shapes);
+        o.insert("unmatched", image.unmatched);
+        if(!missing.isEmpty())
+            o.insert("missingIn", missing);
+        review.append(o);
+    }
+
+    QJsonObject report;
+    report.insert("sets", QJsonArray::fromStringList(folders));
+    report.insert("iouThreshold", threshold);
+    report.insert("images", result.images.size());
+    report.insert("meanDisagreement", result.images.isEmpty() ? 0 : total / result.images.size());
+    report.insert("elapsedMs", double(timer.elapsed()));
+    report.insert("classes", classes);
+    report.insert("review", review);
+
+    QTextStream err(stderr);
+    for(const QString &error : errors)
+        err << error << "\n";
+    err << result.images.size() << " images compared in " << timer.elapsed() << " ms, mean disagreement "
+        << (result.images.isEmpty() ? 0 : total / result.images.size()) << "\n";
+
+    int written = writeReport(report, parser.value("agreement-output"));
+    return errors.isEmpty() ? written : 1;
+}
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
-    MainWindow w;
-    w.showMaximized();
-    return a.exec();
+    QApplication::setApplicationName("ImageLabel");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOptions({
+        {"benchmark", "Run the benchmarks and exit (use -platform offscreen on machines without a display)."},
+        {"benchmark-sizes", "Comma separated catalog sizes for the benchmarks.", "sizes", "10000,100000"},
+        {"benchmark-time", "Minimum time spent on each benchmark, in milliseconds.", "ms", "500"},
+        {"benchmark-output", "Write the benchmark report (json) to a file instead of the standard output.", "file"},
+        {"generate-dataset", "Write a synthetic .names file and annotation files to a folder and exit.", "folder"},
+        {"images", "Number of annotation files of the synthetic dataset.", "count", "1000"},
+        {"classes", "Number of classes of the synthetic dataset.", "count", "100"},
+        {"shapes", "Number of shapes per annotation file of the synthetic dataset.", "count", "20"},
+        {"vertices", "Number of points per polygon of the synthetic dataset.", "count", "8"},
+        {"seed", "Random seed of the synthetic data.", "seed", "1"},
+        {"trace", "Record trace spans and write them to a Chrome trace file on exit.", "file"},
+        {"replay", "Replay a recording of scene interactions and report the event handling times (use -platform offscreen to run without a display).", "file"},
+        {"replay-annotations", "Annotation file loaded on the scene before replaying, instead of the shapes saved in the recording.", "file"},
+        {"replay-repeat", "Number of times the recording is replayed.", "count", "1"},
+        {"replay-output", "Write the replay report (json) to a file instead of the standard output.", "file"},
+        {"export-masks", "Write a class ID mask (8 bit png at the image resolution, named after the image file plus .png) for each annotated image of a folder and exit.", "folder"},
+        {"masks-output", "Folder the masks are written to, the masks folder inside the image folder by default.", "folder"},
+        {"masks-classes", "Class file (.names) giving the class IDs (first class = 1), the classes of the annotation files sorted by name by default.", "file"},
+        {"simplify", "Simplify the polygons and round the coordinates of an annotation file, or of the annotation files of a folder, and exit.", "path"},
+        {"simplify-method", "Polygon simplification: dp (Douglas-Peucker), vw (Visvalingam-Whyatt) or none.", "method", "dp"},
+        {"simplify-tolerance", "Simplification tolerance in scene pixels.", "pixels", QString::number(SIMPLIFY_DEFAULT_TOLERANCE)},
+        {"simplify-decimals", "Number of decimals the coordinates are rounded to, 0 for integers, -1 to keep them.", "count", "-1"},
+        {"simplify-output", "Folder the simplified files are written to.", "folder"},
+        {"simplify-in-place", "Overwrite the annotation files with the simplified ones instead of writing them to a folder."},
+        {"check-overlaps", "Report the shapes drawn twice (same class) or with conflicting classes over the same object in the annotated images of a folder, and exit.", "folder"},
+        {"overlap-threshold", "Smallest intersection over union of two shapes reported.", "iou", QString::number(OVERLAP_IOU_THRESHOLD)},
+        {"overlap-output", "Write the overlap report (json) to a file instead of the standard output.", "file"},
+        {"agreement", "Annotation folder of one annotator, given once per annotator: compare the files with the same name and exit.", "folder"},
+        {"agreement-iou", "Smallest intersection over union of two shapes of the same class counted as the same object.", "iou", QString::number(AGREEMENT_IOU_THRESHOLD)},
+        {"agreement-review", "Number of images listed for review, the most disagreed on first.", "count", QString::number(AGREEMENT_REVIEW_COUNT)},
+        {"agreement-output", "Write the agreement report (json) to a file instead of the standard output.", "file"}
+    });
+    parser.process(a);
+
+    if(parser.isSet("trace"))
+        Trace::setEnabled(true);
+
+    int result;
+    if(parser.isSet("benchmark")){
+        result = runBenchmark(parser);
+    }else if(parser.isSet("replay")){
+        result = runReplay(parser);
+    }else if(parser.isSet("generate-dataset")){
+        result = generateDataset(parser);
+    }else if(parser.isSet("export-masks")){
+        result = exportMasks(parser);
+    }else if(parser.isSet("simplify")){
+        result = simplifyAnnotations(parser);
+    }else if(parser.isSet("check-overlaps")){
+        result = checkOverlaps(parser);
+    }else if(parser.isSet("agreement")){
+        result = compareAnnotators(parser);
+    }else{
+        MainWindow w;
+        w.showMaximized();
+        result = a.exec();
+    }
+
+    if(parser.isSet("trace") && !Trace::dump(parser.value("trace")))
+        QTextStream(stderr) << "Cannot write the trace to " << parser.value("trace") << "\n";
+
+    return result;
 }
@@ -1,7 +1,17 @@
 #include "mainwindow.h"
 #include "linkedlist.h"
+#include "imageimporter.h"
+#include "nearduplicatefinder.h"
+#include "trace.h"
+#include "perfcounters.h"
+#include "memorystats.h"
+#include "templatematcher.h"
 
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QGraphicsPixmapItem>
+#include <QJsonDocument>
+#include <QApplication>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QString>
@@ -9,10 +19,14 @@
 #include <QTreeWidgetItem>
 #include <fstream>
 #include <QInputDialog>
+#include <QSaveFile>
 
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
+#include <QKeyEvent>
+
+#define CLASS_SEARCH_LIMIT 200
+#define PROPAGATE_DEFAULT 5
+#define PROPAGATE_MAX 100 // most following images a propagation runs over
+#define PROPAGATE_WINDOW 4 // frames decoded at once while propagating, each holds an image pyramid
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -22,16 +36,36 @@ MainWindow::MainWindow(QWidget *parent)
 
     scene = new Scene(this);     //Create scene to display image
 
-    view = new QGraphicsView(this);       //visualise the scene as it is invisible by default
+    view = new AnnotationView(this);       //visualise the scene as it is invisible by default
     view->setScene(scene);
 
-    imgLinkedList = new LinkedList<Image>();
+    imgCatalog = new ImageCatalog();
     clsLinkedlist = new LinkedList<IClass>();
+    classIndex = new ClassIndex();
+    imgIndex = new ImageIndex();
+    imgModel = new ImageListModel(this);
+    catalogCache = new CatalogCache();
+    imageCache = new ImageCache();
+    annotationCache = new AnnotationCache(AnnotationCache::defaultLocation());
+    annotationIndex = new AnnotationIndex();
+    prefetcher = new Prefetcher(imageCache, this);
+    project = new ProjectDatabase();
+    catalogCache->load(CatalogCache::defaultLocation());
+    ui->imgList->setModel(imgModel);
+    interactionRecorder = new InteractionRecorder(scene, this);
+    statistics = new DatasetStatistics(this);
+    statisticsDock = new StatisticsDock(statistics, this);
+    addDockWidget(Qt::RightDockWidgetArea, statisticsDock);
+    statisticsDock->hide();
+    ui->menuTools->addAction(statisticsDock->toggleViewAction());
 
     ui->imgList->setMaximumWidth(320);     //Set the max widget size
+    ui->imageFilter->setMaximumWidth(320);
     ui->imgList->setMaximumHeight(300);
     ui->classesList->setMaximumWidth(320);
     ui->annotationList->setMaximumWidth(320);
+    ui->classSearch->setMaximumWidth(320);
+    ui->classSearch->installEventFilter(this); //arrow keys in the search box move through the class pane
 
     ui->imageDisplay->addWidget(view);
 
@@ -48,6 +82,20 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->actionLine, &QAction::triggered, this, &MainWindow::onLineTriggered);
     connect(ui->actionRectangle, &QAction::triggered, this, &MainWindow::onRectangleTriggered);
     connect(ui->actionRotate, &QAction::triggered, this, &MainWindow::onRectangleRotateTriggered);
+    connect(ui->actionFindDuplicates, &QAction::triggered, this, &MainWindow::onFindDuplicatesTriggered);
+    connect(ui->actionOpenProject, &QAction::triggered, this, &MainWindow::onOpenProjectTriggered);
+    connect(ui->actionRecordTrace, &QAction::toggled, this, &MainWindow::onRecordTraceToggled);
+    connect(ui->actionRecordInteractions, &QAction::toggled, this, &MainWindow::onRecordInteractionsToggled);
+    connect(ui->actionMemoryUsage, &QAction::triggered, this, &MainWindow::onMemoryUsageTriggered);
+    connect(ui->actionPropagateBoxes, &QAction::triggered, this, &MainWindow::onPropagateBoxesTriggered);
+    connect(ui->actionSaveSimplification, &QAction::triggered, this, &MainWindow::onSaveSimplificationTriggered);
+    connect(ui->actionAcceptPreLabels, &QAction::triggered, this, [=]() {
+        int accepted = scene->acceptPreLabels();
+        ui->statusbar->showMessage(QString::number(accepted) + " pre-labels accepted, " + QString::number(scene->preLabelCount()) + " left");
+    });
+    connect(ui->actionPerformanceOverlay, &QAction::toggled, this, [=](bool aChecked) {
+        view->setHudVisible(aChecked);
+    });
 
     //Connect lamda functions to the actions
     connect(ui->actionTrapezoid, &QAction::triggered, this, [=](bool aChecked) {
@@ -62,6 +110,36 @@ MainWindow::MainWindow(QWidget *parent)
         if (aChecked)
             scene->setMode(Scene::Mode::DrawPoligon);
     });
+
+    connect(ui->actionMagicWand, &QAction::triggered, this, [=](bool aChecked) {
+        if (aChecked)
+        {
+            view->setDragMode(QGraphicsView::NoDrag);
+            scene->setMode(Scene::Mode::MagicWand);
+        }
+    });
+
+    connect(ui->actionLiveWire, &QAction::triggered, this, [=](bool aChecked) {
+        if (aChecked)
+        {
+            view->setDragMode(QGraphicsView::NoDrag);
+            scene->setMode(Scene::Mode::LiveWire);
+        }
+    });
+
+    connect(ui->actionSnapToEdges, &QAction::toggled, this, [=](bool aChecked) {
+        scene->setSnapToEdges(aChecked);
+    });
+    connect(ui->actionCheckOverlaps, &QAction::toggled, this, [=](bool aChecked) {
+        scene->setCheckOverlaps(aChecked);
+        if (!aChecked)
+            return;
+        int duplicates = 0;
+        for (const OverlapIssue &issue : scene->overlaps())
+            duplicates += issue.kind == OverlapIssue::Kind::Duplicate;
+        ui->statusbar->showMessage(QString::number(duplicates) + " duplicates, " + QString::number(scene->overlaps().size() - duplicates)
+                                   + " class conflicts (orange and red marks, checked again after every change)");
+    });
     ui->mainToolBar->setDisabled(true);
     ui->openButton->setDisabled(true);
     doubleClickedImg = false;
@@ -71,9 +149,24 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    if(!currentImagePath.isEmpty())
+        annotationCache->store(currentImagePath, scene->shapes(), scene->isModified());
+    annotationCache->flush(); //unsaved shapes are restored when the image is opened in the next session
+
+    imageLoad.cancel();
+    background.cancel();
+    TaskScheduler::instance()->waitForIdle(); //saves still being written finish, and no task uses the caches deleted below
+
     delete ui;
-    delete imgLinkedList;
+    delete imgCatalog;
     delete clsLinkedlist;
+    delete classIndex;
+    delete imgIndex;
+    delete catalogCache;
+    delete imageCache;
+    delete annotationCache;
+    delete annotationIndex;
+    delete project;
 }
 
 
@@ -88,63 +181,110 @@ void MainWindow::on_browseButton_clicked()
     if ( QDialog::Accepted == dialog.exec())
     {
         QStringList filenames = dialog.selectedFiles();
-        QStringList::const_iterator it = filenames.begin();
-        QStringList::const_iterator eIt = filenames.end();
-        while ( it != eIt )
-        {
-            QString filePath = *it++;
+        CatalogCache *cache = catalogCache;
+
+        //Reading the files is done in the background, the window stays responsive while they are hashed
+        ui->browseButton->setDisabled(true);
+        ui->statusbar->showMessage("Importing " + QString::number(filenames.size()) + " images...");
+        TaskScheduler::instance()->run<QVector<CatalogEntry> >(TaskScheduler::Priority::Indexing, background, [=]() {
+            TRACE_SCOPE("import images", "import");
+            QVector<CatalogEntry> entries = ImageImporter(cache).probe(filenames);
+            cache->save(CatalogCache::defaultLocation());
+            return entries;
+        }, this, [=](const QVector<CatalogEntry> &entries) {
+            ui->browseButton->setDisabled(false);
+            ui->statusbar->clearMessage();
+            importProbed(entries);
+        });
+    }
 
-            QFileInfo f(filePath);
-            QString fileName = f.fileName(); //get the file name and extension only
+}
 
+void MainWindow::importProbed(const QVector<CatalogEntry> &entries){
 
-            QString fileDate = f.created().toString("ddMMyyyy"); //get the image date on which it was created
-            QDate sourceDate = QDate::fromString(fileDate, "ddMMyyyy");
-            //int difference = QDate::currentDate().toJulianDay() - sourceDate.toJulianDay(); /*get difference between current date and
-                                                                                      // file date for sorting by date*/
-            if(fileName != NULL){
-                image = Image(fileName,filePath,sourceDate);
+    TRACE_SCOPE("add imported images", "import");
+    QStringList duplicates;
+    QStringList added;
+    QVector<Image> addedImages;
+    QVector<Image> candidates;
+    for (const CatalogEntry &entry : entries)
+    {
+        QFileInfo f(entry.path);
+        QString fileName = f.fileName(); //get the file name and extension only
 
-            }
-            if(ImgNodeAdded() == true){
-                addNodeToImgPane(); //Once the image is  added to the linked list, then add it to the image pane list widget
-            }else{
-                QMessageBox msgBox;
-                msgBox.setText("The " + fileName + " image already exist!");
-                msgBox.exec();
-            }
 
-        }
-    }
+        //use the capture time from the EXIF header, or the date the file was created when there is none
+        QDateTime sourceDate = entry.captured >= 0 ? QDateTime::fromMSecsSinceEpoch(entry.captured) : f.created();
 
-}
+        Image image(fileName, entry.path, sourceDate);
+        image.setHash(entry.contentHash);
+        if(entry.width > 0 && entry.height > 0)
+            image.setSize(QSize(entry.width, entry.height));
+        candidates.append(image);
+    }
 
-bool MainWindow::ImgNodeAdded(){
+    QStringList existing;
+    imgCatalog->add(candidates, &existing); //one new catalog version for the whole import, images already in it are refused
 
-    static bool isFirstImg = true;
+    for (int i = 0; i < candidates.size(); i++)
+    {
+        const Image &image = candidates[i];
+        if(existing[i].isEmpty()){
+            imgIndex->insert(image.getPath(), image.getName(), image.getDate());
+            added.append(image.getPath());
+            addedImages.append(image);
+        }else if(existing[i] == image.getPath()){
+            duplicates.append(image.getPath() + " is already in the image pane");
+        }else{
+            duplicates.append(image.getPath() + " is identical to " + existing[i]);
+        }
+    }
 
-    if(isFirstImg){
-        imgLinkedList->createnode(image);
-        isFirstImg = false;
-        return true;
+    if(project->isOpen() && !project->addImages(addedImages))
+        ui->statusbar->showMessage("The images could not be added to the project: " + project->lastError());
+
+    QStringList annotated = annotationIndex->discover(added); //annotation files next to the images are opened with them
+    for (const QString &path : annotated)
+        imgIndex->setAnnotated(path, QStringList());
+    if (!annotated.isEmpty())
+        ui->statusbar->showMessage(QString::number(annotated.size()) + " annotation files found for the imported images");
+
+    addNodeToImgPane(); //Once the images are added to the catalog, then add them to the image pane
+
+    //the statistics of the annotation files found are measured in the background, the images opened meanwhile are already counted
+    statistics->setImageCount(imgCatalog->size());
+    QStringList annotationFiles;
+    for (const QString &path : annotated)
+        annotationFiles.append(annotationIndex->annotationFile(path));
+    if (!annotated.isEmpty()){
+        TaskScheduler::instance()->run<QVector<ImageStatistics> >(TaskScheduler::Priority::Indexing, background, [=]() {
+            return DatasetStatistics::scan(annotationFiles);
+        }, this, [=](const QVector<ImageStatistics> &measured) {
+            statistics->seed(annotated, measured);
+        });
     }
-    else if(imgLinkedList->nodeItemAlreadyExist(image.getName()) == false && !isFirstImg){
-        imgLinkedList->createnode(image);
-        return true;
+
+    if(!duplicates.isEmpty()){
+        QMessageBox msgBox; //report all the refused images at once
+        msgBox.setText(QString::number(duplicates.size()) + " of the selected images already exist and were not added.");
+        msgBox.setDetailedText(duplicates.join("\n"));
+        msgBox.exec();
     }
-    return false;
 }
+
 bool MainWindow::classNodeAdded(){
 
     static bool isFirstClass = true;
 
     if(isFirstClass){
         clsLinkedlist->createnode(theClass);
+        classIndex->insert(theClass.getName());
         isFirstClass = false;
         return true;
     }
     else if(clsLinkedlist->nodeItemAlreadyExist(theClass.getName()) == false && !isFirstClass){
         clsLinkedlist->createnode(theClass);
+        classIndex->insert(theClass.getName());
         return true;
     }
     return false;
@@ -152,49 +292,78 @@ bool MainWindow::classNodeAdded(){
 
 void MainWindow::addNodeToImgPane(){
 
-    ui->imgList->clear();
-    int size = imgLinkedList->getSize();
-    int count = 1;
+    TRACE_SCOPE("populate image pane", "pane");
 
-    while(count <= size){
+    ImageCatalog::Snapshot catalog = imgCatalog->snapshot();
+    QString filterText = ui->imageFilter->text().trimmed();
 
-        QTreeWidgetItem *nodeToAdd = imgLinkedList->getImageItem(count,ui->imgList);
-        ui->imgList->addTopLevelItem(nodeToAdd);
-        count++;
+    QVector<Image> images;
+    if(!filterText.isEmpty()){
+        QBitArray matches = imgIndex->filter(filterText); //only show the images matching the filter box
+        for(int i = 0; i < catalog.size(); i++){
+            const Image &img = catalog.at(i);
+            int id = imgIndex->id(img.getPath());
+            if(id >= 0 && matches.testBit(id))
+                images.append(img);
+        }
+    }else{
+        images = catalog.items();
     }
+
+    if(ui->sortImages->currentText() == "Group Near-Duplicates"){
+        //Keep the list order but move the near-duplicates next to the first image of their group
+        QHash<QString, int> groupSlot;
+        QVector<QVector<Image> > grouped;
+        for(const Image &img : images){
+            QString leader = imgIndex->groupOf(img.getPath());
+            QHash<QString, int>::const_iterator it = groupSlot.constFind(leader);
+            if(it == groupSlot.constEnd()){
+                groupSlot.insert(leader, grouped.size());
+                grouped.append(QVector<Image>() << img);
+            }else{
+                grouped[it.value()].append(img);
+            }
+        }
+
+        images.clear();
+        for(const QVector<Image> &members : grouped)
+            images += members;
+    }
+
+    imgModel->setImages(images);
 }
 
 void MainWindow::addNodeToClassPane(){
 
-    ui->classesList->clear();
-    int size = clsLinkedlist->getSize();
-    int count = 1;
-
-    while(count <= size){
+    if(!ui->classSearch->text().trimmed().isEmpty()){
+        showClassSearchResults(ui->classSearch->text()); //keep the pane filtered while a search is active
+        return;
+    }
 
-        QListWidgetItem *nodeToAdd = clsLinkedlist->getClassItem(count,ui->classesList);
-        ui->classesList->addItem(nodeToAdd);
-        count++;
+    ui->classesList->clear();
+    for(IClass cls : clsLinkedlist->getItems()){ //one walk of the linkedlist rather than one per class
+        ui->classesList->addItem(cls.getName());
     }
 }
 
 void MainWindow::on_sortImages_activated(const QString &arg1)  //When image pane drop down menu item is clicked,this function will be called
 {
-    ui->imgList->clear(); //Clear the image pane, useful when sorted linked list items are re-added
-
+    TRACE_SCOPE("sort images", "sort");
     QString option = arg1; //get the selected sorting option text
 
     if(option == "Name Ascending"){     //check whether option is sort by name or sort by date and execute sorting funtion accordingly
-        imgLinkedList->sortByNameAscending();
+        imgCatalog->sort(ImageCatalog::Order::NameAscending);
         addNodeToImgPane();
     }else if(option == "Name Descending"){
-        imgLinkedList->sortByNameDescending();
+        imgCatalog->sort(ImageCatalog::Order::NameDescending);
         addNodeToImgPane();
     }else if(option == "Date Ascending"){
-        imgLinkedList->sortByDateAscending();
+        imgCatalog->sort(ImageCatalog::Order::DateAscending);
         addNodeToImgPane();
     }else if(option == "Date Descending"){
-        imgLinkedList->sortByDateDescending();
+        imgCatalog->sort(ImageCatalog::Order::DateDescending);
+        addNodeToImgPane();
+    }else if(option == "Group Near-Duplicates"){
         addNodeToImgPane();
     }
 }
@@ -223,22 +392,88 @@ void MainWindow::on_browseClass_clicked(){
 
 }
 
-void MainWindow::on_imgList_itemDoubleClicked(QTreeWidgetItem *item, int column)
+void MainWindow::on_imgList_doubleClicked(const QModelIndex &index)
 {
     doubleClickedImg = true;
     if(doubleClickedClass)
         ui->mainToolBar->setDisabled(false);
     ui->openButton->setDisabled(false);
-    QString imgPath = imgLinkedList->returnImgPath(item->text(0)); //get the image path to display the selected image
-    scene->clear(); //Clear the scene to avoid images being displayed on top of each other
+    TRACE_SCOPE("open image", "image");
+    QElapsedTimer timer;
+    timer.start();
+
+    QString imgPath = imgModel->imageAt(index.row()).getPath(); //get the image path to display the selected image
+    scene->finishPolygon(); //counted for the image being left
+    if(!currentImagePath.isEmpty())
+        annotationCache->store(currentImagePath, scene->shapes(), scene->isModified()); //keep the shapes of the image being left
+    currentImagePath = imgPath;
+    {
+        TRACE_SCOPE("clear scene", "scene");
+        scene->clear(); //Clear the scene to avoid images being displayed on top of each other
+        scene->setImage(QImage(), GradientMap());
+    }
+    scene->setStatistics(statistics, imgPath); //the shapes added below and the later changes count for this image
+
+    //add the image to the scene, decoded in the background unless it is cached, an image still decoding for the previous one is dropped
+    QSize sceneSize(SCENE_WIDTH, SCENE_HEIGHT);
+    imageLoad.cancel();
+    imageLoad = CancellationToken();
+    if(imageCache->contains(imgPath, sceneSize)){
+        QPixmap pix = imageCache->pixmap(imgPath, sceneSize);
+        showImage(pix, pix.toImage(), imageCache->gradient(imgPath, sceneSize));
+        PerfCounters::lastImageLoadNs.store(timer.nsecsElapsed(), std::memory_order_relaxed);
+    }else{
+        TaskScheduler::instance()->run<QPair<QImage, GradientMap> >(TaskScheduler::Priority::Interactive, imageLoad, [=]() {
+            QImage image = ImageCache::decode(imgPath, sceneSize);
+            return qMakePair(image, GradientMap::compute(image)); //the edges for snapping are found while still off the gui thread
+        }, this, [=](const QPair<QImage, GradientMap> &decoded) {
+            if(decoded.first.isNull())
+                return;
+            QPixmap pix = QPixmap::fromImage(decoded.first); //pixmaps can only be made on the gui thread
+            imageCache->insert(imgPath, sceneSize, pix, decoded.second);
+            showImage(pix, decoded.first, decoded.second);
+            PerfCounters::lastImageLoadNs.store(timer.nsecsElapsed(), std::memory_order_relaxed);
+        });
+    }
+
+    QVector<AnnotationShape> cached;
+    bool modified = false;
+    QString annotationPath = annotationIndex->annotationFile(imgPath);
+    bool restored = annotationCache->take(imgPath, &cached, &modified);
+    scene->setModified(modified); //set before the shapes are added: restored edits count as unsaved in the statistics, loaded shapes as saved
+    if(restored){
+        scene->addShapes(cached); //the shapes the image had when it was left
+        if(modified)
+            ui->statusbar->showMessage("Restored the unsaved annotations of " + imgModel->imageAt(index.row()).getName());
+    }else if(project->isOpen() && project->loadAnnotations(imgPath, &cached)){
+        scene->addShapes(cached); //the shapes saved in the project
+    }else if(!annotationPath.isEmpty()){
+        if(prefetcher->takeShapes(imgPath, annotationPath, &cached) || AnnotationFile::read(annotationPath, &cached)){
+            scene->addShapes(cached); //the image's annotation file, usually parsed already by the prefetcher
+            imgIndex->setAnnotated(imgPath, scene->classNames());
+        }
+    }
+
+    //the next and previous images are the likely next ones, prepare them in the background
+    for(int row : {index.row() + 1, index.row() - 1}){
+        if(row >= 0 && row < imgModel->rowCount()){
+            QString neighbour = imgModel->imageAt(row).getPath();
+            prefetcher->prefetch(neighbour, annotationIndex->annotationFile(neighbour), sceneSize);
+        }
+    }
+
+}
 
-    QPixmap pix(imgPath);
-    scene->addPixmap(pix.scaled(1000,800,Qt::KeepAspectRatio));  //add the image to the scene
+void MainWindow::showImage(const QPixmap &pix, const QImage &image, const GradientMap &gradient){
 
+    QGraphicsPixmapItem *item = scene->addPixmap(pix);
+    item->setZValue(-1); //the shapes may have been added before the image was decoded
+    scene->setImage(image, gradient);
 }
 
 void MainWindow::on_sortClasses_activated(const QString &arg1)
 {
+    TRACE_SCOPE("sort classes", "sort");
     ui->classesList->clear();
 
     QString option = arg1;
@@ -261,6 +496,8 @@ void MainWindow::addOrRefuseClass(QString className, QFile *file){
         if(classNodeAdded() == true){
             QTextStream out(&*file);
             out << theClass.getName() << "\n";
+            if(project->isOpen())
+                project->addClass(theClass.getName());
             addNodeToClassPane();
 
         }else{
@@ -283,6 +520,7 @@ void MainWindow::on_createClass_clicked()
                                          QDir::home().dirName(), &ok);
     if (ok && !newClassName.isEmpty()){
 
+        QMutexLocker locker(&classFileMutex); //a delete may be rewriting the file in the background
         QFile file(classFilePath);
         if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)){
             QMessageBox msgBox;
@@ -297,26 +535,48 @@ void MainWindow::on_createClass_clicked()
 
 void MainWindow::on_deleteClass_clicked()
 {
-    QFile f(classFilePath);
-    if(f.open(QIODevice::ReadWrite | QIODevice::Text))
-    {
-        QString s;
-        QTextStream t(&f);
-        while(!t.atEnd())
+    QString name = classItemName;
+    QString path = classFilePath;
+    bool inProject = project->isOpen() && project->removeClass(name);
+
+    //The class file is rewritten in the background, the pane is updated once it is known whether the class was in it
+    TaskScheduler::instance()->run<bool>(TaskScheduler::Priority::Export, CancellationToken(), [=]() {
+        TRACE_SCOPE("rewrite class file", "save");
+        QMutexLocker locker(&classFileMutex); //no class is appended between the read and the commit
+        bool inFile = false;
+        QFile f(path);
+        if(f.open(QIODevice::ReadOnly | QIODevice::Text))
         {
-            QString line = t.readLine();
-            if(!line.contains(classItemName)){
-                s.append(line + "\n");
-            }else if(line.contains(classItemName)){
-                s.append("\n");
-                clsLinkedlist->deleteNode(classItemName);
-                addNodeToClassPane();
+            QString s;
+            QTextStream t(&f);
+            while(!t.atEnd())
+            {
+                QString line = t.readLine();
+                if(line.trimmed() != name){
+                    s.append(line + "\n");
+                }else{
+                    s.append("\n");
+                    inFile = true;
+                }
+            }
+            f.close();
+
+            QSaveFile out(path); //written to a temporary file and renamed, a crash never leaves a truncated class file
+            if(out.open(QIODevice::WriteOnly | QIODevice::Text)){
+                QTextStream o(&out);
+                o << s;
+                o.flush();
+                out.commit();
             }
         }
-        f.resize(0);
-        t << s;
-        f.close();
-    }
+        return inFile;
+    }, this, [=](const bool &inFile) {
+        if(inProject || inFile){
+            clsLinkedlist->deleteNode(name);
+            classIndex->remove(name);
+            addNodeToClassPane();
+        }
+    });
 }
 
 void MainWindow::on_classesList_itemClicked(QListWidgetItem *item)
@@ -371,11 +631,54 @@ void MainWindow::onRectangleRotateTriggered(bool aChecked)
 
 void MainWindow::onSave()
 {
+    if(project->isOpen() && !currentImagePath.isEmpty()){
+        saveToProject(); //the project holds the annotations, no file to choose
+        return;
+    }
+
     QString fName = QFileDialog::getSaveFileName(this,
         tr("Save"), "",
         tr("Json File (*.json)"));
 
-    scene->save(fName);
+    if(fName.isEmpty())
+        return;
+
+    TRACE_SCOPE("save annotations", "save");
+    QElapsedTimer timer;
+    timer.start();
+
+    //The shapes are collected here, simplifying, serialising and writing the file is done in the background.
+    //The image is marked saved once the file is written, unless it was left or changed meanwhile.
+    QVector<AnnotationShape> shapes = scene->shapes();
+    SimplifyOptions options = saveSimplify;
+    QString imagePath = currentImagePath;
+    QStringList classes = scene->classNames();
+    quint64 revision = scene->revision();
+    TaskScheduler::instance()->run<QPair<bool, SimplifyReport> >(TaskScheduler::Priority::Export, CancellationToken(), [=]() {
+        QVector<AnnotationShape> saved = shapes;
+        SimplifyReport report;
+        if(options.isActive())
+            report = AnnotationSimplifier::simplify(&saved, options);
+        return qMakePair(AnnotationFile::write(fName, saved), report);
+    }, this, [=](const QPair<bool, SimplifyReport> &result) {
+        PerfCounters::lastSaveNs.store(timer.nsecsElapsed(), std::memory_order_relaxed);
+        if(!result.first){
+            QMessageBox msgBox;
+            msgBox.setText("The annotations could not be saved to " + fName); //the image stays modified, its shapes are kept
+            msgBox.exec();
+            return;
+        }
+
+        ui->statusbar->showMessage("Annotations saved to " + fName + (result.second.files > 0 ? ", " + result.second.summary() : QString()));
+        if(imagePath.isEmpty())
+            return;
+        statistics->setImage(imagePath, ImageStatistics::measure(shapes));
+        if(currentImagePath == imagePath && scene->revision() == revision)
+            scene->setModified(false); //newer edits, or those of an image left meanwhile, stay counted as unsaved
+        imgIndex->setAnnotated(imagePath, classes); //the image now has an annotation file
+        if(!ui->imageFilter->text().trimmed().isEmpty())
+            addNodeToImgPane();
+    });
 }
 
 
@@ -387,94 +690,450 @@ void MainWindow::on_openButton_clicked(){
     if(jsonFilePath.isEmpty())
         return;
 
-    QFile f(jsonFilePath);
-    QFileInfo fileInfo(f.fileName());
-    QString filename(fileInfo.fileName());
+    QFileInfo fileInfo(jsonFilePath);
 
-    list.append(qMakePair(filename, jsonFilePath));
+    QListWidgetItem *item = new QListWidgetItem(fileInfo.fileName(), ui->annotationList);
+    item->setData(Qt::UserRole, jsonFilePath); //the full path, files with the same name in different folders don't collide
+    item->setToolTip(jsonFilePath);
 
-    ui->annotationList->addItem(filename);
+    if(!currentImagePath.isEmpty())
+        annotationIndex->assign(currentImagePath, jsonFilePath); //opened with this image from now on
 
 }
 
 QString MainWindow::getJsonFilePath(QListWidgetItem *anItem){
+    return anItem->data(Qt::UserRole).toString();
+}
+
+void MainWindow::on_annotationList_itemDoubleClicked(QListWidgetItem *item){
 
-    QString filePath;
+    TRACE_SCOPE("open annotations", "annotation");
+    ui->mainToolBar->setDisabled(false);
 
-    for(int x = 0; x < list.size(); x++){
-        if(list[x].first == anItem->text()){
-            filePath = list[x].second;
-        }
+    QString jsonFilePath = getJsonFilePath(item);
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<AnnotationShape> shapes;
+    if(!AnnotationFile::read(jsonFilePath, &shapes))
+        return;
+
+    scene->addShapes(shapes);
+    PerfCounters::lastLoadNs.store(timer.nsecsElapsed(), std::memory_order_relaxed);
+
+    if(!currentImagePath.isEmpty() && !shapes.isEmpty()){
+        imgIndex->setAnnotated(currentImagePath, scene->classNames()); //the annotation file belongs to the displayed image
+        if(!ui->imageFilter->text().trimmed().isEmpty())
+            addNodeToImgPane();
     }
 
-    return filePath;
 }
 
-void MainWindow::sendShapeCoordinates(QList<double> *pList, QString *objName, int type){
+void MainWindow::showClassSearchResults(const QString &text){
 
-    if(!pList->isEmpty()){
+    ui->classesList->clear();
 
-        if(type == 2)
-            scene->setupShapes(pList,objName,2);
-        else if(type == 3)
-            scene->setupShapes(pList,objName,3);
-        else if(type == 4)
-            scene->setupShapes(pList,objName,4);
+    for(const QString &name : classIndex->search(text, CLASS_SEARCH_LIMIT)){
+        ui->classesList->addItem(name);
     }
+
+    if(ui->classesList->count() > 0)
+        ui->classesList->setCurrentRow(0); //highlight the best match so enter selects it
 }
 
-void MainWindow::on_annotationList_itemDoubleClicked(QListWidgetItem *item){
+void MainWindow::on_classSearch_textChanged(const QString &arg1){
 
-    ui->mainToolBar->setDisabled(false);
+    if(arg1.trimmed().isEmpty()){
+        addNodeToClassPane(); //search cleared, show all the classes again
+    }else{
+        showClassSearchResults(arg1);
+    }
+}
 
-    QString jsonFilePath = getJsonFilePath(item);
+void MainWindow::on_classSearch_returnPressed(){
+
+    QListWidgetItem *item = ui->classesList->currentItem();
+    if(item)
+        on_classesList_itemClicked(item);
+}
+
+bool MainWindow::eventFilter(QObject *obj, QEvent *event){
+
+    if(obj == ui->classSearch && event->type() == QEvent::KeyPress){
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        int row = ui->classesList->currentRow();
+
+        if(keyEvent->key() == Qt::Key_Down && row + 1 < ui->classesList->count()){
+            ui->classesList->setCurrentRow(row + 1);
+            return true;
+        }else if(keyEvent->key() == Qt::Key_Up && row > 0){
+            ui->classesList->setCurrentRow(row - 1);
+            return true;
+        }
+    }
+
+    return QMainWindow::eventFilter(obj, event);
+}
+
+void MainWindow::on_imageFilter_textChanged(const QString &arg1){
+    Q_UNUSED(arg1)
+    addNodeToImgPane();
+}
+
+void MainWindow::onFindDuplicatesTriggered(){
+
+    ImageCatalog::Snapshot catalog = imgCatalog->snapshot(); //the images imported while searching are left for the next search
+    if(catalog.size() == 0)
+        return;
 
-    QString val;
-    QFile file;
-    file.setFileName(jsonFilePath);
-    file.open(QIODevice::ReadOnly | QIODevice::Text);
-    val = file.readAll();
-    file.close();
+    bool ok;
+    int radius = QInputDialog::getInt(this, tr("Find Near-Duplicates"),
+                                      tr("Maximum number of differing hash bits (0 = identical looking only):"),
+                                      5, 0, 11, 1, &ok);
+    if(!ok)
+        return;
+
+    QStringList paths;
+    for(int i = 0; i < catalog.size(); i++)
+        paths.append(catalog.at(i).getPath());
+
+    CatalogCache *cache = catalogCache;
+    ui->actionFindDuplicates->setDisabled(true);
+    ui->statusbar->showMessage("Looking for near-duplicates of " + QString::number(paths.size()) + " images...");
+
+    TaskScheduler::instance()->run<QVector<int> >(TaskScheduler::Priority::Indexing, background, [=]() {
+        QVector<int> groups = NearDuplicateFinder(cache).findGroups(paths, radius); //hashes and searches on the workers
+        cache->save(CatalogCache::defaultLocation());
+        return groups;
+    }, this, [=](const QVector<int> &groups) {
+        ui->actionFindDuplicates->setDisabled(false);
+        imgIndex->setGroups(paths, groups);
+
+        int duplicates = 0;
+        for(int i = 0; i < groups.size(); i++){
+            if(groups[i] != i)
+                duplicates++;
+        }
 
-    QJsonDocument d = QJsonDocument::fromJson(val.toUtf8());
-    QJsonObject sett2 = d.object();
+        addNodeToImgPane();
+        ui->statusbar->showMessage(QString::number(duplicates) + " near-duplicate images found. Use \"is:unique\" in the filter to hide them or \"Group Near-Duplicates\" to list them together.");
+    });
+}
+
+void MainWindow::onSaveSimplificationTriggered(){
+
+    QStringList methods;
+    methods << "None" << "Douglas-Peucker" << "Visvalingam-Whyatt";
+    bool ok;
+    QString method = QInputDialog::getItem(this, "Save Simplification", "Polygon simplification:", methods,
+                                           int(saveSimplify.method), false, &ok);
+    if(!ok)
+        return;
+
+    SimplifyOptions options;
+    options.method = SimplifyOptions::Method(methods.indexOf(method));
+    options.tolerance = saveSimplify.tolerance;
+    if(options.method != SimplifyOptions::Method::None){
+        options.tolerance = QInputDialog::getDouble(this, "Save Simplification", "Tolerance in pixels:",
+                                                    saveSimplify.tolerance, 0.01, 50, 2, &ok);
+        if(!ok)
+            return;
+    }
 
-    QList<double> rectList;
-    QList<double> polyList;
-    QList<double> trapList;
+    //-1 keeps the coordinates as they are, 0 rounds them to integers
+    options.decimals = QInputDialog::getInt(this, "Save Simplification", "Coordinate decimals (-1 to keep them):",
+                                            saveSimplify.decimals, -1, SIMPLIFY_MAX_DECIMALS, 1, &ok);
+    if(!ok)
+        return;
 
-    QString rObjName = "";
-    QString tObjName = "";
-    QString pObjName = "";
+    saveSimplify = options;
+    ui->statusbar->showMessage(saveSimplify.isActive() ? "The annotations are simplified when saved" : "The annotations are saved as drawn");
+}
 
-    QJsonArray objsArray = sett2.value("objects").toArray();
+void MainWindow::onPropagateBoxesTriggered(){
 
-    for(int i = 0; i < objsArray.size(); i++){
+    ImageCatalog::Snapshot catalog = imgCatalog->snapshot();
+    int current = -1;
+    for(int i = 0; i < catalog.size() && current < 0; i++){
+        if(catalog.at(i).getPath() == currentImagePath)
+            current = i;
+    }
 
-        QJsonObject item = objsArray[i].toObject();
-        QJsonValue subobj = item["shape"];
-        QJsonValue subobj2 = item["object"];
+    QVector<AnnotationShape> boxes;
+    for(const AnnotationShape &shape : scene->shapes()){
+        if(shape.type == SHAPE_RECT && shape.confidence < 0)
+            boxes.append(shape); //the boxes drawn or accepted by the annotator
+    }
+    if(current < 0 || current + 1 >= catalog.size() || boxes.isEmpty()){
+        ui->statusbar->showMessage("Open an image with rectangles that has images after it to propagate its boxes");
+        return;
+    }
 
-        QJsonArray test = item["coordinates"].toArray();
+    bool ok;
+    int count = QInputDialog::getInt(this, tr("Propagate Boxes"), tr("Number of following images:"),
+                                     PROPAGATE_DEFAULT, 1, qMin(PROPAGATE_MAX, catalog.size() - current - 1), 1, &ok);
+    if(!ok)
+        return;
 
-        for(int j = 0; j < test.size(); j++){
-            if(subobj.toString() == "Rectangle"){
-                rectList.append(test[j].toDouble());
-                rObjName = subobj2.toString();
-            }else if(subobj.toString() == "Trapezoid"){
-                trapList.append(test[j].toDouble());
-                tObjName = subobj2.toString();
-            }else if(subobj.toString() == "Polygon"){
-                polyList.append(test[j].toDouble());
-                pObjName = subobj2.toString();
+    QStringList paths;
+    for(int i = current; i <= current + count; i++)
+        paths.append(catalog.at(i).getPath());
+
+    QSize sceneSize(SCENE_WIDTH, SCENE_HEIGHT);
+    ui->actionPropagateBoxes->setDisabled(true);
+    ui->statusbar->showMessage("Propagating " + QString::number(boxes.size()) + " boxes to " + QString::number(count) + " images...");
+
+    TaskScheduler::instance()->run<QVector<QVector<AnnotationShape> > >(TaskScheduler::Priority::Indexing, background, [=]() {
+        //The frames are decoded at the displayed size so the boxes are in the same coordinates, a few at a time so the memory stays
+        //bounded. Each box is followed from frame to frame until it is lost, the template stays the one drawn by the annotator.
+        TemplateMatcher source(ImageCache::decode(paths[0], sceneSize));
+        QVector<QRectF> previous(boxes.size());
+        QVector<bool> tracked(boxes.size(), true);
+        for(int b = 0; b < boxes.size(); b++)
+            previous[b] = QRectF(boxes[b].coordinates[0], boxes[b].coordinates[1], boxes[b].coordinates[2], boxes[b].coordinates[3]);
+
+        QVector<QVector<AnnotationShape> > found(paths.size());
+        int remaining = boxes.size();
+        for(int first = 1; first < paths.size() && remaining > 0; first += PROPAGATE_WINDOW){
+            int window = qMin(PROPAGATE_WINDOW, paths.size() - first);
+            QVector<TemplateMatcher> frames(window);
+            TemplateMatcher *decoded = frames.data(); //each task writes its own entry, detached before the tasks start
+            TaskScheduler::instance()->parallelFor(window, [&](int f) {
+                decoded[f] = TemplateMatcher(ImageCache::decode(paths[first + f], sceneSize));
+            });
+
+            for(int f = 0; f < window && remaining > 0; f++){
+                QVector<AnnotationShape> shapes(boxes.size());
+                AnnotationShape *out = shapes.data();
+                const bool *following = tracked.constData();
+                const QRectF *last = previous.constData();
+                TaskScheduler::instance()->parallelFor(boxes.size(), [&](int b) {
+                    if(!following[b])
+                        return;
+                    QRectF drawn(boxes[b].coordinates[0], boxes[b].coordinates[1], boxes[b].coordinates[2], boxes[b].coordinates[3]);
+                    MatchResult match = decoded[f].locate(source, drawn, last[b]);
+                    out[b] = boxes[b];
+                    out[b].confidence = match.confidence;
+                    out[b].coordinates = { match.box.x(), match.box.y(), match.box.width(), match.box.height() };
+                });
+
+                //a box lost in a frame is not looked for in the following ones
+                for(int b = 0; b < boxes.size(); b++){
+                    if(!tracked[b])
+                        continue;
+                    if(shapes[b].confidence < MATCH_MIN_CONFIDENCE){
+                        tracked[b] = false;
+                        remaining--;
+                        continue;
+                    }
+                    found[first + f].append(shapes[b]);
+                    previous[b] = QRectF(shapes[b].coordinates[0], shapes[b].coordinates[1], shapes[b].coordinates[2], shapes[b].coordinates[3]);
+                }
+            }
+        }
+        return found;
+    }, this, [=](const QVector<QVector<AnnotationShape> > &found) {
+        ui->actionPropagateBoxes->setDisabled(false);
+
+        int proposed = 0, images = 0;
+        for(int i = 1; i < found.size(); i++){
+            if(found[i].isEmpty())
+                continue;
+            if(paths[i] == currentImagePath){
+                scene->removePreLabels(); //pre-labels of an earlier propagation are replaced
+                scene->addShapes(found[i]); //the user went on to this image meanwhile
+            }else{
+                QVector<AnnotationShape> shapes = storedAnnotations(paths[i]);
+                QVector<AnnotationShape> kept;
+                for(const AnnotationShape &shape : shapes){
+                    if(shape.confidence < 0)
+                        kept.append(shape); //pre-labels of an earlier propagation are replaced
+                }
+                annotationCache->store(paths[i], kept + found[i], true); //shown, unsaved, when the image is opened
             }
+            proposed += found[i].size();
+            images++;
+        }
+
+        ui->statusbar->showMessage(QString::number(proposed) + " pre-labels proposed on " + QString::number(images)
+                                   + " images, accept them with Tools > Accept Pre-labels or adjust them first");
+    });
+}
+
+QVector<AnnotationShape> MainWindow::storedAnnotations(const QString &imgPath){
+
+    QVector<AnnotationShape> shapes;
+    bool modified;
+    if(annotationCache->take(imgPath, &shapes, &modified))
+        return shapes;
+    if(project->isOpen() && project->loadAnnotations(imgPath, &shapes))
+        return shapes;
+
+    QString annotationPath = annotationIndex->annotationFile(imgPath);
+    if(!annotationPath.isEmpty())
+        AnnotationFile::read(annotationPath, &shapes);
+    return shapes;
+}
+
+void MainWindow::onRecordTraceToggled(bool aChecked){
+
+    if(aChecked){
+        Trace::clear(); //start a new trace
+        Trace::setEnabled(true);
+        ui->statusbar->showMessage("Recording trace...");
+        return;
+    }
+
+    Trace::setEnabled(false);
+    QString fName = QFileDialog::getSaveFileName(this, tr("Save Trace"), "trace.json",
+                                                 tr("Chrome Trace (*.json)"));
+    if(fName.isEmpty())
+        return;
+
+    if(Trace::dump(fName)){
+        ui->statusbar->showMessage("Trace saved, open it in chrome://tracing or ui.perfetto.dev");
+    }else{
+        QMessageBox msgBox;
+        msgBox.setText("The trace could not be saved to " + fName);
+        msgBox.exec();
+    }
+}
+
+void MainWindow::onRecordInteractionsToggled(bool aChecked){
+
+    if(aChecked){
+        interactionRecorder->start(); //the shapes on the scene now are saved with the recording
+        ui->statusbar->showMessage("Recording scene interactions...");
+        return;
+    }
+
+    interactionRecorder->stop();
+    QString fName = QFileDialog::getSaveFileName(this, tr("Save Interactions"), "interactions.json",
+                                                 tr("Interaction Recording (*.json)"));
+    if(fName.isEmpty())
+        return;
+
+    if(interactionRecorder->save(fName)){
+        ui->statusbar->showMessage(QString::number(interactionRecorder->eventCount()) + " events saved, replay them with --replay " + fName);
+    }else{
+        QMessageBox msgBox;
+        msgBox.setText("The interactions could not be saved to " + fName);
+        msgBox.exec();
+    }
+}
+
+void MainWindow::saveToProject(){
+
+    TRACE_SCOPE("save annotations", "save");
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<AnnotationShape> shapes = scene->shapes();
+    SimplifyReport report;
+    if(saveSimplify.isActive())
+        report = AnnotationSimplifier::simplify(&shapes, saveSimplify);
+    if(!project->saveAnnotations(currentImagePath, shapes)){
+        QMessageBox msgBox;
+        msgBox.setText("The annotations could not be saved to the project: " + project->lastError());
+        msgBox.exec();
+        return;
+    }
+
+    statistics->setImage(currentImagePath, ImageStatistics::measure(shapes)); //as saved, after the simplification
+    scene->setModified(false); //the unsaved edits are dropped from the statistics, the saved shapes count
+    PerfCounters::lastSaveNs.store(timer.nsecsElapsed(), std::memory_order_relaxed);
+
+    if(shapes.isEmpty()){
+        ui->statusbar->showMessage("Annotations removed from the project");
+        return;
+    }
+
+    imgIndex->setAnnotated(currentImagePath, scene->classNames());
+    if(!ui->imageFilter->text().trimmed().isEmpty())
+        addNodeToImgPane();
+    ui->statusbar->showMessage("Annotations saved to the project, " + QString::number(project->imageCount(ProjectDatabase::Status::Unannotated)) + " images left to annotate"
+                               + (report.files > 0 ? ", " + report.summary() : QString()));
+}
+
+void MainWindow::onOpenProjectTriggered(){
+
+    QString fName = QFileDialog::getSaveFileName(this, tr("Open or Create Project"), "",
+                                                 tr("Label Project (*.labelproject)"), nullptr,
+                                                 QFileDialog::DontConfirmOverwrite);
+    if(fName.isEmpty())
+        return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool opened = project->open(fName);
+    if(opened){
+        //Whatever is already loaded joins the project, then the project content is loaded
+        project->addImages(imgCatalog->snapshot().items());
+        for(IClass cls : clsLinkedlist->getItems())
+            project->addClass(cls.getName());
+
+        QVector<Image> projectImages = project->images();
+        QStringList existing;
+        imgCatalog->add(projectImages, &existing);
+        for(int i = 0; i < projectImages.size(); i++){
+            const Image &img = projectImages[i];
+            if(existing[i].isEmpty())
+                imgIndex->insert(img.getPath(), img.getName(), img.getDate());
+        }
+
+        QHash<QString, QStringList> annotated = project->annotatedClasses();
+        for(QHash<QString, QStringList>::const_iterator it = annotated.constBegin(); it != annotated.constEnd(); ++it)
+            imgIndex->setAnnotated(it.key(), it.value());
+
+        for(const QString &name : project->classes()){
+            theClass = IClass(name);
+            classNodeAdded();
         }
-        sendShapeCoordinates(&rectList, &rObjName, 2);
-        sendShapeCoordinates(&trapList, &tObjName, 3);
-        sendShapeCoordinates(&polyList, &pObjName, 4);
-        rectList.clear();
-        polyList.clear();
-        trapList.clear();
+
+        addNodeToImgPane();
+        addNodeToClassPane();
+
+        //the stored shapes are measured in the background with a connection of the task's own
+        statistics->setImageCount(imgCatalog->size());
+        TaskScheduler::instance()->run<QPair<QStringList, QVector<ImageStatistics> > >(TaskScheduler::Priority::Indexing, background, [=]() {
+            QStringList paths;
+            QVector<ImageStatistics> measured = DatasetStatistics::scanProject(fName, &paths);
+            return qMakePair(paths, measured);
+        }, this, [=](const QPair<QStringList, QVector<ImageStatistics> > &result) {
+            statistics->seed(result.first, result.second);
+        });
+    }
+    QApplication::restoreOverrideCursor();
+
+    if(!opened){
+        QMessageBox msgBox;
+        msgBox.setText("The project could not be opened: " + project->lastError());
+        msgBox.exec();
+        return;
     }
 
+    setWindowTitle(QFileInfo(fName).fileName());
+    ui->statusbar->showMessage(QString::number(imgIndex->size()) + " images, "
+                               + QString::number(project->imageCount(ProjectDatabase::Status::Unannotated)) + " not annotated yet");
+}
+
+void MainWindow::onMemoryUsageTriggered(){
+
+    MemoryStats stats;
+    stats.add("Image catalog", imgCatalog->memoryUsed() + imgIndex->memoryUsed(), imgCatalog->size());
+    stats.add("Classes", clsLinkedlist->memoryUsed() + classIndex->memoryUsed(), clsLinkedlist->getSize());
+
+    int shapes = 0;
+    qint64 shapeBytes = scene->memoryUsed(&shapes);
+    stats.add("Scene shapes", shapeBytes, shapes);
+
+    stats.add("Image cache", PerfCounters::imageCacheBytes.load(std::memory_order_relaxed),
+              PerfCounters::imageCacheCount.load(std::memory_order_relaxed),
+              PerfCounters::imageCacheLimit.load(std::memory_order_relaxed));
+    stats.add("Annotation cache", annotationCache->memoryUsed(), annotationCache->count(), ANNOTATION_CACHE_BUDGET);
+
+    QMessageBox msgBox;
+    msgBox.setWindowTitle("Memory Usage");
+    msgBox.setText(stats.report());
+    msgBox.setDetailedText(QJsonDocument(stats.toJson()).toJson());
+    msgBox.exec();
 }
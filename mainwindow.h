@@ -5,12 +5,29 @@
 #include "image.h"
 #include "iclass.h"
 #include "scene.h"
+#include "classindex.h"
+#include "imageindex.h"
+#include "imagecatalog.h"
+#include "imagelistmodel.h"
+#include "catalogcache.h"
+#include "interactionlog.h"
+#include "annotationview.h"
+#include "imagecache.h"
+#include "annotationcache.h"
+#include "annotationindex.h"
+#include "annotationsimplifier.h"
+#include "datasetstatistics.h"
+#include "prefetcher.h"
+#include "projectdatabase.h"
+#include "statisticsdock.h"
+#include "taskscheduler.h"
 
 #include <QMainWindow>
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QDateTime>
 #include <QFileInfo>
+#include <QMutex>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -34,18 +51,13 @@ public:
     ~MainWindow();
 
 private:
-    /*!
-     * \brief method returns whether an image node is added to the linkedlist (adding an image that already exist in the linkedlist will be refused)
-     * \return return true if image node is added or false if it's is not added
-     */
-    bool ImgNodeAdded();
     /*!
      * \brief method returns whether a class node is added to the linkedlist (adding a class that already exist in the linkedlist will be refused)
      * \return returns true if the class node is added or returns false if it's is not added
      */
     bool classNodeAdded();
     /*!
-     * \brief addNodeToImgPane method add all the images that are in the linkedlist to the image pane widget
+     * \brief addNodeToImgPane method add all the images that are in the catalog to the image pane widget
      */
     void addNodeToImgPane();
     /*!
@@ -58,19 +70,48 @@ private:
      * \param contains classes
      */
     void addOrRefuseClass(QString className, QFile *file);
-    /*!
-     * \brief sendShapeCoordinates method send the coordinates of the annotated shapes that are in the json file to a method in the Scene class so it can display it
-     * \param pList is list of coordinates which can be of rectangle, trapezoid or polygon
-     * \param objName is the object or class name e.g. Animal, Car, tree etc
-     * \param type is the type of the shape, 2 = rectangle, 3 == trapezoid and 4 = polygon
-     */
-    void sendShapeCoordinates(QList<double> *pList, QString *objName, int type);
     /*!
      * \brief getJsonFilePath method gets the json file path when and item in the annotaion pane is double click, this enbale the annotated shapes to be displayed automatically
-     * \param anItem is the name of the json file
+     * \param anItem is the annotation pane item, it stores the full path of its file
      * \return returns the json file path as string
      */
     QString getJsonFilePath(QListWidgetItem *anItem); 
+    /*!
+     * \brief showClassSearchResults method fills the class pane with the classes matching the search text, best match first
+     * \param text is the text typed in the class search box
+     */
+    void showClassSearchResults(const QString &text);
+    /*!
+     * \brief saveToProject method saves the shapes of the displayed image into the open project
+     */
+    void saveToProject();
+    /*!
+     * \brief importProbed method adds the probed images to the image pane, it is called on the gui thread once the import task has read the files
+     * \param entries are the catalog entries of the selected files
+     */
+    void importProbed(const QVector<CatalogEntry> &entries);
+    /*!
+     * \brief showImage method puts the decoded image under the shapes of the scene
+     * \param pix is the image scaled to the scene size
+     * \param image is the same image, used by the tools that look at the pixels
+     * \param gradient is its gradient map, used for edge snapping
+     */
+    void showImage(const QPixmap &pix, const QImage &image, const GradientMap &gradient);
+    /*!
+     * \brief storedAnnotations method gets the shapes of an image that is not displayed, from the annotation cache, the project or its annotation file
+     * \param imgPath is the image path
+     * \return returns the shapes, the image is removed from the annotation cache
+     */
+    QVector<AnnotationShape> storedAnnotations(const QString &imgPath);
+
+protected:
+    /*!
+     * \brief eventFilter method lets the up and down arrow keys in the class search box move the selection in the class pane
+     * \param obj is the object receiving the event
+     * \param event is the event
+     * \return returns true if the event was handled here
+     */
+    bool eventFilter(QObject *obj, QEvent *event);
 
 private slots:
     /*!
@@ -83,11 +124,10 @@ private slots:
      */
     void on_sortImages_activated(const QString &arg1);
     /*!
-     * \brief on_imgList_itemDoubleClicked method get triggered when an image item is double click and then display the image to the scene
-     * \param item is the image item with date on the tree widget
-     * \param column is the column number
+     * \brief on_imgList_doubleClicked method get triggered when an image row is double click and then display the image to the scene
+     * \param index is the model index of the double clicked row
      */
-    void on_imgList_itemDoubleClicked(QTreeWidgetItem *item, int column);
+    void on_imgList_doubleClicked(const QModelIndex &index);
     /*!
      * \brief on_browseClass_clicked method is triggered when class browse button is clicked and opens the classes
      */
@@ -143,6 +183,50 @@ private slots:
      * \param item is the json file item on the annotaion pane
      */
     void on_annotationList_itemDoubleClicked(QListWidgetItem *item);
+    /*!
+     * \brief on_classSearch_textChanged method is triggered when the class search text changes and filters the class pane
+     * \param arg1 is the search text
+     */
+    void on_classSearch_textChanged(const QString &arg1);
+    /*!
+     * \brief on_classSearch_returnPressed method is triggered when enter is pressed in the class search box and selects the highlighted class
+     */
+    void on_classSearch_returnPressed();
+    /*!
+     * \brief on_imageFilter_textChanged method is triggered when the image filter text changes and refreshes the image pane with the matching images
+     * \param arg1 is the filter text
+     */
+    void on_imageFilter_textChanged(const QString &arg1);
+    /*!
+     * \brief onFindDuplicatesTriggered method is triggered from the tools menu, it groups the near-duplicate images of the image pane
+     */
+    void onFindDuplicatesTriggered();
+    /*!
+     * \brief onRecordTraceToggled method starts recording trace spans, or stops and saves them as a Chrome trace file
+     * \param aChecked is true when recording starts
+     */
+    void onRecordTraceToggled(bool aChecked);
+    /*!
+     * \brief onOpenProjectTriggered method opens or creates a project file, the loaded images and classes are added to it and its content is loaded
+     */
+    void onOpenProjectTriggered();
+    /*!
+     * \brief onRecordInteractionsToggled method starts recording the mouse and key events of the scene, or stops and saves them for replaying with --replay
+     * \param aChecked is true when recording starts
+     */
+    void onRecordInteractionsToggled(bool aChecked);
+    /*!
+     * \brief onMemoryUsageTriggered method shows the memory used by each subsystem
+     */
+    void onMemoryUsageTriggered();
+    /*!
+     * \brief onPropagateBoxesTriggered method looks for the rectangles of the displayed image in the following images of the catalog, the boxes found are added to them as pre-labels
+     */
+    void onPropagateBoxesTriggered();
+    /*!
+     * \brief onSaveSimplificationTriggered method asks how the polygons are simplified and the coordinates rounded when the annotations are saved
+     */
+    void onSaveSimplificationTriggered();
 
 private:
     /*!
@@ -150,26 +234,86 @@ private:
      */
     Ui::MainWindow *ui;
     /*!
-     * \brief imgLinkedList is an object of LinkedList class which used for dealing with images stored in the linkedlist
+     * \brief imgCatalog stores the imported images, the pane and the background tasks read it through snapshots
      */
-    LinkedList<Image> *imgLinkedList;
+    ImageCatalog *imgCatalog;
     /*!
      * \brief clsLinkedlist is an object of LinkedList class which used for dealing with classes stored in the linkedlist
      */
     LinkedList<IClass> *clsLinkedlist;
+    /*!
+     * \brief classIndex is the search index over the classes in clsLinkedlist, used by the class search box
+     */
+    ClassIndex *classIndex;
+    /*!
+     * \brief imgIndex is the search index over the images in imgCatalog, used by the image filter box
+     */
+    ImageIndex *imgIndex;
+    /*!
+     * \brief imgModel holds the rows shown in the image pane
+     */
+    ImageListModel *imgModel;
+    /*!
+     * \brief currentImagePath is the path of the image displayed on the scene
+     */
+    QString currentImagePath;
+    /*!
+     * \brief catalogCache keeps the content hashes of imported files between sessions
+     */
+    CatalogCache *catalogCache;
+    /*!
+     * \brief interactionRecorder records the scene events for the replay harness
+     */
+    InteractionRecorder *interactionRecorder;
+    /*!
+     * \brief imageCache keeps the recently displayed images decoded
+     */
+    ImageCache *imageCache;
+    /*!
+     * \brief annotationCache keeps the shapes of the images that are not displayed
+     */
+    AnnotationCache *annotationCache;
+    /*!
+     * \brief annotationIndex maps each image to its annotation file
+     */
+    AnnotationIndex *annotationIndex;
+    /*!
+     * \brief prefetcher prepares the images next to the displayed one on worker threads
+     */
+    Prefetcher *prefetcher;
+    /*!
+     * \brief project is the project file, when it is open images, classes and annotations are saved to it
+     */
+    ProjectDatabase *project;
+    /*!
+     * \brief imageLoad cancels the decoding of the image being opened when another image is opened
+     */
+    CancellationToken imageLoad;
+    /*!
+     * \brief background cancels the import and near-duplicate tasks when the window closes
+     */
+    CancellationToken background;
+    /*!
+     * \brief saveSimplify is how the shapes are simplified and quantized when they are saved, the shapes on the scene are not changed
+     */
+    SimplifyOptions saveSimplify;
+    /*!
+     * \brief statistics are the dataset statistics, seeded by a scan of the annotations and kept up to date by the scene and the saves
+     */
+    DatasetStatistics *statistics;
+    /*!
+     * \brief statisticsDock shows the statistics, it is opened from the tools menu
+     */
+    StatisticsDock *statisticsDock;
     QString filePath;
     /*!
      * \brief scene is an object of Scene class which is used for adding and removing items from the scene such as images and shapes
      */
     Scene *scene;
     /*!
-     * \brief view is an object of QGraphicsView which visualises the scene
-     */
-    QGraphicsView *view;
-    /*!
-     * \brief image is an object of Image class used for dealing with images name,path and date
+     * \brief view is an object of AnnotationView (a QGraphicsView with a performance overlay) which visualises the scene
      */
-    Image image;
+    AnnotationView *view;
     /*!
      * \brief theClass is an object of IClass used for dealing with class
      */
@@ -182,6 +326,10 @@ private:
      * \brief classFilePath is for storing the class file path that's used by different methods
      */
     QString classFilePath;
+    /*!
+     * \brief classFileMutex serialises the writes to the class file, classes are appended on the gui thread and deletes rewrite it in the background
+     */
+    QMutex classFileMutex;
     /*!
      * \brief classItemName stores the class name thats on the class pane widget
      */
@@ -194,9 +342,5 @@ private:
      * \brief doubleClickedClass is used to determine whether a class item is clicked (if an image is double clicked and a class item is clicked then the toolbar will be enabled)
      */
     bool doubleClickedClass;
-    /*!
-     * \brief list is used for storing the pair of json file name and path
-     */
-    QList<QPair<QString, QString> > list;
 };
 #endif // MAINWINDOW_H
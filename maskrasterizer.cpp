@@ -0,0 +1,178 @@
+#include "maskrasterizer.h"
+#include "geometry.h"
+#include "scene.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutex>
+#include <QTransform>
+#include <QtMath>
+
+#include <algorithm>
+#include <cstring>
+
+MaskRasterizer::MaskRasterizer(const QStringList &classNames)
+{
+    for(int i = 0; i < classNames.size(); i++)
+        ids.insert(classNames[i], i + 1);
+}
+
+int MaskRasterizer::classId(const QString &name) const{
+    return ids.value(name, 0);
+}
+
+QSize MaskRasterizer::sceneSize(const QSize &imageSize){
+    return imageSize.scaled(QSize(SCENE_WIDTH, SCENE_HEIGHT), Qt::KeepAspectRatio); //as ImageCache::decode scales them
+}
+
+QPolygonF MaskRasterizer::outline(const AnnotationShape &shape){
+
+    QPolygonF polygon;
+    const QVector<double> &c = shape.coordinates;
+
+    switch(shape.type){
+    case SHAPE_RECT:
+    {
+        if(c.size() < 4)
+            break;
+        polygon = Geometry::rotatedRect(QRectF(c[0], c[1], c[2], c[3]), shape.rotation);
+    }
+        break;
+    case SHAPE_TRAPEZOID:
+    case SHAPE_POLYGON:
+        for(int i = 0; i + 1 < c.size(); i += 2)
+            polygon << QPointF(c[i], c[i + 1]);
+        break;
+    default:
+        break;
+    }
+    return polygon.size() >= 3 ? polygon : QPolygonF();
+}
+
+void MaskRasterizer::fillPolygon(QImage *mask, const QPolygonF &polygon, quint8 value){
+
+    struct Edge
+    {
+        int firstRow;   //first row whose center is at or below the upper end
+        int endRow;     //first row whose center is at or below the lower end
+        double x0, y0;  //upper end
+        double slope;   //dx / dy
+    };
+
+    int width = mask->width();
+    int height = mask->height();
+    int n = polygon.size();
+
+    //Edge table sorted by first row, horizontal edges never cross a row center
+    QVector<Edge> edges;
+    edges.reserve(n);
+    for(int i = 0; i < n; i++){
+        QPointF a = polygon[i];
+        QPointF b = polygon[(i + 1) % n];
+        if(a.y() > b.y())
+            std::swap(a, b);
+        Edge e;
+        e.firstRow = qMax(0, qCeil(a.y() - 0.5));
+        e.endRow = qMin(height, qCeil(b.y() - 0.5));
+        if(e.firstRow >= e.endRow)
+            continue;
+        e.x0 = a.x();
+        e.y0 = a.y();
+        e.slope = (b.x() - a.x()) / (b.y() - a.y());
+        edges.append(e);
+    }
+    if(edges.isEmpty())
+        return;
+    std::sort(edges.begin(), edges.end(), [](const Edge &l, const Edge &r) { return l.firstRow < r.firstRow; });
+
+    QVector<Edge> active;
+    QVector<double> crossings;
+    int next = 0;
+    for(int y = edges[0].firstRow; y < height && (next < edges.size() || !active.isEmpty()); y++){
+        double center = y + 0.5;
+
+        //edges starting on this row join, finished ones leave
+        for(int i = active.size() - 1; i >= 0; i--){
+            if(active[i].endRow <= y)
+                active.remove(i);
+        }
+        for(; next < edges.size() && edges[next].firstRow == y; next++)
+            active.append(edges[next]);
+
+        //the crossings are computed from the upper end rather than stepped, so long edges don't drift
+        crossings.clear();
+        for(const Edge &e : active)
+            crossings.append(e.x0 + (center - e.y0) * e.slope);
+        std::sort(crossings.begin(), crossings.end());
+
+        //the pixels whose center is between two crossings, one memset per span (vectorised by the C library)
+        quint8 *row = mask->scanLine(y);
+        for(int i = 0; i + 1 < crossings.size(); i += 2){
+            int from = qMax(0, qCeil(crossings[i] - 0.5));
+            int to = qMin(width, qCeil(crossings[i + 1] - 0.5));
+            if(from < to)
+                std::memset(row + from, value, to - from);
+        }
+    }
+}
+
+QImage MaskRasterizer::rasterize(const QVector<AnnotationShape> &shapes, const QSize &imageSize) const{
+
+    TRACE_SCOPE("rasterize mask", "export");
+    QImage mask(imageSize, QImage::Format_Grayscale8);
+    mask.fill(0);
+
+    QSize scene = sceneSize(imageSize);
+    if(scene.isEmpty())
+        return mask;
+    QTransform toImage = QTransform::fromScale(double(imageSize.width()) / scene.width(),
+                                               double(imageSize.height()) / scene.height());
+
+    for(const AnnotationShape &shape : shapes){
+        int id = classId(shape.object);
+        if(id == 0 || shape.confidence >= 0)
+            continue; //unknown class, or a pre-label the annotator didn't accept
+        QPolygonF polygon = outline(shape);
+        if(!polygon.isEmpty())
+            fillPolygon(&mask, toImage.map(polygon), quint8(id));
+    }
+    return mask;
+}
+
+int MaskRasterizer::exportMasks(const QStringList &imagePaths, const QStringList &annotationPaths, const QString &outputFolder, QStringList *errors) const{
+
+    TRACE_SCOPE("export masks", "export");
+    if(!QDir().mkpath(outputFolder)){
+        errors->append("Cannot create " + outputFolder);
+        return 0;
+    }
+
+    QMutex mutex;
+    int written = 0;
+    TaskScheduler::instance()->parallelFor(imagePaths.size(), [&](int i) {
+        QString error;
+        QSize size = QImageReader(imagePaths[i]).size(); //the header only, the pixels are not needed
+        QVector<AnnotationShape> shapes;
+        if(!size.isValid()){
+            error = "Cannot read the size of " + imagePaths[i];
+        }else if(!AnnotationFile::read(annotationPaths[i], &shapes)){
+            error = "Cannot read " + annotationPaths[i];
+        }else{
+            QImage mask = rasterize(shapes, size);
+            //the suffix is kept, a.jpg and a.png of the same folder would otherwise write the same mask
+            QString fileName = QDir(outputFolder).filePath(QFileInfo(imagePaths[i]).fileName() + ".png");
+            if(!mask.save(fileName, "PNG"))
+                error = "Cannot write " + fileName;
+        }
+
+        QMutexLocker locker(&mutex);
+        if(error.isEmpty())
+            written++;
+        else
+            errors->append(error);
+    });
+    return written;
+}
@@ -0,0 +1,81 @@
+#ifndef MASKRASTERIZER_H
+#define MASKRASTERIZER_H
+
+#include "annotationfile.h"
+
+#include <QHash>
+#include <QImage>
+#include <QPolygonF>
+#include <QSize>
+#include <QStringList>
+
+/*!
+ * \brief MASK_MAX_CLASSES is the largest number of classes of a mask, the class IDs are stored in 8 bit pixels and 0 is the background
+ */
+#define MASK_MAX_CLASSES 255
+
+/*!
+ * \brief The MaskRasterizer class fills the shapes of annotation files into class ID masks at the original image resolution, for segmentation training
+ *
+ * The shapes are stored in scene coordinates (the image scaled to fit the scene), they are scaled back to the image size and
+ * filled without anti-aliasing: a pixel belongs to a shape when its center is inside it (even-odd rule). Later shapes are drawn
+ * over earlier ones, pre-labels that were not accepted and lines are left out.
+ */
+class MaskRasterizer
+{
+public:
+    /*!
+     * \brief MaskRasterizer constructor numbers the classes
+     * \param classNames are the classes, the first one gets ID 1
+     */
+    MaskRasterizer(const QStringList &classNames);
+    /*!
+     * \brief classId method gets the ID of a class
+     * \param name is the class name
+     * \return returns the ID, 0 for an unknown class
+     */
+    int classId(const QString &name) const;
+    /*!
+     * \brief rasterize method makes the mask of an image
+     * \param shapes are the shapes of the image in scene coordinates
+     * \param imageSize is the original size of the image, the size of the mask
+     * \return returns an 8 bit mask, 0 where there is no shape
+     */
+    QImage rasterize(const QVector<AnnotationShape> &shapes, const QSize &imageSize) const;
+    /*!
+     * \brief exportMasks method writes the masks of images as png files named after the image files with their suffix (a.jpg gives a.jpg.png), the images are not decoded (only their size is read) and are processed in parallel
+     * \param imagePaths are the images
+     * \param annotationPaths are their annotation files, in the same order
+     * \param outputFolder is the folder the masks are written to
+     * \param errors receives a message per image that could not be done
+     * \return returns the number of masks written
+     */
+    int exportMasks(const QStringList &imagePaths, const QStringList &annotationPaths, const QString &outputFolder, QStringList *errors) const;
+    /*!
+     * \brief outline method gets the outline of a shape, a rotated rectangle is turned around its center
+     * \param shape is the shape
+     * \return returns the outline in scene coordinates, empty for a line or an incomplete shape
+     */
+    static QPolygonF outline(const AnnotationShape &shape);
+    /*!
+     * \brief fillPolygon method sets the pixels whose center is inside a polygon (even-odd rule) with a scanline fill
+     * \param mask is an 8 bit image
+     * \param polygon is the polygon in pixel coordinates
+     * \param value is the value written
+     */
+    static void fillPolygon(QImage *mask, const QPolygonF &polygon, quint8 value);
+    /*!
+     * \brief sceneSize method gets the size an image is displayed at on the scene (scaled to fit keeping the aspect ratio)
+     * \param imageSize is the original size
+     * \return returns the displayed size
+     */
+    static QSize sceneSize(const QSize &imageSize);
+
+private:
+    /*!
+     * \brief ids maps a class name to its ID
+     */
+    QHash<QString, int> ids;
+};
+
+#endif // MASKRASTERIZER_H
@@ -0,0 +1,75 @@
+#include "memorystats.h"
+
+#include <QJsonArray>
+#include <QTextStream>
+
+void MemoryStats::add(const QString &subsystem, qint64 bytes, int items, qint64 budget){
+    entries.append(MemoryUsage{subsystem, bytes, items, budget});
+}
+
+QVector<MemoryUsage> MemoryStats::usage() const{
+    return entries;
+}
+
+qint64 MemoryStats::total() const{
+    qint64 bytes = 0;
+    for(const MemoryUsage &entry : entries)
+        bytes += entry.bytes;
+    return bytes;
+}
+
+QString MemoryStats::report() const{
+
+    QString text;
+    QTextStream out(&text);
+    for(const MemoryUsage &entry : entries){
+        out << entry.subsystem << ": " << formatBytes(entry.bytes) << " (" << entry.items << " items";
+        if(entry.budget > 0)
+            out << ", " << (100 * entry.bytes / entry.budget) << "% of " << formatBytes(entry.budget);
+        out << ")\n";
+    }
+    out << "Total: " << formatBytes(total()) << "\n";
+    return text;
+}
+
+QJsonObject MemoryStats::toJson() const{
+
+    QJsonArray subsystems;
+    for(const MemoryUsage &entry : entries){
+        QJsonObject item;
+        item.insert("subsystem", entry.subsystem);
+        item.insert("bytes", double(entry.bytes));
+        item.insert("items", entry.items);
+        if(entry.budget > 0)
+            item.insert("budget", double(entry.budget));
+        subsystems.append(item);
+    }
+
+    QJsonObject result;
+    result.insert("subsystems", subsystems);
+    result.insert("total_bytes", double(total()));
+    return result;
+}
+
+qint64 MemoryStats::stringBytes(const QString &text){
+    return sizeof(QString) + (text.isEmpty() ? 0 : text.capacity() * qint64(sizeof(QChar)));
+}
+
+qint64 MemoryStats::itemBytes(const Image &image){
+    //the name and path strings plus the content hash, the date and size are part of the object
+    return sizeof(Image) + stringBytes(image.getName()) + stringBytes(image.getPath()) + image.getHash().size();
+}
+
+qint64 MemoryStats::itemBytes(const IClass &theClass){
+    return sizeof(IClass) + stringBytes(theClass.getKey());
+}
+
+QString MemoryStats::formatBytes(qint64 bytes){
+    if(bytes < 1024)
+        return QString::number(bytes) + " B";
+    if(bytes < 1024 * 1024)
+        return QString::number(bytes / 1024.0, 'f', 1) + " KB";
+    if(bytes < qint64(1024) * 1024 * 1024)
+        return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MB";
+    return QString::number(bytes / (1024.0 * 1024.0 * 1024.0), 'f', 2) + " GB";
+}
@@ -0,0 +1,103 @@
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include "image.h"
+#include "iclass.h"
+
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+
+/*!
+ * \brief The MemoryUsage struct is the memory taken by one subsystem
+ */
+struct MemoryUsage
+{
+    /*!
+     * \brief subsystem is the name of the subsystem
+     */
+    QString subsystem;
+    /*!
+     * \brief bytes is the estimated memory used
+     */
+    qint64 bytes;
+    /*!
+     * \brief items is the number of items held (images, classes, shapes...)
+     */
+    int items;
+    /*!
+     * \brief budget is the most the subsystem keeps before evicting, 0 when it has no budget
+     */
+    qint64 budget;
+};
+
+/*!
+ * \brief The MemoryStats class collects the memory used by each subsystem into a report, and estimates the size of the items they hold
+ *
+ * The estimates count the objects and the characters of their strings, not the allocator overhead, so they are a lower bound
+ * meant for comparing sessions and setting budgets.
+ */
+class MemoryStats
+{
+public:
+    /*!
+     * \brief add method adds a subsystem to the report
+     * \param subsystem is the name of the subsystem
+     * \param bytes is the estimated memory used
+     * \param items is the number of items held
+     * \param budget is the memory budget, 0 when it has none
+     */
+    void add(const QString &subsystem, qint64 bytes, int items, qint64 budget = 0);
+    /*!
+     * \brief usage method gets the subsystems added so far
+     * \return returns the usage of each subsystem
+     */
+    QVector<MemoryUsage> usage() const;
+    /*!
+     * \brief total method gets the memory used by all the subsystems
+     * \return returns the number of bytes
+     */
+    qint64 total() const;
+    /*!
+     * \brief report method formats the usage as a text table, one line per subsystem
+     * \return returns the report
+     */
+    QString report() const;
+    /*!
+     * \brief toJson method gets the usage as json (for logging on unattended installations)
+     * \return returns the json object
+     */
+    QJsonObject toJson() const;
+    /*!
+     * \brief stringBytes method estimates the memory of a string
+     * \param text is the string
+     * \return returns the number of bytes
+     */
+    static qint64 stringBytes(const QString &text);
+    /*!
+     * \brief itemBytes method estimates the memory of an image
+     * \param image is the image
+     * \return returns the number of bytes
+     */
+    static qint64 itemBytes(const Image &image);
+    /*!
+     * \brief itemBytes method estimates the memory of a class
+     * \param theClass is the class
+     * \return returns the number of bytes
+     */
+    static qint64 itemBytes(const IClass &theClass);
+    /*!
+     * \brief formatBytes method formats a number of bytes for display (B, KB, MB or GB)
+     * \param bytes is the number of bytes
+     * \return returns the text
+     */
+    static QString formatBytes(qint64 bytes);
+
+private:
+    /*!
+     * \brief entries are the subsystems added
+     */
+    QVector<MemoryUsage> entries;
+};
+
+#endif // MEMORYSTATS_H
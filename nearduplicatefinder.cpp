@@ -0,0 +1,148 @@
+#include "nearduplicatefinder.h"
+#include "perceptualhash.h"
+#include "hammingindex.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QPair>
+
+#include <functional>
+
+NearDuplicateFinder::NearDuplicateFinder(CatalogCache *theCache) : cache(theCache)
+{
+}
+
+CatalogEntry NearDuplicateFinder::hashEntry(const CatalogEntry &entry){
+
+    TRACE_SCOPE("perceptual hash", "duplicates");
+
+    CatalogEntry result = entry;
+    bool ok;
+    result.perceptualHash = PerceptualHash::hashFile(entry.path, &ok);
+    result.hasPerceptualHash = ok;
+    return result;
+}
+
+/*!
+ * \brief findRoot follows the union-find parents to the root of a group (with path halving)
+ */
+static int findRoot(QVector<int> &parent, int i){
+    while(parent[i] != i){
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/*!
+ * \brief unite merges two union-find groups, the smaller index becomes the root
+ */
+static void unite(QVector<int> &parent, int a, int b){
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if(a < b)
+        parent[b] = a;
+    else if(b < a)
+        parent[a] = b;
+}
+
+QVector<int> NearDuplicateFinder::findGroups(const QStringList &paths, int radius){
+
+    TRACE_SCOPE("find near-duplicates", "duplicates");
+
+    QVector<CatalogEntry> entries(paths.size());
+    QVector<CatalogEntry> missing;
+    QVector<int> missingAt;
+
+    for(int i = 0; i < paths.size(); i++){
+        QFileInfo info(paths[i]);
+        CatalogEntry &entry = entries[i];
+        entry.path = paths[i];
+        entry.size = info.size();
+        entry.modified = info.lastModified().toMSecsSinceEpoch();
+
+        if(!cache->lookup(&entry) || !entry.hasPerceptualHash){
+            missing.append(entry);
+            missingAt.append(i);
+        }
+    }
+
+    if(!missing.isEmpty()){
+        QVector<CatalogEntry> computed(missing.size());
+        TaskScheduler::instance()->parallelFor(missing.size(), [&](int i) {
+            computed[i] = hashEntry(missing[i]);
+        });
+        for(int i = 0; i < computed.size(); i++){
+            entries[missingAt[i]] = computed[i];
+            if(computed[i].hasPerceptualHash)
+                cache->insert(computed[i]);
+        }
+    }
+
+    //Identical hashes (e.g. repeated frames) are grouped straight away and indexed once
+    QVector<int> parent(paths.size());
+    QVector<quint64> unique;
+    QVector<int> uniqueOwner;
+    QHash<quint64, int> firstWithHash;
+
+    for(int i = 0; i < entries.size(); i++){
+        parent[i] = i;
+        if(!entries[i].hasPerceptualHash)
+            continue;
+
+        QHash<quint64, int>::const_iterator it = firstWithHash.constFind(entries[i].perceptualHash);
+        if(it != firstWithHash.constEnd()){
+            parent[i] = it.value();
+        }else{
+            firstWithHash.insert(entries[i].perceptualHash, i);
+            unique.append(entries[i].perceptualHash);
+            uniqueOwner.append(i);
+        }
+    }
+
+    if(radius > 0 && unique.size() > 1){
+        HammingIndex index;
+        index.build(unique);
+
+        //Search the index in parallel, one block of queries per task, each pair reported once
+        int blockCount = qMax(1, TaskScheduler::instance()->threadCount() * 4);
+        int blockSize = (unique.size() + blockCount - 1) / blockCount;
+        QVector<int> blocks;
+        for(int start = 0; start < unique.size(); start += blockSize)
+            blocks.append(start);
+
+        std::function<QVector<QPair<int, int> >(int)> searchBlock = [&](int start) {
+            TRACE_SCOPE("search hash block", "duplicates");
+            QVector<QPair<int, int> > pairs;
+            QVector<int> found;
+            int end = qMin(start + blockSize, unique.size());
+            for(int u = start; u < end; u++){
+                index.query(unique[u], radius, &found);
+                for(int v : found){
+                    if(v > u)
+                        pairs.append(qMakePair(u, v));
+                }
+            }
+            return pairs;
+        };
+
+        QVector<QVector<QPair<int, int> > > results(blocks.size());
+        TaskScheduler::instance()->parallelFor(blocks.size(), [&](int b) {
+            results[b] = searchBlock(blocks[b]);
+        });
+
+        for(const QVector<QPair<int, int> > &pairs : results){
+            for(const QPair<int, int> &p : pairs)
+                unite(parent, uniqueOwner[p.first], uniqueOwner[p.second]);
+        }
+    }
+
+    QVector<int> groups(paths.size());
+    for(int i = 0; i < paths.size(); i++)
+        groups[i] = findRoot(parent, i);
+
+    return groups;
+}
@@ -0,0 +1,41 @@
+#ifndef NEARDUPLICATEFINDER_H
+#define NEARDUPLICATEFINDER_H
+
+#include "catalogcache.h"
+
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief The NearDuplicateFinder class groups images that look the same (resized, recompressed or consecutive identical frames) by comparing their perceptual hashes
+ */
+class NearDuplicateFinder
+{
+public:
+    /*!
+     * \brief NearDuplicateFinder constructor takes the cache used to keep the perceptual hashes between sessions
+     * \param theCache is the catalog cache (not owned)
+     */
+    NearDuplicateFinder(CatalogCache *theCache);
+    /*!
+     * \brief findGroups method groups the images whose hashes are within radius bits of each other (directly or through other images of the group). Hashing and searching run on worker threads
+     * \param paths are the image paths
+     * \param radius is the largest number of differing bits between near-duplicates (0 to 11)
+     * \return returns for each path the index of the first path of its group (its own index when it has no near-duplicate or can't be decoded)
+     */
+    QVector<int> findGroups(const QStringList &paths, int radius);
+
+private:
+    /*!
+     * \brief hashEntry method computes the perceptual hash of an entry (runs on a worker thread)
+     */
+    static CatalogEntry hashEntry(const CatalogEntry &entry);
+
+private:
+    /*!
+     * \brief cache is the catalog cache used and updated by findGroups
+     */
+    CatalogCache *cache;
+};
+
+#endif // NEARDUPLICATEFINDER_H
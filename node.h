@@ -5,6 +5,9 @@
 template <typename T>
 class LinkedList;
 
+template <typename T>
+class NodePool;
+
 /*!
  * \brief The node class is a blue-print for nodes of linkedlist
  */
@@ -12,6 +15,7 @@ template <typename T>
 class node{
 private:
     friend class LinkedList<T>;
+    friend class NodePool<T>;
     /*!
      * \brief data hold the image or class object since it's of generic type T
      */
@@ -0,0 +1,115 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include "node.h"
+
+#include <QVector>
+
+/*!
+ * \brief NODE_POOL_BLOCK is the number of nodes allocated at once
+ */
+#define NODE_POOL_BLOCK 256
+
+/*!
+ * \brief The NodePool class allocates the nodes of a linkedlist in blocks and reuses the released ones, the blocks are freed together when the pool is destroyed
+ */
+template <typename T>
+class NodePool{
+public:
+    /*!
+     * \brief NodePool constructor creates an empty pool
+     */
+    NodePool();
+    /*!
+      *\brief NodePool destructor frees all the blocks, the nodes still in use included
+      */
+    ~NodePool();
+    /*!
+     * \brief allocate method gets an unused node
+     * \param value is the data stored in the node
+     * \return returns the node, its next pointer is null
+     */
+    node<T> *allocate(const T &value);
+    /*!
+     * \brief release method gives a node back to the pool, its data is cleared
+     * \param n is the node
+     */
+    void release(node<T> *n);
+    /*!
+     * \brief count method gets the number of nodes in use
+     * \return returns the number of nodes
+     */
+    int count() const;
+    /*!
+     * \brief bytesReserved method gets the memory taken by the blocks (nodes only, not what their data points to)
+     * \return returns the number of bytes
+     */
+    qint64 bytesReserved() const;
+
+private:
+    Q_DISABLE_COPY(NodePool)
+    /*!
+     * \brief blocks are the allocated blocks
+     */
+    QVector<node<T>*> blocks;
+    /*!
+     * \brief freeList is the first unused node, unused nodes are chained through next
+     */
+    node<T> *freeList;
+    /*!
+     * \brief used is the number of nodes in use
+     */
+    int used;
+};
+
+
+template <typename T>
+NodePool<T>::NodePool() : freeList(nullptr), used(0)
+{
+}
+
+template <typename T>
+NodePool<T>::~NodePool(){
+    for(node<T> *block : blocks)
+        delete[] block;
+}
+
+template <typename T>
+node<T> *NodePool<T>::allocate(const T &value){
+
+    if(freeList == nullptr){
+        node<T> *block = new node<T>[NODE_POOL_BLOCK];
+        for(int i = 0; i < NODE_POOL_BLOCK - 1; i++)
+            block[i].next = &block[i + 1];
+        block[NODE_POOL_BLOCK - 1].next = nullptr;
+        blocks.append(block);
+        freeList = block;
+    }
+
+    node<T> *n = freeList;
+    freeList = n->next;
+    n->data = value;
+    n->next = nullptr;
+    used++;
+    return n;
+}
+
+template <typename T>
+void NodePool<T>::release(node<T> *n){
+    n->data = T(); //drop the strings the data holds now rather than when the node is reused
+    n->next = freeList;
+    freeList = n;
+    used--;
+}
+
+template <typename T>
+int NodePool<T>::count() const{
+    return used;
+}
+
+template <typename T>
+qint64 NodePool<T>::bytesReserved() const{
+    return qint64(blocks.size()) * NODE_POOL_BLOCK * sizeof(node<T>);
+}
+
+#endif // NODEPOOL_H
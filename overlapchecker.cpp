@@ -0,0 +1,118 @@
+#include "overlapchecker.h"
+#include "geometry.h"
+#include "maskrasterizer.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QtMath>
+
+#include <algorithm>
+
+QString OverlapChecker::kindName(OverlapIssue::Kind kind){
+    return kind == OverlapIssue::Kind::Duplicate ? "duplicate" : "conflict";
+}
+
+QVector<OverlapIssue> OverlapChecker::check(const QVector<AnnotationShape> &shapes, double threshold){
+
+    TRACE_SCOPE("check overlaps", "validation");
+    QVector<OverlapIssue> issues;
+
+    //the outlines and boxes of the checked shapes, index is their position in shapes
+    QVector<int> index;
+    QVector<QPolygonF> outlines;
+    QVector<QRectF> boxes;
+    QVector<double> areas;
+    for(int i = 0; i < shapes.size(); i++){
+        if(shapes[i].confidence >= 0)
+            continue;
+        QPolygonF outline = MaskRasterizer::outline(shapes[i]);
+        if(outline.isEmpty())
+            continue;
+        index.append(i);
+        outlines.append(outline);
+    }
+    boxes = Geometry::boundingRects(outlines);
+    for(const QPolygonF &outline : outlines)
+        areas.append(Geometry::area(outline));
+
+    //Uniform grid, a cell key packs the column and the row
+    auto key = [](int column, int row) { return (quint64(quint32(column)) << 32) | quint32(row); };
+    QHash<quint64, QVector<int> > grid;
+    for(int k = 0; k < boxes.size(); k++){
+        const QRectF &box = boxes[k];
+        for(int row = qFloor(box.top() / OVERLAP_GRID_CELL); row <= qFloor(box.bottom() / OVERLAP_GRID_CELL); row++){
+            for(int column = qFloor(box.left() / OVERLAP_GRID_CELL); column <= qFloor(box.right() / OVERLAP_GRID_CELL); column++)
+                grid[key(column, row)].append(k);
+        }
+    }
+
+    for(auto cell = grid.constBegin(); cell != grid.constEnd(); ++cell){
+        const QVector<int> &members = cell.value();
+        int column = int(cell.key() >> 32);
+        int row = int(quint32(cell.key()));
+        for(int m = 0; m < members.size(); m++){
+            for(int n = m + 1; n < members.size(); n++){
+                int a = qMin(members[m], members[n]);
+                int b = qMax(members[m], members[n]);
+                QRectF overlap = boxes[a].intersected(boxes[b]);
+                if(overlap.isEmpty())
+                    continue;
+                if(qFloor(overlap.left() / OVERLAP_GRID_CELL) != column || qFloor(overlap.top() / OVERLAP_GRID_CELL) != row)
+                    continue; //compared in the cell of the overlap corner
+
+                //the boxes bound the intersection over union from above
+                double boxArea = overlap.width() * overlap.height();
+                if(qMin(boxArea, qMin(areas[a], areas[b])) < threshold * qMax(areas[a], areas[b]))
+                    continue;
+
+                const AnnotationShape &first = shapes[index[a]];
+                const AnnotationShape &second = shapes[index[b]];
+                double iou = first.type == SHAPE_RECT && second.type == SHAPE_RECT
+                        ? Geometry::iou(QRectF(first.coordinates[0], first.coordinates[1], first.coordinates[2], first.coordinates[3]), first.rotation,
+                                        QRectF(second.coordinates[0], second.coordinates[1], second.coordinates[2], second.coordinates[3]), second.rotation)
+                        : Geometry::iou(outlines[a], outlines[b]);
+                if(iou < threshold)
+                    continue;
+
+                OverlapIssue issue;
+                issue.kind = first.object == second.object ? OverlapIssue::Kind::Duplicate : OverlapIssue::Kind::Conflict;
+                issue.first = index[a];
+                issue.second = index[b];
+                issue.iou = iou;
+                issue.region = overlap;
+                issues.append(issue);
+            }
+        }
+    }
+
+    std::sort(issues.begin(), issues.end(), [](const OverlapIssue &l, const OverlapIssue &r) {
+        return l.first != r.first ? l.first < r.first : l.second < r.second;
+    });
+    return issues;
+}
+
+QVector<OverlapFileReport> OverlapChecker::checkFiles(const QStringList &fileNames, double threshold, QStringList *errors){
+
+    TRACE_SCOPE("check overlaps of files", "validation");
+    QVector<OverlapFileReport> reports(fileNames.size());
+    QVector<bool> read(fileNames.size(), false);
+    OverlapFileReport *out = reports.data(); //each task writes its own entry, detached before the tasks start
+    bool *ok = read.data();
+    TaskScheduler::instance()->parallelFor(fileNames.size(), [&](int i) {
+        out[i].fileName = fileNames[i];
+        ok[i] = AnnotationFile::read(fileNames[i], &out[i].shapes);
+        if(ok[i])
+            out[i].issues = check(out[i].shapes, threshold);
+    });
+
+    QVector<OverlapFileReport> found;
+    for(int i = 0; i < reports.size(); i++){
+        if(!read[i])
+            errors->append("Cannot read " + fileNames[i]);
+        else if(!reports[i].issues.isEmpty())
+            found.append(reports[i]);
+    }
+    return found;
+}
@@ -0,0 +1,102 @@
+#ifndef OVERLAPCHECKER_H
+#define OVERLAPCHECKER_H
+
+#include "annotationfile.h"
+
+#include <QPolygonF>
+#include <QRectF>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief OVERLAP_IOU_THRESHOLD is the default intersection over union above which two shapes are reported
+ */
+#define OVERLAP_IOU_THRESHOLD 0.5
+/*!
+ * \brief OVERLAP_GRID_CELL is the side of the cells of the spatial index in scene pixels
+ */
+#define OVERLAP_GRID_CELL 64
+
+/*!
+ * \brief The OverlapIssue struct is a pair of shapes covering mostly the same area
+ */
+struct OverlapIssue
+{
+    /*!
+     * \brief The Kind enum tells whether the shapes have the same class (drawn twice) or not (conflicting classes)
+     */
+    enum class Kind { Duplicate, Conflict };
+
+    /*!
+     * \brief kind is whether the shapes have the same class
+     */
+    Kind kind;
+    /*!
+     * \brief first is the index of the first shape in the checked list
+     */
+    int first;
+    /*!
+     * \brief second is the index of the second shape, always after the first one
+     */
+    int second;
+    /*!
+     * \brief iou is the intersection over union of the two shapes
+     */
+    double iou;
+    /*!
+     * \brief region is where the bounding boxes of the two shapes overlap, for showing the issue
+     */
+    QRectF region;
+};
+
+/*!
+ * \brief The OverlapFileReport struct is the issues found in one annotation file
+ */
+struct OverlapFileReport
+{
+    /*!
+     * \brief fileName is the annotation file
+     */
+    QString fileName;
+    /*!
+     * \brief shapes are the shapes of the file, the issues index them
+     */
+    QVector<AnnotationShape> shapes;
+    /*!
+     * \brief issues are the pairs found
+     */
+    QVector<OverlapIssue> issues;
+};
+
+/*!
+ * \brief The OverlapChecker class finds the shapes of an image drawn twice or drawn with different classes over the same object
+ *
+ * The shapes are put in a uniform grid by their bounding boxes, only the shapes sharing a cell are compared and a pair is compared
+ * in the single cell holding the top left corner of the overlap of their boxes, so no pair is tested twice. Lines and pre-labels
+ * that were not accepted are not checked.
+ */
+class OverlapChecker
+{
+public:
+    /*!
+     * \brief check method finds the pairs of shapes above an intersection over union
+     * \param shapes are the shapes of one image in scene coordinates
+     * \param threshold is the smallest intersection over union reported
+     * \return returns the pairs sorted by the first shape then the second one
+     */
+    static QVector<OverlapIssue> check(const QVector<AnnotationShape> &shapes, double threshold = OVERLAP_IOU_THRESHOLD);
+    /*!
+     * \brief checkFiles method checks annotation files, in parallel
+     * \param fileNames are the json files
+     * \param threshold is the smallest intersection over union reported
+     * \param errors receives a message per file that could not be read
+     * \return returns the files with at least one issue, in the order of fileNames
+     */
+    static QVector<OverlapFileReport> checkFiles(const QStringList &fileNames, double threshold, QStringList *errors);
+    /*!
+     * \brief kindName method gets the name of an issue kind ("duplicate" or "conflict")
+     */
+    static QString kindName(OverlapIssue::Kind kind);
+};
+
+#endif // OVERLAPCHECKER_H
@@ -0,0 +1,77 @@
+#include "perceptualhash.h"
+
+#include <QImage>
+#include <QImageReader>
+#include <QVector>
+
+#define DHASH_WIDTH     9
+#define DHASH_HEIGHT    8
+#define DHASH_DECODE    8   //decode at 8 times the hash size, the box average does the rest
+
+quint64 PerceptualHash::hashFile(const QString &path, bool *ok){
+
+    QImageReader reader(path);
+    QSize size = reader.size();
+    if(size.isValid() && size.width() > DHASH_WIDTH * DHASH_DECODE && size.height() > DHASH_HEIGHT * DHASH_DECODE){
+        //JPEG scales while decoding, so a large photo is never decoded at full resolution
+        reader.setScaledSize(QSize(DHASH_WIDTH * DHASH_DECODE, DHASH_HEIGHT * DHASH_DECODE));
+    }
+
+    QImage image = reader.read();
+    if(image.isNull() || image.width() < DHASH_WIDTH || image.height() < DHASH_HEIGHT){
+        *ok = false;
+        return 0;
+    }
+
+    image = image.convertToFormat(QImage::Format_Grayscale8);
+    *ok = true;
+    return hashGray(image.constBits(), image.width(), image.height(), image.bytesPerLine());
+}
+
+void PerceptualHash::boxDownscale(const uchar *src, int width, int height, int stride, uchar *dst, int dstWidth, int dstHeight){
+
+    QVector<quint32> columnSums(dstWidth);
+    QVector<int> x0(dstWidth + 1);
+    for(int dx = 0; dx <= dstWidth; dx++)
+        x0[dx] = dx * width / dstWidth;
+
+    for(int dy = 0; dy < dstHeight; dy++){
+        int y0 = dy * height / dstHeight;
+        int y1 = (dy + 1) * height / dstHeight;
+
+        columnSums.fill(0);
+        for(int y = y0; y < y1; y++){
+            const uchar *row = src + qint64(y) * stride;
+            for(int dx = 0; dx < dstWidth; dx++){
+                quint32 sum = 0;
+                for(int x = x0[dx]; x < x0[dx + 1]; x++) //contiguous run, vectorised by the compiler
+                    sum += row[x];
+                columnSums[dx] += sum;
+            }
+        }
+
+        for(int dx = 0; dx < dstWidth; dx++){
+            quint32 area = quint32((x0[dx + 1] - x0[dx]) * (y1 - y0));
+            dst[dy * dstWidth + dx] = uchar((columnSums[dx] + area / 2) / area);
+        }
+    }
+}
+
+quint64 PerceptualHash::hashGray(const uchar *gray, int width, int height, int stride){
+
+    uchar cells[DHASH_WIDTH * DHASH_HEIGHT];
+    boxDownscale(gray, width, height, stride, cells, DHASH_WIDTH, DHASH_HEIGHT);
+
+    quint64 hash = 0;
+    for(int y = 0; y < DHASH_HEIGHT; y++){
+        const uchar *row = cells + y * DHASH_WIDTH;
+        for(int x = 0; x < DHASH_WIDTH - 1; x++){
+            hash = (hash << 1) | (row[x] < row[x + 1] ? 1 : 0);
+        }
+    }
+    return hash;
+}
+
+int PerceptualHash::distance(quint64 a, quint64 b){
+    return qPopulationCount(a ^ b);
+}
@@ -0,0 +1,46 @@
+#ifndef PERCEPTUALHASH_H
+#define PERCEPTUALHASH_H
+
+#include <QString>
+#include <QtGlobal>
+
+/*!
+ * \brief The PerceptualHash class computes 64 bit difference hashes (dHash) of images. Images that look the same get hashes a few bits apart even after resizing or recompression
+ */
+class PerceptualHash
+{
+public:
+    /*!
+     * \brief hashFile method decodes an image at a reduced size and hashes it (safe to call from worker threads)
+     * \param path is the image path
+     * \param ok is set to false if the image can't be decoded
+     * \return returns the hash
+     */
+    static quint64 hashFile(const QString &path, bool *ok);
+    /*!
+     * \brief hashGray method hashes a grayscale image by averaging it down to 9x8 and comparing horizontally adjacent cells
+     * \param gray points to the first pixel
+     * \param width is the image width (at least 9)
+     * \param height is the image height (at least 8)
+     * \param stride is the number of bytes between rows
+     * \return returns the hash
+     */
+    static quint64 hashGray(const uchar *gray, int width, int height, int stride);
+    /*!
+     * \brief boxDownscale method shrinks a grayscale image by averaging the source pixels covered by each destination pixel
+     * \param src points to the first source pixel
+     * \param width is the source width
+     * \param height is the source height
+     * \param stride is the number of bytes between source rows
+     * \param dst receives dstWidth * dstHeight pixels
+     * \param dstWidth is the destination width (at most width)
+     * \param dstHeight is the destination height (at most height)
+     */
+    static void boxDownscale(const uchar *src, int width, int height, int stride, uchar *dst, int dstWidth, int dstHeight);
+    /*!
+     * \brief distance method gets the number of differing bits between two hashes
+     */
+    static int distance(quint64 a, quint64 b);
+};
+
+#endif // PERCEPTUALHASH_H
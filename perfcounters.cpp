@@ -0,0 +1,8 @@
+#include "perfcounters.h"
+
+std::atomic<qint64> PerfCounters::imageCacheBytes(0);
+std::atomic<qint64> PerfCounters::imageCacheLimit(0);
+std::atomic<int> PerfCounters::imageCacheCount(0);
+std::atomic<qint64> PerfCounters::lastImageLoadNs(0);
+std::atomic<qint64> PerfCounters::lastLoadNs(0);
+std::atomic<qint64> PerfCounters::lastSaveNs(0);
@@ -0,0 +1,40 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+/*!
+ * \brief The PerfCounters class holds the counters the subsystems update as they work (relaxed atomics, so updating them is as cheap as a plain store) and the performance overlay reads
+ */
+class PerfCounters
+{
+public:
+    /*!
+     * \brief imageCacheBytes is the memory used by the decoded images in the image cache
+     */
+    static std::atomic<qint64> imageCacheBytes;
+    /*!
+     * \brief imageCacheLimit is the memory budget of the image cache
+     */
+    static std::atomic<qint64> imageCacheLimit;
+    /*!
+     * \brief imageCacheCount is the number of decoded images in the image cache
+     */
+    static std::atomic<int> imageCacheCount;
+    /*!
+     * \brief lastImageLoadNs is the time taken to decode and display the last opened image
+     */
+    static std::atomic<qint64> lastImageLoadNs;
+    /*!
+     * \brief lastLoadNs is the time taken to load the last annotation file onto the scene
+     */
+    static std::atomic<qint64> lastLoadNs;
+    /*!
+     * \brief lastSaveNs is the time taken by the last save
+     */
+    static std::atomic<qint64> lastSaveNs;
+};
+
+#endif // PERFCOUNTERS_H
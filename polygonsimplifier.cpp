@@ -0,0 +1,179 @@
+#include "polygonsimplifier.h"
+
+#include <QPair>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include <cmath>
+
+QPolygonF PolygonSimplifier::removeCollinear(const QPolygonF &polygon){
+
+    int n = polygon.size();
+    if(n < 4)
+        return polygon;
+
+    QPolygonF result;
+    for(int i = 0; i < n; i++){
+        const QPointF &prev = polygon[(i + n - 1) % n];
+        const QPointF &cur = polygon[i];
+        const QPointF &next = polygon[(i + 1) % n];
+        double cross = (cur.x() - prev.x()) * (next.y() - cur.y()) - (cur.y() - prev.y()) * (next.x() - cur.x());
+        if(std::fabs(cross) > 1e-9)
+            result.append(cur);
+    }
+    return result.size() >= 3 ? result : polygon;
+}
+
+double PolygonSimplifier::distanceToSegment(const QPointF &p, const QPointF &a, const QPointF &b){
+
+    double dx = b.x() - a.x();
+    double dy = b.y() - a.y();
+    double lengthSq = dx * dx + dy * dy;
+    double t = 0;
+    if(lengthSq > 0)
+        t = qBound(0.0, ((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / lengthSq, 1.0);
+
+    double ex = a.x() + t * dx - p.x();
+    double ey = a.y() + t * dy - p.y();
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+void PolygonSimplifier::simplifyRange(const QPolygonF &polygon, int first, int last, double epsilon, QVector<bool> *keep){
+
+    int n = polygon.size();
+
+    //Iterative, a traced outline can have thousands of vertices
+    QVector<QPair<int, int> > ranges;
+    ranges.append(qMakePair(first, last));
+
+    while(!ranges.isEmpty()){
+        QPair<int, int> range = ranges.takeLast();
+        const QPointF &a = polygon[range.first % n];
+        const QPointF &b = polygon[range.second % n];
+
+        double farthest = -1;
+        int index = -1;
+        for(int i = range.first + 1; i < range.second; i++){
+            double d = distanceToSegment(polygon[i % n], a, b);
+            if(d > farthest){
+                farthest = d;
+                index = i;
+            }
+        }
+
+        if(index < 0 || farthest <= epsilon)
+            continue;
+
+        (*keep)[index % n] = true;
+        ranges.append(qMakePair(range.first, index));
+        ranges.append(qMakePair(index, range.second));
+    }
+}
+
+QPolygonF PolygonSimplifier::douglasPeucker(const QPolygonF &polygon, double epsilon){
+
+    int n = polygon.size();
+    if(n <= 3)
+        return polygon;
+
+    //A closed polygon is split at the vertex farthest from the first one, each half is simplified as an open line
+    int opposite = 1;
+    double farthest = -1;
+    for(int i = 1; i < n; i++){
+        double dx = polygon[i].x() - polygon[0].x();
+        double dy = polygon[i].y() - polygon[0].y();
+        double d = dx * dx + dy * dy;
+        if(d > farthest){
+            farthest = d;
+            opposite = i;
+        }
+    }
+
+    QVector<bool> keep(n, false);
+    keep[0] = true;
+    keep[opposite] = true;
+    simplifyRange(polygon, 0, opposite, epsilon, &keep);
+    simplifyRange(polygon, opposite, n, epsilon, &keep);
+
+    QPolygonF result;
+    for(int i = 0; i < n; i++){
+        if(keep[i])
+            result.append(polygon[i]);
+    }
+    return result.size() >= 3 ? result : polygon;
+}
+
+QPolygonF PolygonSimplifier::simplifyLine(const QPolygonF &line, double epsilon){
+
+    int n = line.size();
+    if(n <= 2)
+        return line;
+
+    QVector<bool> keep(n, false);
+    keep[0] = true;
+    keep[n - 1] = true;
+    simplifyRange(line, 0, n - 1, epsilon, &keep);
+
+    QPolygonF result;
+    for(int i = 0; i < n; i++){
+        if(keep[i])
+            result.append(line[i]);
+    }
+    return result;
+}
+
+double PolygonSimplifier::triangleArea(const QPointF &a, const QPointF &b, const QPointF &c){
+    return std::fabs((b.x() - a.x()) * (c.y() - a.y()) - (c.x() - a.x()) * (b.y() - a.y())) / 2;
+}
+
+QPolygonF PolygonSimplifier::visvalingam(const QPolygonF &polygon, double minArea){
+
+    int n = polygon.size();
+    if(n <= 3)
+        return polygon;
+
+    //The vertices form a circular linked list, the heap holds (area, vertex) and entries left behind by an update are skipped
+    QVector<int> prev(n), next(n);
+    QVector<double> area(n);
+    QVector<bool> removed(n, false);
+    typedef QPair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > heap;
+
+    for(int i = 0; i < n; i++){
+        prev[i] = (i + n - 1) % n;
+        next[i] = (i + 1) % n;
+        area[i] = triangleArea(polygon[prev[i]], polygon[i], polygon[next[i]]);
+        heap.push(qMakePair(area[i], i));
+    }
+
+    int remaining = n;
+    while(!heap.empty() && remaining > 3){
+        Entry top = heap.top();
+        heap.pop();
+        int i = top.second;
+        if(removed[i] || top.first != area[i])
+            continue;
+        if(top.first >= minArea)
+            break;
+
+        removed[i] = true;
+        remaining--;
+        next[prev[i]] = next[i];
+        prev[next[i]] = prev[i];
+
+        //a neighbour never gets a smaller area than the vertex just removed, so the removal order stays by area
+        for(int j : {prev[i], next[i]}){
+            area[j] = qMax(top.first, triangleArea(polygon[prev[j]], polygon[j], polygon[next[j]]));
+            heap.push(qMakePair(area[j], j));
+        }
+    }
+
+    QPolygonF result;
+    for(int i = 0; i < n; i++){
+        if(!removed[i])
+            result.append(polygon[i]);
+    }
+    return result;
+}
@@ -0,0 +1,56 @@
+#ifndef POLYGONSIMPLIFIER_H
+#define POLYGONSIMPLIFIER_H
+
+#include <QPolygonF>
+#include <QVector>
+
+/*!
+ * \brief The PolygonSimplifier class reduces the number of vertices of the polygons produced by the tracing tools while keeping their shape
+ */
+class PolygonSimplifier
+{
+public:
+    /*!
+     * \brief removeCollinear method drops the vertices lying on the straight line between their neighbours (closed polygon)
+     * \param polygon is the polygon
+     * \return returns the polygon without collinear vertices
+     */
+    static QPolygonF removeCollinear(const QPolygonF &polygon);
+    /*!
+     * \brief douglasPeucker method simplifies a closed polygon, every removed vertex is within epsilon of the result
+     * \param polygon is the polygon, the first vertex is not repeated at the end
+     * \param epsilon is the largest distance allowed between the polygon and the result
+     * \return returns the simplified polygon
+     */
+    static QPolygonF douglasPeucker(const QPolygonF &polygon, double epsilon);
+    /*!
+     * \brief simplifyLine method simplifies an open line with Douglas-Peucker, the first and last vertices are kept
+     * \param line is the line
+     * \param epsilon is the largest distance allowed between the line and the result
+     * \return returns the simplified line
+     */
+    static QPolygonF simplifyLine(const QPolygonF &line, double epsilon);
+    /*!
+     * \brief visvalingam method simplifies a closed polygon by removing the vertex making the smallest triangle with its neighbours until every triangle is at least minArea
+     * \param polygon is the polygon, the first vertex is not repeated at the end
+     * \param minArea is the smallest triangle area kept, in square pixels
+     * \return returns the simplified polygon, at least three vertices
+     */
+    static QPolygonF visvalingam(const QPolygonF &polygon, double minArea);
+
+private:
+    /*!
+     * \brief distanceToSegment method gets the distance between a point and the segment from a to b
+     */
+    static double distanceToSegment(const QPointF &p, const QPointF &a, const QPointF &b);
+    /*!
+     * \brief simplifyRange method marks the vertices to keep between first and last (indexes taken modulo the polygon size)
+     */
+    static void simplifyRange(const QPolygonF &polygon, int first, int last, double epsilon, QVector<bool> *keep);
+    /*!
+     * \brief triangleArea method gets the area of the triangle a, b, c
+     */
+    static double triangleArea(const QPointF &a, const QPointF &b, const QPointF &c);
+};
+
+#endif // POLYGONSIMPLIFIER_H
@@ -0,0 +1,65 @@
+#include "prefetcher.h"
+#include "taskscheduler.h"
+#include "trace.h"
+
+Prefetcher::Prefetcher(ImageCache *theCache, QObject *parent) : QObject(parent), imageCache(theCache)
+{
+}
+
+PrefetchResult Prefetcher::load(const QString &imagePath, const QString &annotationPath, const QSize &size){
+
+    TRACE_SCOPE("prefetch", "prefetch");
+
+    PrefetchResult result;
+    result.imagePath = imagePath;
+    result.image = ImageCache::decode(imagePath, size);
+    result.gradient = GradientMap::compute(result.image);
+    result.hasShapes = !annotationPath.isEmpty() && AnnotationFile::read(annotationPath, &result.shapes);
+    return result;
+}
+
+void Prefetcher::prefetch(const QString &imagePath, const QString &annotationPath, const QSize &size){
+
+    bool needImage = !imageCache->contains(imagePath, size);
+    bool needShapes = !annotationPath.isEmpty() && !(shapes.contains(imagePath) && shapes[imagePath].first == annotationPath);
+    if((!needImage && !needShapes) || pending.contains(imagePath))
+        return;
+
+    pending.insert(imagePath);
+
+    TaskScheduler::instance()->run<PrefetchResult>(TaskScheduler::Priority::Prefetch, CancellationToken(),
+                                                   [=]() { return load(imagePath, annotationPath, size); },
+                                                   this, [=](const PrefetchResult &result) {
+        finished(result, annotationPath, size);
+    });
+}
+
+void Prefetcher::finished(const PrefetchResult &result, const QString &annotationPath, const QSize &size){
+
+    pending.remove(result.imagePath);
+
+    if(!result.image.isNull() && !imageCache->contains(result.imagePath, size))
+        imageCache->insert(result.imagePath, size, QPixmap::fromImage(result.image), result.gradient); //pixmaps can only be made on the gui thread
+
+    if(!result.hasShapes)
+        return;
+
+    if(!shapes.contains(result.imagePath))
+        order.append(result.imagePath);
+    shapes.insert(result.imagePath, qMakePair(annotationPath, result.shapes));
+
+    while(order.size() > PREFETCH_KEEP)
+        shapes.remove(order.takeFirst());
+}
+
+bool Prefetcher::takeShapes(const QString &imagePath, const QString &annotationPath, QVector<AnnotationShape> *result){
+
+    QHash<QString, QPair<QString, QVector<AnnotationShape> > >::iterator it = shapes.find(imagePath);
+    if(it == shapes.end() || it.value().first != annotationPath)
+        return false;
+
+    *result = it.value().second;
+    shapes.erase(it);
+    order.removeOne(imagePath);
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include "annotationfile.h"
+#include "imagecache.h"
+
+#include <QObject>
+#include <QImage>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+/*!
+ * \brief PREFETCH_KEEP is the number of prefetched annotation files kept parsed
+ */
+#define PREFETCH_KEEP 8
+
+/*!
+ * \brief The PrefetchResult struct is what a worker thread prepares for one image
+ */
+struct PrefetchResult
+{
+    /*!
+     * \brief imagePath is the image path
+     */
+    QString imagePath;
+    /*!
+     * \brief image is the decoded image scaled to the scene size
+     */
+    QImage image;
+    /*!
+     * \brief gradient is the gradient map of the image
+     */
+    GradientMap gradient;
+    /*!
+     * \brief shapes are the shapes of its annotation file
+     */
+    QVector<AnnotationShape> shapes;
+    /*!
+     * \brief hasShapes is true when an annotation file was read
+     */
+    bool hasShapes;
+};
+
+/*!
+ * \brief The Prefetcher class decodes the images likely to be opened next and parses their annotation files on worker threads, the results are delivered to the gui thread (images go to the image cache)
+ */
+class Prefetcher : public QObject
+{
+public:
+    /*!
+     * \brief Prefetcher constructor
+     * \param theCache is the image cache receiving the decoded images
+     * \param parent is the parent object
+     */
+    Prefetcher(ImageCache *theCache, QObject *parent = nullptr);
+    /*!
+     * \brief prefetch method starts preparing an image unless it is cached or already being prepared
+     * \param imagePath is the image path
+     * \param annotationPath is its annotation file, empty if it has none
+     * \param size is the size the image is scaled to fit
+     */
+    void prefetch(const QString &imagePath, const QString &annotationPath, const QSize &size);
+    /*!
+     * \brief takeShapes method gets the prefetched shapes of an image
+     * \param imagePath is the image path
+     * \param annotationPath is the annotation file the shapes must come from
+     * \param shapes receives the shapes
+     * \return returns true if they were prefetched
+     */
+    bool takeShapes(const QString &imagePath, const QString &annotationPath, QVector<AnnotationShape> *shapes);
+
+private:
+    /*!
+     * \brief load method prepares an image, it runs on a worker thread
+     */
+    static PrefetchResult load(const QString &imagePath, const QString &annotationPath, const QSize &size);
+    /*!
+     * \brief finished method stores a result, it runs on the gui thread
+     */
+    void finished(const PrefetchResult &result, const QString &annotationPath, const QSize &size);
+
+private:
+    /*!
+     * \brief imageCache receives the decoded images
+     */
+    ImageCache *imageCache;
+    /*!
+     * \brief pending are the images being prepared
+     */
+    QSet<QString> pending;
+    /*!
+     * \brief shapes maps an image path to its annotation file and parsed shapes
+     */
+    QHash<QString, QPair<QString, QVector<AnnotationShape> > > shapes;
+    /*!
+     * \brief order lists the images in shapes from the oldest
+     */
+    QStringList order;
+};
+
+#endif // PREFETCHER_H
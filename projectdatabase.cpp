@@ -0,0 +1,330 @@
+#include "projectdatabase.h"
+#include "trace.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDateTime>
+#include <QVariant>
+
+#include <atomic>
+
+ProjectDatabase::ProjectDatabase()
+{
+    static std::atomic<int> counter(0);
+    connectionName = "project-" + QString::number(++counter); //Qt connections are per name, one per instance
+}
+
+ProjectDatabase::~ProjectDatabase()
+{
+    close();
+}
+
+bool ProjectDatabase::exec(const QString &statement){
+
+    QSqlQuery query(db);
+    if(!query.exec(statement)){
+        error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool ProjectDatabase::fail(const QString &message){
+    error = message;
+    db.rollback();
+    return false;
+}
+
+bool ProjectDatabase::open(const QString &fileName){
+
+    TRACE_SCOPE("open project", "project");
+
+    close();
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(fileName);
+    if(!db.open()){
+        error = db.lastError().text();
+        close();
+        return false;
+    }
+
+    //write-ahead log: commits are atomic and readers are not blocked by the writer
+    if(!exec("PRAGMA journal_mode=WAL") || !exec("PRAGMA synchronous=NORMAL") || !exec("PRAGMA foreign_keys=ON") || !createSchema()){
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ProjectDatabase::createSchema(){
+
+    QSqlQuery version(db);
+    if(!version.exec("PRAGMA user_version") || !version.next()){
+        error = version.lastError().text();
+        return false;
+    }
+    int current = version.value(0).toInt();
+    version.finish();
+
+    if(current > PROJECT_SCHEMA_VERSION){
+        error = "The project was created by a newer version of the application";
+        return false;
+    }
+    if(current == PROJECT_SCHEMA_VERSION)
+        return true;
+
+    if(!db.transaction()){
+        error = db.lastError().text();
+        return false;
+    }
+
+    bool ok = exec("CREATE TABLE IF NOT EXISTS images(id INTEGER PRIMARY KEY, path TEXT NOT NULL UNIQUE, name TEXT NOT NULL,"
+                   " date INTEGER, hash BLOB, width INTEGER, height INTEGER, status INTEGER NOT NULL DEFAULT 0)")
+           && exec("CREATE INDEX IF NOT EXISTS images_status ON images(status)")
+           && exec("CREATE TABLE IF NOT EXISTS classes(id INTEGER PRIMARY KEY, name TEXT NOT NULL UNIQUE)")
+           && exec("CREATE TABLE IF NOT EXISTS annotations(image_id INTEGER PRIMARY KEY REFERENCES images(id) ON DELETE CASCADE,"
+                   " shapes BLOB NOT NULL, classes TEXT NOT NULL, updated INTEGER NOT NULL)")
+           && exec(QString("PRAGMA user_version=%1").arg(PROJECT_SCHEMA_VERSION));
+
+    if(!ok)
+        return fail(error);
+    if(!db.commit())
+        return fail(db.lastError().text());
+    return true;
+}
+
+void ProjectDatabase::close(){
+
+    if(!db.isValid())
+        return;
+
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+bool ProjectDatabase::isOpen() const{
+    return db.isValid() && db.isOpen();
+}
+
+QString ProjectDatabase::fileName() const{
+    return isOpen() ? db.databaseName() : QString();
+}
+
+QString ProjectDatabase::lastError() const{
+    return error;
+}
+
+bool ProjectDatabase::addImages(const QVector<Image> &images){
+
+    TRACE_SCOPE("add images to project", "project");
+
+    if(!db.transaction()){
+        error = db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery insert(db);
+    insert.prepare("INSERT OR IGNORE INTO images(path, name, date, hash, width, height) VALUES(?, ?, ?, ?, ?, ?)");
+
+    for(const Image &img : images){
+        insert.addBindValue(img.getPath());
+        insert.addBindValue(img.getName());
+        insert.addBindValue(img.getDate().isValid() ? QVariant(img.getDate().toMSecsSinceEpoch()) : QVariant());
+        insert.addBindValue(img.getHash());
+        insert.addBindValue(img.getSize().width());
+        insert.addBindValue(img.getSize().height());
+        if(!insert.exec())
+            return fail(insert.lastError().text());
+    }
+
+    if(!db.commit())
+        return fail(db.lastError().text());
+    return true;
+}
+
+QVector<Image> ProjectDatabase::images() const{
+
+    TRACE_SCOPE("read project images", "project");
+
+    QVector<Image> result;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if(!query.exec("SELECT path, name, date, hash, width, height FROM images ORDER BY id")){
+        error = query.lastError().text();
+        return result;
+    }
+
+    while(query.next()){
+        QDateTime date = query.value(2).isNull() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(query.value(2).toLongLong());
+        Image img(query.value(1).toString(), query.value(0).toString(), date);
+        img.setHash(query.value(3).toByteArray());
+        if(query.value(4).toInt() > 0 && query.value(5).toInt() > 0)
+            img.setSize(QSize(query.value(4).toInt(), query.value(5).toInt()));
+        result.append(img);
+    }
+    return result;
+}
+
+QStringList ProjectDatabase::imagePaths(Status status) const{
+
+    QStringList result;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT path FROM images WHERE status = ? ORDER BY id");
+    query.addBindValue(int(status));
+    if(!query.exec()){
+        error = query.lastError().text();
+        return result;
+    }
+
+    while(query.next())
+        result.append(query.value(0).toString());
+    return result;
+}
+
+int ProjectDatabase::imageCount(Status status) const{
+
+    QSqlQuery query(db);
+    query.prepare("SELECT COUNT(*) FROM images WHERE status = ?");
+    query.addBindValue(int(status));
+    if(!query.exec() || !query.next()){
+        error = query.lastError().text();
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+QHash<QString, QStringList> ProjectDatabase::annotatedClasses() const{
+
+    QHash<QString, QStringList> result;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if(!query.exec("SELECT images.path, annotations.classes FROM annotations JOIN images ON images.id = annotations.image_id")){
+        error = query.lastError().text();
+        return result;
+    }
+
+    while(query.next())
+        result.insert(query.value(0).toString(), query.value(1).toString().split('\n', Qt::SkipEmptyParts));
+    return result;
+}
+
+QHash<QString, QByteArray> ProjectDatabase::annotationJson() const{
+
+    QHash<QString, QByteArray> result;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if(!query.exec("SELECT images.path, annotations.shapes FROM annotations JOIN images ON images.id = annotations.image_id")){
+        error = query.lastError().text();
+        return result;
+    }
+
+    while(query.next())
+        result.insert(query.value(0).toString(), query.value(1).toByteArray());
+    return result;
+}
+
+bool ProjectDatabase::addClass(const QString &name){
+
+    QSqlQuery query(db);
+    query.prepare("INSERT OR IGNORE INTO classes(name) VALUES(?)");
+    query.addBindValue(name);
+    if(!query.exec()){
+        error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool ProjectDatabase::removeClass(const QString &name){
+
+    QSqlQuery query(db);
+    query.prepare("DELETE FROM classes WHERE name = ?");
+    query.addBindValue(name);
+    if(!query.exec()){
+        error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+QStringList ProjectDatabase::classes() const{
+
+    QStringList result;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if(!query.exec("SELECT name FROM classes ORDER BY id")){
+        error = query.lastError().text();
+        return result;
+    }
+
+    while(query.next())
+        result.append(query.value(0).toString());
+    return result;
+}
+
+bool ProjectDatabase::saveAnnotations(const QString &imagePath, const QVector<AnnotationShape> &shapes){
+
+    TRACE_SCOPE("save annotations to project", "project");
+
+    if(!db.transaction()){
+        error = db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery find(db);
+    find.prepare("SELECT id FROM images WHERE path = ?");
+    find.addBindValue(imagePath);
+    if(!find.exec() || !find.next())
+        return fail("The image is not in the project");
+    qint64 id = find.value(0).toLongLong();
+    find.finish();
+
+    QStringList classNames;
+    for(const AnnotationShape &shape : shapes){
+        if(!classNames.contains(shape.object))
+            classNames.append(shape.object);
+    }
+
+    QSqlQuery write(db);
+    if(shapes.isEmpty()){
+        write.prepare("DELETE FROM annotations WHERE image_id = ?");
+        write.addBindValue(id);
+    }else{
+        write.prepare("INSERT OR REPLACE INTO annotations(image_id, shapes, classes, updated) VALUES(?, ?, ?, ?)");
+        write.addBindValue(id);
+        write.addBindValue(AnnotationFile::serialize(shapes)); //the same json as the annotation files
+        write.addBindValue(classNames.join('\n'));
+        write.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    }
+    if(!write.exec())
+        return fail(write.lastError().text());
+
+    QSqlQuery status(db);
+    status.prepare("UPDATE images SET status = ? WHERE id = ?");
+    status.addBindValue(int(shapes.isEmpty() ? Status::Unannotated : Status::Annotated));
+    status.addBindValue(id);
+    if(!status.exec())
+        return fail(status.lastError().text());
+
+    if(!db.commit())
+        return fail(db.lastError().text());
+    return true;
+}
+
+bool ProjectDatabase::loadAnnotations(const QString &imagePath, QVector<AnnotationShape> *shapes) const{
+
+    QSqlQuery query(db);
+    query.prepare("SELECT annotations.shapes FROM annotations JOIN images ON images.id = annotations.image_id WHERE images.path = ?");
+    query.addBindValue(imagePath);
+    if(!query.exec()){
+        error = query.lastError().text();
+        return false;
+    }
+    if(!query.next())
+        return false;
+
+    *shapes = AnnotationFile::parse(query.value(0).toByteArray());
+    return true;
+}
@@ -0,0 +1,156 @@
+#ifndef PROJECTDATABASE_H
+#define PROJECTDATABASE_H
+
+#include "image.h"
+#include "annotationfile.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSqlDatabase>
+
+/*!
+ * \brief PROJECT_SCHEMA_VERSION is stored in the project file (sqlite user_version), files of a newer version are refused
+ */
+#define PROJECT_SCHEMA_VERSION 1
+
+/*!
+ * \brief The ProjectDatabase class stores a whole project (images, classes, annotations and the annotation status of each image) in one sqlite file
+ *
+ * Every change is a transaction and the file uses write-ahead logging, so a crash never leaves a half written project
+ * and other threads or processes can keep reading (each through its own ProjectDatabase) while it is written.
+ */
+class ProjectDatabase
+{
+public:
+    /*!
+     * \brief The Status enum is the annotation status of an image
+     */
+    enum class Status { Unannotated = 0, Annotated = 1 };
+
+    /*!
+     * \brief ProjectDatabase constructor creates a closed database
+     */
+    ProjectDatabase();
+    /*!
+      *\brief ~ProjectDatabase destructor closes the database
+      */
+    ~ProjectDatabase();
+    /*!
+     * \brief open method opens a project file, creating it if it doesn't exist
+     * \param fileName is the project file path
+     * \return returns true if the project is open
+     */
+    bool open(const QString &fileName);
+    /*!
+     * \brief close method closes the project
+     */
+    void close();
+    /*!
+     * \brief isOpen method determines whether a project is open
+     */
+    bool isOpen() const;
+    /*!
+     * \brief fileName method gets the path of the open project
+     */
+    QString fileName() const;
+    /*!
+     * \brief lastError method gets the message of the last failure
+     */
+    QString lastError() const;
+    /*!
+     * \brief addImages method adds images in one transaction, images already in the project are ignored
+     * \param images are the images
+     * \return returns true if the images were added
+     */
+    bool addImages(const QVector<Image> &images);
+    /*!
+     * \brief images method gets every image of the project, in the order they were added
+     * \return returns the images
+     */
+    QVector<Image> images() const;
+    /*!
+     * \brief imagePaths method gets the paths of the images with a status (uses the status index)
+     * \param status is the annotation status
+     * \return returns the image paths
+     */
+    QStringList imagePaths(Status status) const;
+    /*!
+     * \brief imageCount method counts the images with a status
+     * \param status is the annotation status
+     * \return returns the number of images
+     */
+    int imageCount(Status status) const;
+    /*!
+     * \brief annotatedClasses method gets the classes used on each annotated image
+     * \return returns the class names keyed by image path
+     */
+    QHash<QString, QStringList> annotatedClasses() const;
+    /*!
+     * \brief annotationJson method gets the stored shapes of every annotated image in one query, to be parsed by the caller
+     * \return returns the json of the shapes keyed by image path
+     */
+    QHash<QString, QByteArray> annotationJson() const;
+    /*!
+     * \brief addClass method adds a class at the end of the class list
+     * \param name is the class name
+     * \return returns true if the class was added or already existed
+     */
+    bool addClass(const QString &name);
+    /*!
+     * \brief removeClass method removes a class
+     * \param name is the class name
+     * \return returns true if the change was written
+     */
+    bool removeClass(const QString &name);
+    /*!
+     * \brief classes method gets the class names in the order they were added
+     * \return returns the class names
+     */
+    QStringList classes() const;
+    /*!
+     * \brief saveAnnotations method stores the shapes of an image and marks it annotated (or unannotated when there are no shapes)
+     * \param imagePath is the image path, the image must be in the project
+     * \param shapes are the shapes
+     * \return returns true if the shapes were written
+     */
+    bool saveAnnotations(const QString &imagePath, const QVector<AnnotationShape> &shapes);
+    /*!
+     * \brief loadAnnotations method gets the shapes of an image
+     * \param imagePath is the image path
+     * \param shapes receives the shapes
+     * \return returns true if the image has shapes stored
+     */
+    bool loadAnnotations(const QString &imagePath, QVector<AnnotationShape> *shapes) const;
+
+private:
+    /*!
+     * \brief exec method runs a statement without results and records the error if it fails
+     */
+    bool exec(const QString &statement);
+    /*!
+     * \brief createSchema method creates the tables and indexes of a new file and checks the version of an existing one
+     */
+    bool createSchema();
+    /*!
+     * \brief fail method records the error of a failed transaction, rolls it back and returns false
+     */
+    bool fail(const QString &error);
+
+private:
+    /*!
+     * \brief connectionName is the unique Qt connection name of this database
+     */
+    QString connectionName;
+    /*!
+     * \brief db is the sqlite connection
+     */
+    QSqlDatabase db;
+    /*!
+     * \brief error is the message of the last failure
+     */
+    mutable QString error;
+};
+
+#endif // PROJECTDATABASE_H
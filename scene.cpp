@@ -1,19 +1,20 @@
 #include "scene.h"
+#include "annotationfile.h"
+#include "geometry.h"
+#include "trace.h"
 #include <QActionGroup>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QDebug>
+#include <QPainterPath>
 #include <math.h>
 
 #define DATA_SHAPETYPE 0
-
-#define SHAPE_LINE		1
-#define SHAPE_RECT		2
-#define SHAPE_TRAPEZOID	3
-#define SHAPE_POLYGON	4
+#define DATA_WANDTOLERANCE 1
+#define DATA_CONFIDENCE 2
+#define DATA_OVERLAY 3
+#define OVERLAP_Z 1000 // the overlap marks are drawn above the shapes
+#define LIVEWIRE_CLOSE_DISTANCE 8 // a click this close to the first point closes the live wire shape
 
 Scene::Scene(QObject *parent)
     : QGraphicsScene(parent)
@@ -21,6 +22,15 @@ Scene::Scene(QObject *parent)
     , m_origPoint()
     , m_itemToDraw(nullptr)
     , m_CurrentPolygon(nullptr)
+    , m_WandItem(nullptr)
+    , m_WandTolerance(WAND_TOLERANCE)
+    , m_SnapToEdges(false)
+    , m_LiveWireItem(nullptr)
+    , m_CheckOverlaps(false)
+    , m_Statistics(nullptr)
+    , m_Modified(false)
+    , m_Revision(0)
+    , m_GeometryChanged(false)
 {
 }
 
@@ -30,85 +40,164 @@ Scene::~Scene()
 
 void Scene::setMode(Mode aMode)
 {
+    if (aMode != m_Mode)
+        cancelLiveWire(); // an unfinished shape is dropped when the tool changes
     m_Mode = aMode;
+    finishPolygon();
+}
+
+void Scene::finishPolygon()
+{
+    if (!m_CurrentPolygon)
+        return;
     m_CurrentPolygon = nullptr; // for the add polygon function.
+    updateDerived(); // the vertices were recorded as they were added, the checks run once for the whole polygon
+}
+
+Scene::Mode Scene::mode() const
+{
+    return m_Mode;
+}
+
+bool Scene::isModified() const
+{
+    return m_Modified;
+}
+
+void Scene::setModified(bool aModified)
+{
+    m_Modified = aModified;
+    if (!aModified && m_Statistics && !m_StatisticsImage.isEmpty())
+        m_Statistics->discardUnsaved(m_StatisticsImage); // saved, or the image was opened without edits
+}
+
+quint64 Scene::revision() const
+{
+    return m_Revision;
+}
+
+void Scene::setImage(const QImage &aImage, const GradientMap &aGradient)
+{
+    if (aImage.isNull())
+    {
+        m_LiveWireItem = nullptr; // deleted with the other items when the scene was cleared
+        m_OverlapItems.clear();
+        m_Overlaps.clear();
+    }
+    else
+        cancelLiveWire();
+    m_LiveWirePoints.clear();
+
+    m_Wand.setImage(aImage);
+    m_Gradient = aGradient;
+    m_LiveWire.setGradient(aGradient);
+}
+
+void Scene::setSnapToEdges(bool aSnap)
+{
+    m_SnapToEdges = aSnap;
+}
+
+QPointF Scene::snapped(const QPointF &aPos) const
+{
+    if (!m_SnapToEdges)
+        return aPos;
+    return m_Gradient.snap(aPos); // a windowed search around the mouse, no image wide work per event
 }
 
 void Scene::save(const QString& aFileName)
 {
-    QJsonDocument doc;
-    QJsonArray a;
-    QJsonObject shapes;
+    AnnotationFile::write(aFileName, shapes()); //Save the annotated shapes to the json file.
+}
+
+QVector<AnnotationShape> Scene::shapes()
+{
+    TRACE_SCOPE("collect shapes", "save");
+    QVector<AnnotationShape> result;
 
     for (auto const &iT : items())
     {
-        QJsonArray res;
-        QJsonObject o;
+        AnnotationShape shape;
+        shape.type = iT->data(DATA_SHAPETYPE).toInt(); // Get the type of the object.
+        shape.object = iT->toolTip();
+        if (iT->data(DATA_CONFIDENCE).isValid())
+            shape.confidence = iT->data(DATA_CONFIDENCE).toDouble(); // a pre-label not accepted yet
 
-        switch (iT->data(DATA_SHAPETYPE).toInt()) // Get the type of the selected object.
+        switch (shape.type)
         {
         case SHAPE_RECT:
         {
             QGraphicsRectItem *ri = static_cast<QGraphicsRectItem*>(iT);
-            o.insert("object", ri->toolTip());
-            o.insert("shape","Rectangle");
-
-
-            //Scene relative coordinates.
-            res.append(ri->mapToScene(ri->rect().topLeft()).x());
-            res.append(ri->mapToScene(ri->rect().topLeft()).y());
-            res.append(ri->rect().width());
-            res.append(ri->rect().height());
 
+            //Scene relative coordinates, a rotated rectangle is stored unrotated around its center plus the angle.
+            QPointF center = ri->mapToScene(ri->rect().center());
+            QSizeF size = ri->rect().size();
+            shape.coordinates << center.x() - size.width() / 2 << center.y() - size.height() / 2 << size.width() << size.height();
+            shape.rotation = ri->rotation();
         }
         break;
         case SHAPE_POLYGON:
-        {
-            QGraphicsPolygonItem *ri = static_cast<QGraphicsPolygonItem*>(iT);
-
-            o.insert("object", ri->toolTip());
-            o.insert("shape","Polygon");
-            for (auto const& iT : ri->polygon())
-            {
-                QPointF sc = ri->mapToScene(iT);
-                res.append(sc.x());
-                res.append(sc.y());
-            }
-        }
-        break;
         case SHAPE_TRAPEZOID:
         {
             QGraphicsPolygonItem *ri = static_cast<QGraphicsPolygonItem*>(iT);
-            o.insert("object", ri->toolTip());
-            o.insert("shape","Trapezoid");
-            for (auto const& iT : ri->polygon())
+            for (auto const& pT : ri->polygon())
             {
-                QPointF sc = ri->mapToScene(iT);
-                res.append(sc.x());
-                res.append(sc.y());
-
+                QPointF sc = ri->mapToScene(pT);
+                shape.coordinates << sc.x() << sc.y();
             }
         }
         break;
         default:
             break;
         }
-        if(!res.isEmpty()){
-            o.insert("coordinates", res);
-            a.push_back(o);
-        }
+
+        if (!shape.coordinates.isEmpty())
+            result.append(shape);
     }
+    return result;
+}
+
+bool Scene::load(const QString &aFileName)
+{
+    QVector<AnnotationShape> loaded;
+    if (!AnnotationFile::read(aFileName, &loaded))
+        return false;
+
+    addShapes(loaded);
+    return true;
+}
+
+void Scene::addShapes(const QVector<AnnotationShape> &aShapes)
+{
+    TRACE_SCOPE("build scene", "scene");
+    QString current = className; // setupShapes uses the class of each shape, keep the selected class for drawing
 
-    shapes.insert("TotalShapes",items().size()-1);
-    shapes.insert("objects", a);
+    for (const AnnotationShape &shape : aShapes)
+    {
+        if (shape.type == SHAPE_RECT && (shape.rotation != 0 || shape.confidence >= 0) && shape.coordinates.size() >= 4)
+        {
+            className = shape.object;
+            QRectF r(shape.coordinates[0], shape.coordinates[1], shape.coordinates[2], shape.coordinates[3]);
+            QGraphicsRectItem *ri = drawRectangle(&r);
+            ri->setTransformOriginPoint(r.center());
+            ri->setRotation(shape.rotation);
+            if (shape.confidence >= 0)
+            {
+                // Pre-label: dashed, from red (unsure) to green (sure), until the annotator accepts it.
+                ri->setPen(QPen(QColor::fromHsvF(qBound(0.0, shape.confidence, 1.0) / 3, 1, 0.9), 3, Qt::DashLine));
+                ri->setData(DATA_CONFIDENCE, shape.confidence);
+            }
+            continue;
+        }
 
-    doc.setObject(shapes);
+        QList<double> coordinates = shape.coordinates.toList();
+        QString object = shape.object;
+        setupShapes(&coordinates, &object, shape.type);
+    }
 
-    QFile jsonFile(aFileName); //Save to shape.json the selected object.
-    jsonFile.open(QFile::WriteOnly);
-    jsonFile.write(doc.toJson());
-    jsonFile.close();
+    className = current;
 
+    updateDerived();
 }
 
 void Scene::mousePressEvent(QGraphicsSceneMouseEvent *aEvent)
@@ -140,11 +229,27 @@ void Scene::mousePressEvent(QGraphicsSceneMouseEvent *aEvent)
     case Mode::DrawPoligon:
         addPolygonPoint(aEvent); // Add point to the polygon.
         break;
+    case Mode::MagicWand:
+        m_origPoint = aEvent->scenePos(); // Select the region around the clicked pixel.
+        m_WandItem = nullptr;
+        updateMagicWand(m_WandTolerance);
+        break;
+    case Mode::LiveWire:
+        if (aEvent->button() == Qt::RightButton)
+            finishLiveWire(); // Close the shape.
+        else
+            addLiveWirePoint(aEvent->scenePos()); // Anchor the path at the clicked point.
+        break;
     default:
         break;
     }
 
     QGraphicsScene::mousePressEvent(aEvent);
+
+    // The items selected by this press are the ones a drag moves.
+    m_PressPositions.clear();
+    for (QGraphicsItem *item : selectedItems())
+        m_PressPositions.append(qMakePair(item, item->pos()));
 }
 
 void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent *aEvent)
@@ -192,6 +297,19 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent *aEvent)
                     rotateTrapezoid(aEvent);
                 }
             }
+            break;
+        case Mode::MagicWand:
+            if (m_WandItem && (aEvent->buttons() & Qt::LeftButton))
+            {
+                // Dragging right grows the selection, dragging left shrinks it.
+                int tolerance = qBound(0, m_WandTolerance + int(aEvent->scenePos().x() - m_origPoint.x()) / 2, 255);
+                updateMagicWand(tolerance);
+            }
+            break;
+        case Mode::LiveWire:
+            if (m_LiveWireItem)
+                updateLiveWire(aEvent->scenePos()); // the search continues from where the last event left it
+            break;
         default:
             break;
 
@@ -209,6 +327,14 @@ void Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent *aEvent)
     case Mode::DrawRectangle:
         addRectangle(aEvent);
         break;
+    case Mode::MagicWand:
+        if (m_WandItem)
+        {
+            m_WandTolerance = m_WandItem->data(DATA_WANDTOLERANCE).toInt(); // the next click starts from this tolerance
+            m_GeometryChanged = true;
+        }
+        m_WandItem = nullptr;
+        break;
     case Mode::DrawTrapezoid:
         addTrapezoid(aEvent);
         break;
@@ -216,6 +342,19 @@ void Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent *aEvent)
         break;
     }
 
+    for (const QPair<QGraphicsItem*, QPointF> &pressed : m_PressPositions)
+    {
+        if (pressed.first->pos() != pressed.second)
+            m_GeometryChanged = true; // dragged
+    }
+    m_PressPositions.clear();
+
+    if (m_GeometryChanged)
+    {
+        m_GeometryChanged = false;
+        shapesChanged(); // a plain click changes nothing
+    }
+
     QGraphicsScene::mouseReleaseEvent(aEvent);
 }
 
@@ -224,9 +363,12 @@ void Scene::keyPressEvent(QKeyEvent *aEvent)
     switch (aEvent->key() )
     {
     case Qt::Key_Delete:
-        for (auto& iT : selectedItems())
+        if (!selectedItems().isEmpty())
         {
-            removeItem(iT); // remove selected objects from the scene.
+            m_PressPositions.clear(); // the removed items are no longer compared on release
+            for (auto& iT : selectedItems())
+                removeItem(iT); // remove selected objects from the scene.
+            shapesChanged();
         }
         break;
     case Qt::Key_Control:
@@ -235,6 +377,14 @@ void Scene::keyPressEvent(QKeyEvent *aEvent)
             setMode(Mode::Edit);
         }
         break;
+    case Qt::Key_Escape:
+        cancelLiveWire(); // drop the shape being traced
+        break;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        if (m_Mode == Mode::LiveWire)
+            finishLiveWire();
+        break;
 
     }
 
@@ -297,6 +447,7 @@ void Scene::addTrapezoid(QGraphicsSceneMouseEvent* aEvent)
     // Add  trapezoid
     QRectF r = selectionArea().boundingRect();
     drawTrapezoid(&r);
+    m_GeometryChanged = true;
 
 }
 
@@ -331,11 +482,12 @@ void Scene::setupShapes(QList<double> *pList, QString *m_Object,int type){
 
 }
 
-void Scene::drawRectangle(QRectF *rectP){
+QGraphicsRectItem *Scene::drawRectangle(QRectF *rectP){
 
     QGraphicsRectItem *a = addRect(*rectP, QPen(Qt::black, 3, Qt::SolidLine)); // mark as rectangle
     a->setData(DATA_SHAPETYPE, SHAPE_RECT);
     a->setToolTip(className);
+    return a;
 }
 
 void Scene::addRectangle(QGraphicsSceneMouseEvent* aEvent)
@@ -343,6 +495,7 @@ void Scene::addRectangle(QGraphicsSceneMouseEvent* aEvent)
     // Add rectangle
     QRectF r = selectionArea().boundingRect();
     drawRectangle(&r);
+    m_GeometryChanged = true;
 
 }
 
@@ -350,6 +503,18 @@ void Scene::setClassName(const QString &aClassName){
     className = aClassName;
 }
 
+QStringList Scene::classNames(){
+
+    QStringList names;
+    for (auto const &iT : items())
+    {
+        int type = iT->data(DATA_SHAPETYPE).toInt();
+        if ((type == SHAPE_RECT || type == SHAPE_TRAPEZOID || type == SHAPE_POLYGON) && !names.contains(iT->toolTip()))
+            names.append(iT->toolTip());
+    }
+    return names;
+}
+
 void Scene::drawPolygon(QPolygonF *polyP){
 
     m_CurrentPolygon = addPolygon(*polyP, QPen(Qt::black, 3, Qt::SolidLine));
@@ -369,15 +534,119 @@ void Scene::addPolygonPoint(QGraphicsSceneMouseEvent *aEvent)
     }
 
 
-    f.append(aEvent->scenePos());
+    f.append(snapped(aEvent->scenePos()));
     drawPolygon(&f);
+    m_Modified = true; // checked and counted once finished
+    m_Revision++;
+
+}
+
+void Scene::updateMagicWand(int aTolerance)
+{
+    QPolygonF outline = m_Wand.select(m_origPoint.toPoint(), aTolerance);
+
+    if (outline.size() < 3)
+    {
+        if (m_WandItem)
+        {
+            removeItem(m_WandItem); // the region vanished, e.g. clicked outside the image
+            delete m_WandItem;
+            m_WandItem = nullptr;
+        }
+        return;
+    }
+
+    if (!m_WandItem)
+    {
+        m_WandItem = addPolygon(outline, QPen(Qt::black, 3, Qt::SolidLine));
+        m_WandItem->setData(DATA_SHAPETYPE, SHAPE_POLYGON); // mark as polygon
+        m_WandItem->setToolTip(className);
+    }
+    else
+    {
+        m_WandItem->setPolygon(outline);
+    }
+    m_WandItem->setData(DATA_WANDTOLERANCE, aTolerance);
+}
+
+void Scene::addLiveWirePoint(const QPointF &aPos)
+{
+    if (!m_LiveWire.isValid())
+        return;
 
+    if (!m_LiveWireItem)
+    {
+        m_LiveWirePoints.clear();
+        m_LiveWirePoints.append(m_LiveWire.setAnchor(aPos)); // the first point of the shape
+        m_LiveWireItem = addPath(QPainterPath(), QPen(Qt::black, 3, Qt::SolidLine));
+        updateLiveWire(aPos);
+        return;
+    }
+
+    QPointF first = m_LiveWirePoints.first();
+    if (m_LiveWirePoints.size() >= 3 && QLineF(first, aPos).length() <= LIVEWIRE_CLOSE_DISTANCE)
+    {
+        finishLiveWire(); // clicked on the first point
+        return;
+    }
+
+    QPolygonF segment = m_LiveWire.pathTo(aPos);
+    for (int i = 1; i < segment.size(); i++)
+        m_LiveWirePoints.append(segment[i]); // the first point is the previous anchor
+    m_LiveWire.setAnchor(aPos);
+    updateLiveWire(aPos);
+}
+
+void Scene::updateLiveWire(const QPointF &aPos)
+{
+    QPainterPath path(m_LiveWirePoints.first());
+    for (int i = 1; i < m_LiveWirePoints.size(); i++)
+        path.lineTo(m_LiveWirePoints[i]);
+
+    QPolygonF segment = m_LiveWire.pathTo(aPos);
+    for (int i = 1; i < segment.size(); i++)
+        path.lineTo(segment[i]);
+
+    m_LiveWireItem->setPath(path);
+}
+
+void Scene::finishLiveWire()
+{
+    if (!m_LiveWireItem)
+        return;
+
+    QPolygonF segment = m_LiveWire.pathTo(m_LiveWirePoints.first()); // back to the start along the edges
+    for (int i = 1; i < segment.size() - 1; i++)
+        m_LiveWirePoints.append(segment[i]);
+
+    QPolygonF f = m_LiveWirePoints;
+    cancelLiveWire();
+
+    if (f.size() >= 3)
+    {
+        drawPolygon(&f); // committed as a polygon of the current class
+        m_CurrentPolygon = nullptr;
+        shapesChanged();
+    }
+}
+
+void Scene::cancelLiveWire()
+{
+    if (m_LiveWireItem)
+    {
+        removeItem(m_LiveWireItem);
+        delete m_LiveWireItem;
+        m_LiveWireItem = nullptr;
+    }
+    m_LiveWirePoints.clear();
 }
 
 void Scene::setSelectable(bool aSelectable)
 {
 
     for(int i = 0; i < items().size()-1; i++){
+        if(items()[i]->data(DATA_OVERLAY).isValid())
+            continue; // the overlap marks are never selected or moved
         items()[i]->setFlag(QGraphicsItem::ItemIsSelectable, aSelectable);
         items()[i]->setFlag(QGraphicsItem::ItemIsMovable, aSelectable);
     }
@@ -394,37 +663,29 @@ void Scene::editRectangle(QGraphicsSceneMouseEvent *aEvent)
     QRectF r2 = rect;
 
     // find the selected corner.
-    r2.setBottomLeft(mouse);
-
-    float min = sqrt(pow(rect.bottomLeft().x() - mouse.x(), 2) + pow(rect.bottomLeft().y() - mouse.y(), 2));
-    float tmp = sqrt(pow(rect.bottomRight().x() - mouse.x(), 2) + pow(rect.bottomRight().y() - mouse.y(), 2));
-    if (tmp < min)
+    QPolygonF corners;
+    corners << rect.bottomLeft() << rect.bottomRight() << rect.topLeft() << rect.topRight();
+    switch (Geometry::nearestPoint(corners, mouse))
     {
-        tmp = min;
-        r2 = rect;
+    case 0:
+        r2.setBottomLeft(mouse);
+        break;
+    case 1:
         r2.setBottomRight(mouse);
-    }
-
-    tmp = sqrt(pow(rect.topLeft().x() - mouse.x(), 2) + pow(rect.topLeft().y() - mouse.y(), 2));
-    if (tmp < min)
-    {
-        tmp = min;
-        r2 = rect;
+        break;
+    case 2:
         r2.setTopLeft(mouse);
-    }
-
-    tmp = sqrt(pow(rect.topRight().x() - mouse.x(), 2) + pow(rect.topRight().y() - mouse.y(), 2));
-    if (tmp < min)
-    {
-        tmp = min;
-        r2 = rect;
+        break;
+    default:
         r2.setTopRight(mouse);
+        break;
     }
 
-    if (r2.width() > 3 && r2.height() > 3) // Line is not allowed.
+    if (r2.width() > 3 && r2.height() > 3 && r2 != rect) // Line is not allowed.
     {
         ri->setRect(r2);
         ri->update();
+        m_GeometryChanged = true;
     }
 }
 
@@ -438,26 +699,21 @@ void Scene::editPolygon(QGraphicsSceneMouseEvent *aEvent, bool aShallConvex)
 
     QPointF mouse = pi->mapFromScene(aEvent->scenePos());
 
-    float min = std::numeric_limits<float>::max();
-    int idx = 0;
-
     // find the selected point
-    for (int i = 0; i < p.size(); i++)
-    {
-        float dist = sqrt(pow(p[i].x() - mouse.x(), 2) + pow(p[i].y() - mouse.y(), 2));
-        if (dist < min)
-        {
-            min = dist;
-            idx = i;
-        }
-    }
+    int idx = Geometry::nearestPoint(p, mouse);
+    if (idx < 0)
+        return;
 
-    p[idx] = mouse;
+    QPointF moved = pi->mapFromScene(snapped(aEvent->scenePos())); // the edge is found in image (scene) coordinates
+    if (moved == p[idx])
+        return;
+    p[idx] = moved;
 
-    if (aShallConvex && !polygonIsConvex(p))
+    if (aShallConvex && !Geometry::isConvex(p))
         return;
 
     pi->setPolygon(p);
+    m_GeometryChanged = true;
 }
 
 void Scene::editTrapezoid(QGraphicsSceneMouseEvent *aEvent)
@@ -491,6 +747,7 @@ void Scene::rotateRectangle(QGraphicsSceneMouseEvent *aEvent)
         item->setPos(t.map(item->pos())); // map to the scene.
         //item->setRotation(item->rotation() + 10);
         item->setRotation((theta_radians * 180 / M_PI));
+        m_GeometryChanged = true;
     }
 }
 
@@ -500,57 +757,164 @@ void Scene::rotateTrapezoid(QGraphicsSceneMouseEvent* aEvent)
     rotateRectangle(aEvent);
 }
 
-//// Return true if the polygon is convex.
-bool Scene::polygonIsConvex(QPolygonF const& p)
+int Scene::acceptPreLabels()
 {
-     /*For each set of three adjacent points A, B, C,
-     find the cross product AB � BC. If the sign of
-     all the cross products is the same, the angles
-     are all positive or negative (depending on the
-     order in which we visit them) so the polygon
-     is convex.*/
-    bool got_negative = false;
-    bool got_positive = false;
-    int num_points = p.size();
-    int B, C;
-    for (int A = 0; A < num_points; A++)
+    QList<QGraphicsItem*> candidates = selectedItems();
+    bool anySelected = false;
+    for (auto const &iT : candidates)
+        anySelected = anySelected || iT->data(DATA_CONFIDENCE).isValid();
+    if (!anySelected)
+        candidates = items(); // nothing selected, accept them all
+
+    int accepted = 0;
+    for (auto const &iT : candidates)
     {
-        B = (A + 1) % num_points;
-        C = (B + 1) % num_points;
+        if (!iT->data(DATA_CONFIDENCE).isValid())
+            continue;
+        iT->setData(DATA_CONFIDENCE, QVariant());
+        static_cast<QAbstractGraphicsShapeItem*>(iT)->setPen(QPen(Qt::black, 3, Qt::SolidLine));
+        accepted++;
+    }
 
-        float cross_product = crossProductLength(	p[A].x(), p[A].y(), p[B].x(), p[B].y(),	p[C].x(), p[C].y());
-        if (cross_product < 0)
-        {
-            got_negative = true;
-        }
-        else if (cross_product > 0)
+    if (accepted > 0)
+        shapesChanged(); // accepted pre-labels are checked too
+    return accepted;
+}
+
+int Scene::preLabelCount() const
+{
+    int count = 0;
+    for (auto const &iT : items())
+    {
+        if (iT->data(DATA_CONFIDENCE).isValid())
+            count++;
+    }
+    return count;
+}
+
+int Scene::removePreLabels()
+{
+    int removed = 0;
+    for (auto const &iT : items())
+    {
+        if (!iT->data(DATA_CONFIDENCE).isValid())
+            continue;
+        removeItem(iT);
+        delete iT;
+        removed++;
+    }
+    m_PressPositions.clear();
+    if (removed > 0)
+        shapesChanged();
+    return removed;
+}
+
+qint64 Scene::memoryUsed(int *shapes) const
+{
+    qint64 bytes = 0;
+    int count = 0;
+    for (auto const &iT : items())
+    {
+        switch (iT->data(DATA_SHAPETYPE).toInt())
         {
-            got_positive = true;
+        case SHAPE_RECT:
+            bytes += sizeof(QGraphicsRectItem);
+            break;
+        case SHAPE_POLYGON:
+        case SHAPE_TRAPEZOID:
+            bytes += sizeof(QGraphicsPolygonItem) + static_cast<QGraphicsPolygonItem*>(iT)->polygon().size() * sizeof(QPointF);
+            break;
+        default:
+            continue; //the image and the items being drawn
         }
-        if (got_negative && got_positive)
-            return false;
+        bytes += iT->toolTip().size() * sizeof(QChar);
+        count++;
     }
 
-    //If we got this far, the polygon is convex.
-    return true;
+    if (shapes)
+        *shapes = count;
+    return bytes;
 }
 
- /*Return the cross product AB x BC.
- The cross product is a vector perpendicular to AB
- and BC having length |AB| * |BC| * Sin(theta) and
- with direction given by the right-hand rule.
- For two vectors in the X-Y plane, the result is a
- vector with X and Y components 0 so the Z component
- gives the vector's length and direction.*/
+void Scene::setCheckOverlaps(bool aCheck)
+{
+    m_CheckOverlaps = aCheck;
+    if (aCheck)
+    {
+        updateOverlaps(shapes());
+    }
+    else
+    {
+        removeOverlapItems();
+        m_Overlaps.clear();
+    }
+}
 
-float Scene::crossProductLength(float Ax, float Ay, float Bx, float By, float Cx, float Cy)
+QVector<OverlapIssue> Scene::overlaps() const
 {
-    // Get the vectors' coordinates.
-    float BAx = Ax - Bx;
-    float BAy = Ay - By;
-    float BCx = Cx - Bx;
-    float BCy = Cy - By;
+    return m_Overlaps;
+}
 
-    // Calculate the Z coordinate of the cross product.
-    return (BAx * BCy - BAy * BCx);
+void Scene::setStatistics(DatasetStatistics *aStatistics, const QString &aImagePath)
+{
+    m_Statistics = aStatistics;
+    m_StatisticsImage = aImagePath;
+}
+
+void Scene::shapesChanged()
+{
+    m_Modified = true;
+    m_Revision++;
+    updateDerived();
+}
+
+void Scene::updateDerived()
+{
+    if (!m_CheckOverlaps && (!m_Statistics || m_StatisticsImage.isEmpty()))
+        return;
+
+    QVector<AnnotationShape> current = shapes(); // collected once for both
+    if (m_CheckOverlaps)
+        updateOverlaps(current);
+    if (m_Statistics && !m_StatisticsImage.isEmpty())
+    {
+        // Shapes changed since the last save count as unsaved edits, shapes loaded into an unmodified scene are the saved ones.
+        if (m_Modified)
+            m_Statistics->setUnsaved(m_StatisticsImage, ImageStatistics::measure(current));
+        else
+            m_Statistics->setImage(m_StatisticsImage, ImageStatistics::measure(current));
+    }
+}
+
+void Scene::removeOverlapItems()
+{
+    for (QGraphicsRectItem *item : m_OverlapItems)
+    {
+        removeItem(item);
+        delete item;
+    }
+    m_OverlapItems.clear();
+}
+
+void Scene::updateOverlaps(const QVector<AnnotationShape> &current)
+{
+    removeOverlapItems();
+    m_Overlaps = OverlapChecker::check(current);
+
+    for (const OverlapIssue &issue : m_Overlaps)
+    {
+        // Orange for a shape drawn twice, red for two classes on the same object.
+        QColor color = issue.kind == OverlapIssue::Kind::Duplicate ? QColor(255, 140, 0) : QColor(220, 0, 0);
+        QPen pen(color, 2, Qt::DashLine);
+        pen.setCosmetic(true);
+        color.setAlpha(60);
+
+        QGraphicsRectItem *item = addRect(issue.region, pen, QBrush(color));
+        item->setZValue(OVERLAP_Z);
+        item->setAcceptedMouseButtons(Qt::NoButton); // clicks reach the shapes below
+        item->setData(DATA_OVERLAY, true);
+        item->setToolTip(QString("%1: %2 / %3, IoU %4").arg(OverlapChecker::kindName(issue.kind), current[issue.first].object,
+                                                             current[issue.second].object).arg(issue.iou, 0, 'f', 2));
+        m_OverlapItems.append(item);
+    }
 }
@@ -7,6 +7,22 @@
 #include <QGraphicsLineItem>
 #include <QKeyEvent>
 
+#include "annotationfile.h"
+#include "magicwand.h"
+#include "gradientmap.h"
+#include "livewire.h"
+#include "overlapchecker.h"
+#include "datasetstatistics.h"
+
+/*!
+ * \brief SCENE_WIDTH is the width the images are scaled to fit on the scene, the shapes are stored in the coordinates of the scaled image
+ */
+#define SCENE_WIDTH 1000
+/*!
+ * \brief SCENE_HEIGHT is the height the images are scaled to fit on the scene
+ */
+#define SCENE_HEIGHT 800
+
 /*!
  * \brief The Scene class inherits from QGraphicsScene which is used for displaying the images and shapes
  */
@@ -15,7 +31,7 @@ public:
     /*!
      * \brief The Mode enum stores all the possible options for annotating images
      */
-    enum class Mode { NoMode, SelectObject, DrawLine, DrawRectangle, RotateRectangle, DrawTrapezoid, Edit, DrawPoligon };
+    enum class Mode { NoMode, SelectObject, DrawLine, DrawRectangle, RotateRectangle, DrawTrapezoid, Edit, DrawPoligon, MagicWand, LiveWire };
 
     /*!
      * \brief Scene constructor takes other objects as it's parent (when parent is delete QGraphicsScene is also delete)
@@ -31,11 +47,60 @@ public:
      * \param aMode is is an object of type Mode enum
      */
     void setMode(Mode aMode);
+    /*!
+     * \brief mode method gets the current mode
+     * \return returns the mode
+     */
+    Mode mode() const;
+    /*!
+     * \brief isModified method determines whether the shapes were changed with the mouse or keyboard since the last setModified(false)
+     * \return returns true if there are changes
+     */
+    bool isModified() const;
+    /*!
+     * \brief setModified method sets the modified flag, e.g. cleared after saving or loading, clearing it drops the unsaved edits from the statistics
+     * \param aModified is the new flag value
+     */
+    void setModified(bool aModified);
+    /*!
+     * \brief revision method gets a number increased by every change made with the mouse or keyboard, to tell whether the shapes changed since they were collected
+     * \return returns the revision
+     */
+    quint64 revision() const;
+    /*!
+     * \brief setImage method sets the displayed image used by the tools that look at the pixels (e.g. the magic wand)
+     * \param aImage is the image as displayed, its pixels are scene coordinates; a null image disables those tools
+     * \param aGradient is the gradient map of the image, used for edge snapping and the live wire
+     *
+     * A null image is set right after the scene is cleared, the live wire being traced is forgotten (its item was deleted).
+     */
+    void setImage(const QImage &aImage, const GradientMap &aGradient);
+    /*!
+     * \brief setSnapToEdges method turns edge snapping on or off, when on the polygon vertices being placed or dragged move to the strongest edge near the mouse
+     * \param aSnap is true to snap
+     */
+    void setSnapToEdges(bool aSnap);
     /*!
      * \brief save methods saves the annotated shapes into json file
      * \param aFileName is the file name where the annotated data will be stored
      */
     void save(const QString &aFileName);
+    /*!
+     * \brief shapes method gets the annotated shapes on the scene in scene coordinates, as they are written to the json file
+     * \return returns the shapes
+     */
+    QVector<AnnotationShape> shapes();
+    /*!
+     * \brief load method reads an annotation json file and displays its shapes on the scene
+     * \param aFileName is the json file path
+     * \return returns true if the file was read
+     */
+    bool load(const QString &aFileName);
+    /*!
+     * \brief addShapes method displays shapes, e.g. shapes read from an annotation file
+     * \param aShapes are the shapes to add
+     */
+    void addShapes(const QVector<AnnotationShape> &aShapes);
     /*!
      * \brief setClassName method sets the class name when the class item is clicked on the class pane widget
      * \param aClassName holds the className
@@ -48,6 +113,52 @@ public:
      * \param type is the shape type
      */
     void setupShapes(QList<double> *pList,QString *m_Object ,int type);
+    /*!
+     * \brief classNames method gets the class names of all the shapes on the scene
+     * \return returns the class names, each name is listed once
+     */
+    QStringList classNames();
+    /*!
+     * \brief memoryUsed method estimates the memory taken by the shapes on the scene (the image is counted by the image cache)
+     * \param shapes receives the number of shapes when it isn't null
+     * \return returns the number of bytes
+     */
+    qint64 memoryUsed(int *shapes = nullptr) const;
+    /*!
+     * \brief acceptPreLabels method turns the selected pre-labels (shapes proposed by a tool, drawn dashed) into normal shapes, all of them when none is selected
+     * \return returns the number of accepted shapes
+     */
+    int acceptPreLabels();
+    /*!
+     * \brief preLabelCount method gets the number of pre-labels not accepted yet
+     * \return returns the number of pre-labels
+     */
+    int preLabelCount() const;
+    /*!
+     * \brief removePreLabels method removes the pre-labels not accepted yet, e.g. before the pre-labels of a new propagation are added
+     * \return returns the number of removed pre-labels
+     */
+    int removePreLabels();
+    /*!
+     * \brief setCheckOverlaps method turns the overlap check on or off, when on the shapes drawn twice or with conflicting classes are marked after every change
+     * \param aCheck is true to check
+     */
+    void setCheckOverlaps(bool aCheck);
+    /*!
+     * \brief overlaps method gets the issues found by the last check
+     * \return returns the pairs of shapes, their indexes are those of shapes()
+     */
+    QVector<OverlapIssue> overlaps() const;
+    /*!
+     * \brief setStatistics method sets the dataset statistics kept up to date with the shapes of the scene, the changes are told as unsaved edits until setModified(false)
+     * \param aStatistics are the statistics, null for none
+     * \param aImagePath is the image whose shapes the scene holds
+     */
+    void setStatistics(DatasetStatistics *aStatistics, const QString &aImagePath);
+    /*!
+     * \brief finishPolygon method ends the polygon being drawn, it is checked for overlaps and counted in the statistics once rather than after every vertex
+     */
+    void finishPolygon();
 
 protected:
     /*!
@@ -113,6 +224,52 @@ private:
      * \param aShallConvex boolean variable parameter is false for polygon because polygon can be convex or concave and it's true for trapezoid so it can be triangle
      */
     void editPolygon(QGraphicsSceneMouseEvent *aEvent, bool aShallConvex);
+    /*!
+     * \brief snapped method gets the position a vertex is placed at for the mouse position
+     * \param aPos is the mouse position in scene coordinates
+     * \return returns the nearby edge when snapping is on and there is one, otherwise aPos
+     */
+    QPointF snapped(const QPointF &aPos) const;
+    /*!
+     * \brief updateMagicWand method selects the region around the clicked point and shows its outline as a polygon of the current class
+     * \param aTolerance is the color tolerance of the selection
+     */
+    void updateMagicWand(int aTolerance);
+    /*!
+     * \brief addLiveWirePoint method anchors the live wire at the clicked point, the first click starts a shape and a click near its first point closes it
+     * \param aPos is the clicked point in scene coordinates
+     */
+    void addLiveWirePoint(const QPointF &aPos);
+    /*!
+     * \brief updateLiveWire method shows the anchored points followed by the path along the edges to the mouse
+     * \param aPos is the mouse position in scene coordinates
+     */
+    void updateLiveWire(const QPointF &aPos);
+    /*!
+     * \brief finishLiveWire method closes the traced shape with the path back to its first point and adds it as a polygon of the current class
+     */
+    void finishLiveWire();
+    /*!
+     * \brief cancelLiveWire method removes the shape being traced
+     */
+    void cancelLiveWire();
+    /*!
+     * \brief shapesChanged method records that the shapes were changed with the mouse or keyboard and updates what is derived from them
+     */
+    void shapesChanged();
+    /*!
+     * \brief updateDerived method checks the shapes again for overlaps and updates the statistics, the shapes are collected once for both
+     */
+    void updateDerived();
+    /*!
+     * \brief updateOverlaps method checks the shapes for overlaps and marks each pair found over the region where they overlap
+     * \param current are the shapes of the scene
+     */
+    void updateOverlaps(const QVector<AnnotationShape> &current);
+    /*!
+     * \brief removeOverlapItems method removes the marks of the overlaps
+     */
+    void removeOverlapItems();
     /*!
      * \brief editTrapezoid method is used to resize trapezoid
      * \param aEvent is the mouse move event that's passed from mouseMoveEvent method, which enables resizing the shape
@@ -131,8 +288,9 @@ private:
     /*!
      * \brief drawRectangle method is used to draw rectangle shape automatically when json file data is loaded that contains one or more rectangles
      * \param rectP pointer parameter points to the rectangle coordinates
+     * \return returns the rectangle item
      */
-    void drawRectangle(QRectF *rectP);
+    QGraphicsRectItem *drawRectangle(QRectF *rectP);
     /*!
      * \brief drawTrapezoid method is used for drawing shape with mouse it's called from addTrapezoid method (it does not draw shape automatically using data from json file)
      * \param trapP pointer parameter points to the trapezoid coordinates
@@ -149,18 +307,6 @@ private:
      */
     void drawPolygon(QPolygonF *polyP);
 
-    /*!
-     * \brief crossProductLength method determines whether a polygon or a trapezoid(should be convex) is convex. It takes a set of three adjacent points A, B, C,
-     * \return returns the cross product AB x BC
-     */
-    float crossProductLength(float Ax, float Ay, float Bx, float By, float Cx, float Cy);
-    /*!
-     * \brief polygonIsConvex returns true if polygon or trapezoid is convex otherwise returns false. Note, trapezoid is technically polygon
-     * \param p parameter takes the polygon points object address
-     * \return returns true if a shape is convex else returns false
-     */
-    bool polygonIsConvex(QPolygonF const &p);
-
 private:
     /*!
      * \brief m_Mode is an object of type Mode enum used for determining what action is being taken e.g. drawing line, editing etc
@@ -178,6 +324,74 @@ private:
      * \brief m_CurrentPolygon object is used to draw polygon on the scene
      */
     QGraphicsPolygonItem *m_CurrentPolygon;
+    /*!
+     * \brief m_Wand selects the regions of the displayed image in magic wand mode
+     */
+    MagicWand m_Wand;
+    /*!
+     * \brief m_WandItem is the polygon of the region being selected, dragging the mouse changes its tolerance until the button is released
+     */
+    QGraphicsPolygonItem *m_WandItem;
+    /*!
+     * \brief m_WandTolerance is the tolerance used by the last selection, the next click starts from it
+     */
+    int m_WandTolerance;
+    /*!
+     * \brief m_Gradient is the gradient map of the displayed image, the vertices snap to its edges
+     */
+    GradientMap m_Gradient;
+    /*!
+     * \brief m_SnapToEdges is true when the polygon vertices snap to the image edges
+     */
+    bool m_SnapToEdges;
+    /*!
+     * \brief m_LiveWire finds the paths along the image edges in live wire mode
+     */
+    LiveWire m_LiveWire;
+    /*!
+     * \brief m_LiveWirePoints are the points of the shape being traced up to the last anchor
+     */
+    QPolygonF m_LiveWirePoints;
+    /*!
+     * \brief m_LiveWireItem shows the shape being traced and the path to the mouse, null when no shape is being traced
+     */
+    QGraphicsPathItem *m_LiveWireItem;
+    /*!
+     * \brief m_CheckOverlaps is true when the shapes are checked for overlaps after every change
+     */
+    bool m_CheckOverlaps;
+    /*!
+     * \brief m_Overlaps are the issues found by the last check
+     */
+    QVector<OverlapIssue> m_Overlaps;
+    /*!
+     * \brief m_OverlapItems mark the overlaps, they are above the shapes and let the mouse through
+     */
+    QList<QGraphicsRectItem*> m_OverlapItems;
+    /*!
+     * \brief m_Statistics are the dataset statistics told about the changes, null for none
+     */
+    DatasetStatistics *m_Statistics;
+    /*!
+     * \brief m_StatisticsImage is the image the shapes of the scene belong to in the statistics
+     */
+    QString m_StatisticsImage;
+    /*!
+     * \brief m_Modified is true when the shapes were changed since the flag was last cleared
+     */
+    bool m_Modified;
+    /*!
+     * \brief m_Revision counts the changes made with the mouse or keyboard
+     */
+    quint64 m_Revision;
+    /*!
+     * \brief m_GeometryChanged is set when the mouse adds, resizes, rotates or moves a shape, the change is recorded on release
+     */
+    bool m_GeometryChanged;
+    /*!
+     * \brief m_PressPositions are the selected items and their positions when the mouse was pressed, to tell whether they were moved
+     */
+    QList<QPair<QGraphicsItem*, QPointF> > m_PressPositions;
     /*!
      * \brief className string variable is used to be assigned to the class name
      */
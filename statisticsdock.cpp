@@ -0,0 +1,92 @@
+#include "statisticsdock.h"
+
+#include <QHeaderView>
+
+StatisticsDock::StatisticsDock(DatasetStatistics *theStatistics, QWidget *parent)
+    : QDockWidget("Statistics", parent), statistics(theStatistics)
+{
+    setObjectName("statisticsDock"); //saved with the window state
+
+    tree = new QTreeWidget(this);
+    tree->setColumnCount(3);
+    tree->setHeaderLabels(QStringList() << "" << "Shapes" << "Images");
+    tree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    tree->header()->setStretchLastSection(false);
+    tree->setRootIsDecorated(true);
+    setWidget(tree);
+
+    imagesSection = new QTreeWidgetItem(tree, QStringList() << "Images");
+    for(const QString &name : {"Total", "Annotated", "Unannotated", "With unsaved edits"})
+        new QTreeWidgetItem(imagesSection, QStringList() << name);
+    imagesSection->child(3)->setToolTip(0, "These images are counted with their edits, not with their saved shapes, until they are saved");
+    classesSection = new QTreeWidgetItem(tree, QStringList() << "Classes");
+    sizeSection = new QTreeWidgetItem(tree, QStringList() << "Box size");
+    aspectSection = new QTreeWidgetItem(tree, QStringList() << "Aspect ratio (width:height)");
+
+    //the bin label is kept with the item, the bar is appended to it
+    for(int bin = 0; bin < STATS_SIZE_BINS; bin++)
+        new QTreeWidgetItem(sizeSection, QStringList() << DatasetStatistics::sizeBinName(bin));
+    for(int bin = 0; bin < STATS_ASPECT_BINS; bin++)
+        new QTreeWidgetItem(aspectSection, QStringList() << DatasetStatistics::aspectBinName(bin));
+    for(QTreeWidgetItem *section : {sizeSection, aspectSection}){
+        for(int bin = 0; bin < section->childCount(); bin++)
+            section->child(bin)->setData(0, Qt::UserRole, section->child(bin)->text(0));
+    }
+    tree->expandAll();
+
+    refreshTimer.setSingleShot(true);
+    refreshTimer.setInterval(STATS_REFRESH_MS);
+    connect(&refreshTimer, &QTimer::timeout, this, [=]() { refresh(); });
+    connect(statistics, &DatasetStatistics::changed, this, [=]() { refreshTimer.start(); });
+    connect(this, &QDockWidget::visibilityChanged, this, [=](bool visible) {
+        if(visible)
+            refresh(); //the changes made while hidden
+    });
+}
+
+void StatisticsDock::refresh(){
+
+    if(!isVisible())
+        return;
+
+    int total = statistics->imageCount();
+    int annotated = statistics->annotatedCount();
+    imagesSection->setText(1, QString::number(statistics->shapeCount()));
+    imagesSection->setText(2, QString::number(total));
+    imagesSection->child(0)->setText(2, QString::number(total));
+    imagesSection->child(1)->setText(2, QString::number(annotated));
+    imagesSection->child(2)->setText(2, QString::number(total - annotated));
+    imagesSection->child(3)->setText(2, QString::number(statistics->unsavedCount()));
+
+    //one row per class, the most used first, the rows are reused
+    QStringList classes = statistics->classes();
+    while(classesSection->childCount() > classes.size())
+        delete classesSection->takeChild(classesSection->childCount() - 1);
+    while(classesSection->childCount() < classes.size())
+        new QTreeWidgetItem(classesSection);
+    for(int i = 0; i < classes.size(); i++){
+        QTreeWidgetItem *item = classesSection->child(i);
+        item->setText(0, classes[i]);
+        item->setText(1, QString::number(statistics->shapesOf(classes[i])));
+        item->setText(2, QString::number(statistics->imagesOf(classes[i])));
+    }
+    classesSection->setText(1, QString::number(statistics->shapeCount()));
+    classesSection->setText(2, QString::number(classes.size()) + " classes");
+
+    showHistogram(sizeSection, statistics->sizeHistogram());
+    showHistogram(aspectSection, statistics->aspectHistogram());
+}
+
+void StatisticsDock::showHistogram(QTreeWidgetItem *section, const QVector<qint64> &counts){
+
+    qint64 largest = 1;
+    for(qint64 count : counts)
+        largest = qMax(largest, count);
+
+    for(int bin = 0; bin < counts.size(); bin++){
+        int width = int((counts[bin] * STATS_BAR_WIDTH + largest - 1) / largest); //any shape shows at least one character
+        QTreeWidgetItem *item = section->child(bin);
+        item->setText(0, item->data(0, Qt::UserRole).toString() + "  " + QString(width, QChar(0x2588)));
+        item->setText(1, QString::number(counts[bin]));
+    }
+}
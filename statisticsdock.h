@@ -0,0 +1,77 @@
+#ifndef STATISTICSDOCK_H
+#define STATISTICSDOCK_H
+
+#include "datasetstatistics.h"
+
+#include <QDockWidget>
+#include <QTimer>
+#include <QTreeWidget>
+
+/*!
+ * \brief STATS_REFRESH_MS is how long the panel waits after a change before showing the totals, a burst of changes is shown once
+ */
+#define STATS_REFRESH_MS 100
+/*!
+ * \brief STATS_BAR_WIDTH is the number of characters of the longest histogram bar
+ */
+#define STATS_BAR_WIDTH 20
+
+/*!
+ * \brief The StatisticsDock class is the dock panel showing the dataset statistics, it reads the totals kept by DatasetStatistics and never opens a file
+ *
+ * The totals include the edits not saved yet, the number of images counted with such edits is shown with the image counts.
+ */
+class StatisticsDock : public QDockWidget
+{
+public:
+    /*!
+     * \brief StatisticsDock constructor builds the panel
+     * \param theStatistics are the statistics shown, they must outlive the panel
+     * \param parent is the parent widget
+     */
+    StatisticsDock(DatasetStatistics *theStatistics, QWidget *parent = nullptr);
+
+private:
+    /*!
+     * \brief refresh method shows the current totals, only while the panel is visible
+     */
+    void refresh();
+    /*!
+     * \brief showHistogram method fills a section with the bins of a histogram as text bars
+     * \param section is the top level item of the histogram
+     * \param counts are the counts of the bins
+     */
+    void showHistogram(QTreeWidgetItem *section, const QVector<qint64> &counts);
+
+private:
+    /*!
+     * \brief statistics are the statistics shown
+     */
+    DatasetStatistics *statistics;
+    /*!
+     * \brief tree shows the sections: images, classes, box sizes and aspect ratios
+     */
+    QTreeWidget *tree;
+    /*!
+     * \brief imagesSection holds the total, annotated and unannotated image counts and the images with unsaved edits
+     */
+    QTreeWidgetItem *imagesSection;
+    /*!
+     * \brief classesSection holds an item per class
+     */
+    QTreeWidgetItem *classesSection;
+    /*!
+     * \brief sizeSection holds the box size histogram
+     */
+    QTreeWidgetItem *sizeSection;
+    /*!
+     * \brief aspectSection holds the aspect ratio histogram
+     */
+    QTreeWidgetItem *aspectSection;
+    /*!
+     * \brief refreshTimer delays the refresh after a change
+     */
+    QTimer refreshTimer;
+};
+
+#endif // STATISTICSDOCK_H
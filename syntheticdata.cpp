@@ -0,0 +1,145 @@
+#include "syntheticdata.h"
+
+#include <QDir>
+#include <QPainter>
+#include <QFile>
+#include <QTextStream>
+#include <QtMath>
+
+#define SYNTHETIC_CAMERAS       8
+#define SYNTHETIC_SCENE_WIDTH   1000
+#define SYNTHETIC_SCENE_HEIGHT  800
+
+SyntheticData::SyntheticData(quint32 seed) : random(seed)
+{
+}
+
+int SyntheticData::uniform(int lo, int hi){
+    return std::uniform_int_distribution<int>(lo, hi)(random);
+}
+
+double SyntheticData::uniformReal(double lo, double hi){
+    return std::uniform_real_distribution<double>(lo, hi)(random);
+}
+
+QVector<Image> SyntheticData::images(int count){
+
+    QVector<Image> result;
+    result.reserve(count);
+
+    QDateTime start(QDate(2015, 1, 1), QTime(0, 0));
+    for(int i = 0; i < count; i++){
+        QString name = QString("frame_%1.jpg").arg(i / SYNTHETIC_CAMERAS, 7, 10, QChar('0'));
+        QString path = QString("/synthetic/cam%1/%2").arg(i % SYNTHETIC_CAMERAS).arg(name);
+
+        Image img(name, path, start.addSecs(qint64(uniform(0, 9 * 365 * 24 * 3600))));
+
+        QByteArray hash(16, Qt::Uninitialized);
+        for(int b = 0; b < hash.size(); b++)
+            hash[b] = char(uniform(0, 255));
+        img.setHash(hash);
+        img.setSize(QSize(1920, 1080));
+
+        result.append(img);
+    }
+    return result;
+}
+
+QStringList SyntheticData::classNames(int count){
+
+    static const char *roots[] = { "vehicle", "person", "animal", "sign", "building", "plant" };
+    static const char *kinds[] = { "car", "truck", "bus", "adult", "child", "dog", "cat", "stop", "house", "tree" };
+
+    QStringList names;
+    for(int i = 0; i < count; i++){
+        names.append(QString("%1/%2/k%3").arg(roots[i % 6]).arg(kinds[(i / 6) % 10]).arg(i));
+    }
+    return names;
+}
+
+QVector<AnnotationShape> SyntheticData::shapes(int count, int vertices, const QStringList &classes){
+
+    QVector<AnnotationShape> result;
+    result.reserve(count);
+    vertices = qMax(vertices, 3);
+
+    for(int i = 0; i < count; i++){
+        AnnotationShape shape;
+        shape.type = SHAPE_RECT + uniform(0, 2);
+        shape.object = classes.isEmpty() ? QString("object") : classes[uniform(0, classes.size() - 1)];
+
+        double w = uniformReal(10, 200);
+        double h = uniformReal(10, 200);
+        double x = uniformReal(0, SYNTHETIC_SCENE_WIDTH - w);
+        double y = uniformReal(0, SYNTHETIC_SCENE_HEIGHT - h);
+
+        if(shape.type == SHAPE_RECT){
+            shape.coordinates << x << y << w << h;
+        }else if(shape.type == SHAPE_TRAPEZOID){
+            shape.coordinates << x + w / 6 << y << x + w - w / 6 << y << x + w << y + h << x << y + h;
+        }else{
+            //star shaped outline so the polygon never crosses itself
+            double cx = x + w / 2, cy = y + h / 2;
+            for(int v = 0; v < vertices; v++){
+                double angle = 2 * M_PI * v / vertices;
+                double r = uniformReal(0.6, 1.0);
+                shape.coordinates << cx + r * w / 2 * qCos(angle) << cy + r * h / 2 * qSin(angle);
+            }
+        }
+        result.append(shape);
+    }
+    return result;
+}
+
+bool SyntheticData::writeDataset(const QString &dir, int imageCount, int classCount, int shapesPerImage, int vertices){
+
+    QDir out(dir);
+    if(!out.mkpath("annotations"))
+        return false;
+
+    QStringList classes = classNames(classCount);
+    QFile namesFile(out.filePath("classes.names"));
+    if(!namesFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    QTextStream names(&namesFile);
+    for(const QString &name : classes)
+        names << name << "\n";
+    namesFile.close();
+
+    QVector<Image> catalog = images(imageCount);
+    for(const Image &img : catalog){
+        //cam3/frame_0000001.jpg -> annotations/cam3_frame_0000001.json
+        QString base = img.getPath().section('/', -2).replace('/', '_');
+        base = base.left(base.lastIndexOf('.'));
+        if(!AnnotationFile::write(out.filePath("annotations/" + base + ".json"), shapes(shapesPerImage, vertices, classes)))
+            return false;
+    }
+    return true;
+}
+
+QImage SyntheticData::picture(int width, int height, int objects){
+
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(QColor(90, 110, 80));
+
+    {
+        QPainter painter(&image);
+        painter.setPen(Qt::NoPen);
+        for(int i = 0; i < objects; i++){
+            painter.setBrush(QColor(uniform(0, 255), uniform(0, 255), uniform(0, 255)));
+            double w = uniformReal(20, width / 4.0);
+            double h = uniformReal(20, height / 4.0);
+            painter.drawEllipse(QRectF(uniformReal(0, width - w), uniformReal(0, height - h), w, h));
+        }
+    }
+
+    //sensor like noise so the regions are not perfectly flat
+    for(int y = 0; y < height; y++){
+        QRgb *row = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for(int x = 0; x < width; x++){
+            int n = uniform(-6, 6);
+            row[x] = qRgb(qBound(0, qRed(row[x]) + n, 255), qBound(0, qGreen(row[x]) + n, 255), qBound(0, qBlue(row[x]) + n, 255));
+        }
+    }
+    return image;
+}
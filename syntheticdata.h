@@ -0,0 +1,80 @@
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include "image.h"
+#include "annotationfile.h"
+
+#include <QStringList>
+#include <QImage>
+#include <QVector>
+
+#include <random>
+
+/*!
+ * \brief The SyntheticData class generates reproducible image catalogs, class lists and annotations of any size, used by the benchmarks and to create test datasets
+ */
+class SyntheticData
+{
+public:
+    /*!
+     * \brief SyntheticData constructor seeds the generator, the same seed always gives the same data
+     * \param seed is the random seed
+     */
+    SyntheticData(quint32 seed = 1);
+    /*!
+     * \brief images method generates catalog entries spread over several camera folders (the same file names appear in every folder)
+     * \param count is the number of images
+     * \return returns the images
+     */
+    QVector<Image> images(int count);
+    /*!
+     * \brief classNames method generates unique hierarchical class names such as "vehicle/car/k12"
+     * \param count is the number of classes
+     * \return returns the class names
+     */
+    QStringList classNames(int count);
+    /*!
+     * \brief shapes method generates annotated shapes inside the 1000x800 scene
+     * \param count is the number of shapes
+     * \param vertices is the number of points of each polygon (at least 3)
+     * \param classes are the class names the shapes are given
+     * \return returns the shapes
+     */
+    QVector<AnnotationShape> shapes(int count, int vertices, const QStringList &classes);
+    /*!
+     * \brief picture method generates an image of flat colored objects with some noise on a noisy background, used by the tools that look at the pixels
+     * \param width is the image width
+     * \param height is the image height
+     * \param objects is the number of objects (ellipses)
+     * \return returns the image
+     */
+    QImage picture(int width, int height, int objects);
+    /*!
+     * \brief writeDataset method writes a .names file and one annotation file per image to a folder
+     * \param dir is the output folder, created if needed
+     * \param imageCount is the number of annotation files
+     * \param classCount is the number of classes
+     * \param shapesPerImage is the number of shapes in each annotation file
+     * \param vertices is the number of points of each polygon
+     * \return returns true if everything was written
+     */
+    bool writeDataset(const QString &dir, int imageCount, int classCount, int shapesPerImage, int vertices);
+
+private:
+    /*!
+     * \brief uniform method gets a random integer from lo to hi (inclusive)
+     */
+    int uniform(int lo, int hi);
+    /*!
+     * \brief uniformReal method gets a random number from lo to hi
+     */
+    double uniformReal(double lo, double hi);
+
+private:
+    /*!
+     * \brief random is the random number generator
+     */
+    std::mt19937 random;
+};
+
+#endif // SYNTHETICDATA_H
@@ -0,0 +1,235 @@
+#include "taskscheduler.h"
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+
+namespace {
+
+/*!
+ * \brief currentWorker is the index of the worker running on this thread, -1 for the other threads
+ */
+thread_local int currentWorker = -1;
+
+/*!
+ * \brief The DeliveryEvent class carries a result callback to the gui thread
+ */
+class DeliveryEvent : public QEvent
+{
+public:
+    static QEvent::Type eventType(){
+        static int type = QEvent::registerEventType();
+        return QEvent::Type(type);
+    }
+
+    DeliveryEvent(const QPointer<QObject> &theContext, const std::function<void()> &theCallback)
+        : QEvent(eventType()), context(theContext), callback(theCallback) {}
+
+    QPointer<QObject> context;
+    std::function<void()> callback;
+};
+
+/*!
+ * \brief The Dispatcher class lives on the gui thread and runs the delivered callbacks
+ */
+class Dispatcher : public QObject
+{
+public:
+    bool event(QEvent *event) override{
+        if(event->type() != DeliveryEvent::eventType())
+            return QObject::event(event);
+
+        DeliveryEvent *delivery = static_cast<DeliveryEvent*>(event);
+        if(delivery->context)
+            delivery->callback();
+        return true;
+    }
+};
+
+}
+
+CancellationToken::CancellationToken() : cancelled(std::make_shared<std::atomic<bool> >(false))
+{
+}
+
+void CancellationToken::cancel() const{
+    cancelled->store(true);
+}
+
+bool CancellationToken::isCancelled() const{
+    return cancelled->load();
+}
+
+TaskScheduler *TaskScheduler::instance(){
+    static TaskScheduler scheduler;
+    return &scheduler;
+}
+
+TaskScheduler::TaskScheduler(int threads) : queued(0), active(0), stopping(false)
+{
+    dispatcher = new Dispatcher();
+    if(QCoreApplication::instance())
+        dispatcher->moveToThread(QCoreApplication::instance()->thread());
+
+    int count = qMax(threads, 2); //one worker may be busy with a long task, keep another for the interactive ones
+    for(int i = 0; i < count; i++)
+        workers.emplace_back(new Worker());
+
+    for(int i = 0; i < count; i++)
+        workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for(const std::unique_ptr<Worker> &worker : workers)
+        worker->thread.join();
+
+    delete dispatcher;
+}
+
+int TaskScheduler::threadCount() const{
+    return int(workers.size());
+}
+
+void TaskScheduler::submit(Priority priority, const std::function<void()> &task){
+
+    int p = int(priority);
+    if(currentWorker >= 0){
+        Worker *worker = workers[currentWorker].get();
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->queues[p].push_back(task);
+    }else{
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        sharedQueues[p].push_back(task);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex); //so a worker can't miss the wake up between checking and sleeping
+        queued++;
+    }
+    wake.notify_one();
+}
+
+bool TaskScheduler::takeTask(int index, std::function<void()> *task){
+
+    for(int p = 0; p < TASK_PRIORITIES; p++){
+
+        if(index >= 0){
+            Worker *own = workers[index].get();
+            std::lock_guard<std::mutex> lock(own->mutex);
+            if(!own->queues[p].empty()){
+                *task = own->queues[p].back(); //newest first, its data is still in the cache
+                own->queues[p].pop_back();
+                queued--;
+                return true;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            if(!sharedQueues[p].empty()){
+                *task = sharedQueues[p].front();
+                sharedQueues[p].pop_front();
+                queued--;
+                return true;
+            }
+        }
+
+        for(size_t i = 1; i <= workers.size(); i++){
+            int victim = int((index + i) % workers.size());
+            if(victim == index)
+                continue;
+            Worker *other = workers[victim].get();
+            std::lock_guard<std::mutex> lock(other->mutex);
+            if(!other->queues[p].empty()){
+                *task = other->queues[p].front(); //steal the oldest, usually the biggest piece of work left
+                other->queues[p].pop_front();
+                queued--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::runOne(int index){
+
+    std::function<void()> task;
+    active++; //counted before the task leaves the queue, so waitForIdle never sees it nowhere
+    if(!takeTask(index, &task)){
+        active--;
+        return false;
+    }
+
+    task();
+    active--;
+    return true;
+}
+
+void TaskScheduler::workerLoop(int index){
+
+    currentWorker = index;
+
+    while(true){
+        if(runOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if(stopping && queued == 0)
+            return;
+        wake.wait(lock, [this]() { return stopping || queued > 0; });
+        if(stopping && queued == 0)
+            return;
+    }
+}
+
+void TaskScheduler::parallelFor(int count, const std::function<void(int)> &body, Priority priority){
+
+    if(count <= 0)
+        return;
+
+    TRACE_SCOPE("parallel for", "scheduler");
+
+    //Indexes are handed out one at a time from a shared counter, so uneven work balances itself
+    std::shared_ptr<std::atomic<int> > next = std::make_shared<std::atomic<int> >(0);
+    std::shared_ptr<std::atomic<int> > finished = std::make_shared<std::atomic<int> >(0);
+    std::function<void()> drain = [next, count, body]() {
+        for(int i = (*next)++; i < count; i = (*next)++)
+            body(i);
+    };
+
+    int chunks = qMin(count, threadCount()) - 1; //the calling thread is one of the participants
+    for(int c = 0; c < chunks; c++){
+        submit(priority, [drain, finished]() {
+            drain();
+            (*finished)++;
+        });
+    }
+
+    drain();
+
+    //The chunks may still be queued, help with whatever is queued rather than block a worker
+    while(*finished < chunks){
+        if(!runOne(currentWorker))
+            std::this_thread::yield();
+    }
+}
+
+void TaskScheduler::waitForIdle(){
+
+    TRACE_SCOPE("wait for tasks", "scheduler");
+    while(queued > 0 || active > 0){
+        if(!runOne(currentWorker))
+            std::this_thread::yield();
+    }
+}
+
+void TaskScheduler::deliver(const QPointer<QObject> &context, const std::function<void()> &callback){
+    QCoreApplication::postEvent(dispatcher, new DeliveryEvent(context, callback));
+}
@@ -0,0 +1,198 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * \brief TASK_PRIORITIES is the number of task priorities
+ */
+#define TASK_PRIORITIES 4
+
+/*!
+ * \brief The CancellationToken class is shared between the code that starts a task and the task, cancelling it skips the task if it hasn't started and drops its result
+ */
+class CancellationToken
+{
+public:
+    /*!
+     * \brief CancellationToken constructor creates a token that is not cancelled (copies share the same state)
+     */
+    CancellationToken();
+    /*!
+     * \brief cancel method cancels the tasks holding this token
+     */
+    void cancel() const;
+    /*!
+     * \brief isCancelled method determines whether the token was cancelled, long tasks can check it to stop early
+     * \return returns true if it was cancelled
+     */
+    bool isCancelled() const;
+
+private:
+    /*!
+     * \brief cancelled is the state shared by the copies
+     */
+    std::shared_ptr<std::atomic<bool> > cancelled;
+};
+
+/*!
+ * \brief The TaskScheduler class runs the background work of the application (file reading, decoding, parsing, hashing and writing) on a fixed set of worker threads
+ *
+ * Each worker has its own queues, tasks submitted by a worker go to its queues and idle workers steal from the others.
+ * Tasks are picked by priority. Results are delivered to the gui thread through its event loop.
+ */
+class TaskScheduler
+{
+public:
+    /*!
+     * \brief The Priority enum orders the tasks, from the most to the least urgent
+     */
+    enum class Priority { Interactive = 0, Prefetch = 1, Indexing = 2, Export = 3 };
+
+    /*!
+     * \brief instance method gets the scheduler shared by the application (created on first use, call it first from the gui thread)
+     * \return returns the scheduler
+     */
+    static TaskScheduler *instance();
+    /*!
+     * \brief TaskScheduler constructor starts the worker threads
+     * \param threads is the number of workers
+     */
+    TaskScheduler(int threads = QThread::idealThreadCount());
+    /*!
+      *\brief ~TaskScheduler destructor finishes the queued tasks and stops the workers
+      */
+    ~TaskScheduler();
+    /*!
+     * \brief submit method queues a task
+     * \param priority is the task priority
+     * \param task is the work
+     */
+    void submit(Priority priority, const std::function<void()> &task);
+    /*!
+     * \brief run method runs work on a worker and hands its result to done on the gui thread
+     * \param priority is the task priority
+     * \param token cancels the task, done is not called once it is cancelled
+     * \param work is the background work, it must not touch widgets or the scene
+     * \param context is the object done belongs to, done is not called if it has been deleted
+     * \param done receives the result on the gui thread
+     */
+    template<typename T>
+    void run(Priority priority, const CancellationToken &token, const std::function<T()> &work,
+             QObject *context, const std::function<void(const T&)> &done);
+    /*!
+     * \brief parallelFor method calls body for every index from 0 to count - 1 on the workers and waits for them, the calling thread helps so it can be used from a task
+     * \param count is the number of indexes
+     * \param body is the work for one index
+     * \param priority is the priority of the chunks
+     */
+    void parallelFor(int count, const std::function<void(int)> &body, Priority priority = Priority::Indexing);
+    /*!
+     * \brief deliver method calls a function on the gui thread
+     * \param context is the object the function belongs to, the call is dropped if it has been deleted
+     * \param callback is the function
+     */
+    void deliver(const QPointer<QObject> &context, const std::function<void()> &callback);
+    /*!
+     * \brief waitForIdle method runs queued tasks on the calling thread until every task has finished, used before deleting what the tasks use
+     */
+    void waitForIdle();
+    /*!
+     * \brief threadCount method gets the number of workers
+     */
+    int threadCount() const;
+
+private:
+    /*!
+     * \brief The Worker struct holds the queues (one per priority) and thread of a worker
+     */
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()> > queues[TASK_PRIORITIES];
+        std::thread thread;
+    };
+    /*!
+     * \brief workerLoop method runs the tasks of a worker until the scheduler stops
+     */
+    void workerLoop(int index);
+    /*!
+     * \brief takeTask method gets the most urgent task: own queue first (newest), then the shared queue, then the other workers (oldest)
+     * \param index is the worker asking, -1 for a thread that is not a worker
+     */
+    bool takeTask(int index, std::function<void()> *task);
+    /*!
+     * \brief runOne method runs one queued task if there is one
+     * \return returns true if a task was run
+     */
+    bool runOne(int index);
+
+private:
+    /*!
+     * \brief workers are the worker threads
+     */
+    std::vector<std::unique_ptr<Worker> > workers;
+    /*!
+     * \brief sharedMutex protects sharedQueues
+     */
+    std::mutex sharedMutex;
+    /*!
+     * \brief sharedQueues hold the tasks submitted from threads that are not workers
+     */
+    std::deque<std::function<void()> > sharedQueues[TASK_PRIORITIES];
+    /*!
+     * \brief sleepMutex and wake let idle workers sleep until a task is submitted
+     */
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    /*!
+     * \brief queued is the number of tasks waiting in the queues
+     */
+    std::atomic<int> queued;
+    /*!
+     * \brief active is the number of threads taking or running a task
+     */
+    std::atomic<int> active;
+    /*!
+     * \brief stopping is set by the destructor
+     */
+    std::atomic<bool> stopping;
+    /*!
+     * \brief dispatcher is the gui thread object receiving the results
+     */
+    QObject *dispatcher;
+};
+
+template<typename T>
+void TaskScheduler::run(Priority priority, const CancellationToken &token, const std::function<T()> &work,
+                        QObject *context, const std::function<void(const T&)> &done){
+
+    QPointer<QObject> guard(context); //made on the calling (gui) thread, checked there too
+
+    submit(priority, [this, token, work, guard, done]() {
+        if(token.isCancelled())
+            return;
+
+        T result = work();
+        if(token.isCancelled())
+            return;
+
+        deliver(guard, [token, done, result]() {
+            if(!token.isCancelled())
+                done(result);
+        });
+    });
+}
+
+#endif // TASKSCHEDULER_H
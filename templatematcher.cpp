@@ -0,0 +1,219 @@
+#include "templatematcher.h"
+#include "trace.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MATCH_USE_SSE2
+#endif
+
+TemplateMatcher::TemplateMatcher(const QImage &frame)
+{
+    if(frame.isNull())
+        return;
+
+    TRACE_SCOPE("match pyramid", "tools");
+    QImage pixels = frame.convertToFormat(QImage::Format_RGB32);
+
+    Plane full;
+    full.width = pixels.width();
+    full.height = pixels.height();
+    full.pixels.resize(full.width * full.height);
+    for(int y = 0; y < full.height; y++){
+        const QRgb *in = reinterpret_cast<const QRgb*>(pixels.constScanLine(y));
+        float *out = full.pixels.data() + y * full.width;
+        for(int x = 0; x < full.width; x++)
+            out[x] = float(qGray(in[x]));
+    }
+    levels.append(full);
+
+    //each level averages 2x2 pixels of the previous one
+    while(levels.size() < MATCH_LEVELS && levels.last().width >= 4 * MATCH_MIN_TEMPLATE && levels.last().height >= 4 * MATCH_MIN_TEMPLATE){
+        const Plane &fine = levels.last();
+        Plane coarse;
+        coarse.width = fine.width / 2;
+        coarse.height = fine.height / 2;
+        coarse.pixels.resize(coarse.width * coarse.height);
+        for(int y = 0; y < coarse.height; y++){
+            const float *top = fine.pixels.constData() + 2 * y * fine.width;
+            const float *bottom = top + fine.width;
+            float *out = coarse.pixels.data() + y * coarse.width;
+            for(int x = 0; x < coarse.width; x++)
+                out[x] = (top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1]) * 0.25f;
+        }
+        levels.append(coarse);
+    }
+}
+
+bool TemplateMatcher::isNull() const{
+    return levels.isEmpty();
+}
+
+qint64 TemplateMatcher::memoryUsed() const{
+    qint64 bytes = sizeof(TemplateMatcher);
+    for(const Plane &plane : levels)
+        bytes += sizeof(Plane) + plane.pixels.capacity() * qint64(sizeof(float));
+    return bytes;
+}
+
+TemplateMatcher::Plane TemplateMatcher::sample(const Plane &plane, const QRectF &region, int width, int height, double *norm){
+
+    Plane templ;
+    templ.width = width;
+    templ.height = height;
+    templ.pixels.resize(width * height);
+
+    double stepX = region.width() / width;
+    double stepY = region.height() / height;
+    double sum = 0;
+    for(int j = 0; j < height; j++){
+        double sy = qBound(0.0, region.y() + (j + 0.5) * stepY - 0.5, plane.height - 1.0);
+        int y0 = qMin(int(sy), qMax(0, plane.height - 2));
+        double fy = sy - y0;
+        int y1 = qMin(y0 + 1, plane.height - 1);
+        for(int i = 0; i < width; i++){
+            double sx = qBound(0.0, region.x() + (i + 0.5) * stepX - 0.5, plane.width - 1.0);
+            int x0 = qMin(int(sx), qMax(0, plane.width - 2));
+            double fx = sx - x0;
+            int x1 = qMin(x0 + 1, plane.width - 1);
+            const float *r0 = plane.pixels.constData() + y0 * plane.width;
+            const float *r1 = plane.pixels.constData() + y1 * plane.width;
+            double v = (r0[x0] * (1 - fx) + r0[x1] * fx) * (1 - fy) + (r1[x0] * (1 - fx) + r1[x1] * fx) * fy;
+            templ.pixels[j * width + i] = float(v);
+            sum += v;
+        }
+    }
+
+    //zero mean, so the correlation needs no mean of the image window
+    float mean = float(sum / (width * height));
+    double squares = 0;
+    for(float &v : templ.pixels){
+        v -= mean;
+        squares += double(v) * v;
+    }
+    *norm = std::sqrt(squares);
+    return templ;
+}
+
+double TemplateMatcher::correlate(const Plane &plane, int x, int y, const Plane &templ, double norm){
+
+    if(x < 0 || y < 0 || x + templ.width > plane.width || y + templ.height > plane.height)
+        return -1;
+
+    double dot = 0, sum = 0, squares = 0;
+    for(int j = 0; j < templ.height; j++){
+        const float *row = plane.pixels.constData() + (y + j) * plane.width + x;
+        const float *t = templ.pixels.constData() + j * templ.width;
+        float rowDot = 0, rowSum = 0, rowSquares = 0;
+        int i = 0;
+
+#ifdef MATCH_USE_SSE2
+        __m128 vDot = _mm_setzero_ps(), vSum = _mm_setzero_ps(), vSquares = _mm_setzero_ps();
+        for(; i + 4 <= templ.width; i += 4){
+            __m128 a = _mm_loadu_ps(row + i);
+            vDot = _mm_add_ps(vDot, _mm_mul_ps(a, _mm_loadu_ps(t + i)));
+            vSum = _mm_add_ps(vSum, a);
+            vSquares = _mm_add_ps(vSquares, _mm_mul_ps(a, a));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, vDot);
+        rowDot = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm_storeu_ps(lanes, vSum);
+        rowSum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm_storeu_ps(lanes, vSquares);
+        rowSquares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+        for(; i < templ.width; i++){
+            rowDot += row[i] * t[i];
+            rowSum += row[i];
+            rowSquares += row[i] * row[i];
+        }
+        dot += rowDot;
+        sum += rowSum;
+        squares += rowSquares;
+    }
+
+    double n = double(templ.width) * templ.height;
+    double deviation = std::sqrt(qMax(0.0, squares - sum * sum / n));
+    if(deviation < 1e-3 || norm < 1e-3)
+        return 0; //a flat window or template correlates with nothing
+    return dot / (deviation * norm);
+}
+
+double TemplateMatcher::search(const Plane &plane, const Plane &templ, double norm, int radius, int *x, int *y){
+
+    double best = -2;
+    int bestX = *x, bestY = *y;
+    for(int dy = -radius; dy <= radius; dy++){
+        for(int dx = -radius; dx <= radius; dx++){
+            double score = correlate(plane, *x + dx, *y + dy, templ, norm);
+            if(score > best){
+                best = score;
+                bestX = *x + dx;
+                bestY = *y + dy;
+            }
+        }
+    }
+    *x = bestX;
+    *y = bestY;
+    return best;
+}
+
+MatchResult TemplateMatcher::locate(const TemplateMatcher &source, const QRectF &box, const QRectF &previous, int radius) const{
+
+    MatchResult result;
+    result.box = previous;
+    result.confidence = 0;
+    if(isNull() || source.isNull() || box.width() < 4 || box.height() < 4 || previous.width() < 4 || previous.height() < 4)
+        return result;
+
+    TRACE_SCOPE("locate box", "tools");
+
+    //the coarsest level keeping the template at least MATCH_MIN_TEMPLATE pixels
+    int top = 0;
+    while(top + 1 < levels.size() && top + 1 < source.levels.size()
+          && qMin(previous.width(), previous.height()) / (2 << top) >= MATCH_MIN_TEMPLATE)
+        top++;
+
+    double norm;
+    int x = 0, y = 0;
+    for(int level = top; level >= 1; level--){
+        double f = 1 << level;
+        Plane templ = sample(source.levels[level], QRectF(box.topLeft() / f, box.size() / f),
+                             qRound(previous.width() / f), qRound(previous.height() / f), &norm);
+        if(level == top){
+            x = qRound(previous.x() / f);
+            y = qRound(previous.y() / f);
+            search(levels[level], templ, norm, qCeil(radius / f), &x, &y);
+        }else{
+            x *= 2;
+            y *= 2;
+            search(levels[level], templ, norm, 2, &x, &y);
+        }
+    }
+
+    //full resolution, the object may also have come closer or moved away
+    QPointF center = top == 0 ? previous.center()
+                              : QPointF(2 * x + previous.width() / 2, 2 * y + previous.height() / 2);
+    int fullRadius = top == 0 ? radius : 2;
+    double best = -2;
+    for(double scale : {1.0 / MATCH_SCALE_STEP, 1.0, MATCH_SCALE_STEP}){
+        int w = qRound(previous.width() * scale);
+        int h = qRound(previous.height() * scale);
+        Plane templ = sample(source.levels[0], box, w, h, &norm);
+        int sx = qRound(center.x() - w / 2.0);
+        int sy = qRound(center.y() - h / 2.0);
+        double score = search(levels[0], templ, norm, fullRadius, &sx, &sy);
+        if(score > best){
+            best = score;
+            result.box = QRectF(sx, sy, w, h);
+        }
+    }
+
+    result.confidence = qMax(0.0, best);
+    return result;
+}
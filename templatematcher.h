@@ -0,0 +1,114 @@
+#ifndef TEMPLATEMATCHER_H
+#define TEMPLATEMATCHER_H
+
+#include <QImage>
+#include <QRectF>
+#include <QVector>
+
+/*!
+ * \brief MATCH_LEVELS is the largest number of pyramid levels (each half the size of the previous one)
+ */
+#define MATCH_LEVELS 4
+/*!
+ * \brief MATCH_MIN_TEMPLATE is the smallest template side in pixels, coarser levels are not used for smaller boxes
+ */
+#define MATCH_MIN_TEMPLATE 12
+/*!
+ * \brief MATCH_SEARCH_RADIUS is the largest distance in pixels a box is looked for from its previous position
+ */
+#define MATCH_SEARCH_RADIUS 48
+/*!
+ * \brief MATCH_SCALE_STEP is the size change tried between two frames, the box is also looked for this much smaller and larger
+ */
+#define MATCH_SCALE_STEP 1.05
+/*!
+ * \brief MATCH_MIN_CONFIDENCE is the lowest correlation accepted, a box matching less is considered lost
+ */
+#define MATCH_MIN_CONFIDENCE 0.6
+
+/*!
+ * \brief The MatchResult struct is where a box was found in a frame
+ */
+struct MatchResult
+{
+    /*!
+     * \brief box is the found box in scene coordinates
+     */
+    QRectF box;
+    /*!
+     * \brief confidence is the normalized cross-correlation of the box with the template (0 to 1)
+     */
+    double confidence;
+};
+
+/*!
+ * \brief The TemplateMatcher class finds the boxes of one frame in another one with normalized cross-correlation
+ *
+ * Each frame is kept as a gray pyramid. A box is looked for coarse to fine: an exhaustive search around its previous position
+ * on the coarsest level the box allows, then a small search on each finer level, then a search over three sizes on the full
+ * resolution. The correlation sums are computed four pixels at a time.
+ */
+class TemplateMatcher
+{
+public:
+    /*!
+     * \brief TemplateMatcher constructor builds the pyramid of a frame, it can run on any thread
+     * \param frame is the frame, its pixels are scene coordinates
+     */
+    explicit TemplateMatcher(const QImage &frame = QImage());
+    /*!
+     * \brief isNull method determines whether there is a frame
+     * \return returns true if there is none
+     */
+    bool isNull() const;
+    /*!
+     * \brief locate method finds a box of another frame in this frame
+     * \param source is the frame the box was drawn on
+     * \param box is the box on the source frame, the template
+     * \param previous is where the box was last found, the search is centered on it and starts from its size
+     * \param radius is the search radius in pixels
+     * \return returns the best match, its confidence is 0 if the box is too small or outside the frames
+     */
+    MatchResult locate(const TemplateMatcher &source, const QRectF &box, const QRectF &previous, int radius = MATCH_SEARCH_RADIUS) const;
+    /*!
+     * \brief memoryUsed method gets the size of the pyramid
+     * \return returns the number of bytes
+     */
+    qint64 memoryUsed() const;
+
+private:
+    /*!
+     * \brief The Plane struct is a gray image stored as floats
+     */
+    struct Plane
+    {
+        int width;
+        int height;
+        QVector<float> pixels;
+    };
+
+    /*!
+     * \brief sample method resamples a region of a plane to a size (bilinear), the template is made zero mean
+     * \param norm receives the square root of the sum of the squared template values
+     */
+    static Plane sample(const Plane &plane, const QRectF &region, int width, int height, double *norm);
+    /*!
+     * \brief correlate method gets the normalized cross-correlation of a template placed at x, y on a plane, -1 outside the plane
+     */
+    static double correlate(const Plane &plane, int x, int y, const Plane &templ, double norm);
+    /*!
+     * \brief search method moves the template over the positions within radius of x, y and keeps the best one
+     * \param x is the center column, receives the best column
+     * \param y is the center row, receives the best row
+     * \return returns the best correlation
+     */
+    static double search(const Plane &plane, const Plane &templ, double norm, int radius, int *x, int *y);
+
+private:
+    /*!
+     * \brief levels are the pyramid levels from the full resolution
+     */
+    QVector<Plane> levels;
+};
+
+#endif // TEMPLATEMATCHER_H
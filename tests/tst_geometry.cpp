@@ -0,0 +1,232 @@
+#include "geometry.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+/*!
+ * \brief The TestGeometry class checks the geometry routines against values known in closed form
+ */
+class TestGeometry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /*!
+     * \brief unitSquareArea checks the area of a unit square
+     */
+    void unitSquareArea();
+    /*!
+     * \brief orientation checks that a clockwise and a counterclockwise polygon have opposite signed areas and the same area
+     */
+    void orientation();
+    /*!
+     * \brief oddVertexCount checks the polygons whose last point is handled after the two-point SSE2 steps
+     */
+    void oddVertexCount();
+    /*!
+     * \brief containsEdges checks the points on the edges and vertices of a square
+     */
+    void containsEdges();
+    /*!
+     * \brief concaveIou checks an L shape against a square, in both orientations
+     */
+    void concaveIou();
+    /*!
+     * \brief rotatedRectIou checks a square against itself turned 45 degrees
+     */
+    void rotatedRectIou();
+    /*!
+     * \brief disjointAndTouching checks boxes apart or sharing an edge or a corner
+     */
+    void disjointAndTouching();
+    /*!
+     * \brief pentagram checks that a self-intersecting star is not taken for a convex polygon
+     */
+    void pentagram();
+
+private:
+    /*!
+     * \brief polygon method builds a polygon from packed coordinates
+     */
+    static QPolygonF polygon(const QVector<double> &xy);
+    /*!
+     * \brief reversed method gets a polygon with the opposite orientation
+     */
+    static QPolygonF reversed(const QPolygonF &polygon);
+    /*!
+     * \brief star method gets the five points of a regular pentagon of radius 1 around the origin, every second one when skip is 2
+     */
+    static QPolygonF star(int skip);
+};
+
+QPolygonF TestGeometry::polygon(const QVector<double> &xy){
+    QPolygonF result;
+    for(int i = 0; i + 1 < xy.size(); i += 2)
+        result << QPointF(xy[i], xy[i + 1]);
+    return result;
+}
+
+QPolygonF TestGeometry::reversed(const QPolygonF &polygon){
+    QPolygonF result;
+    for(int i = polygon.size() - 1; i >= 0; i--)
+        result << polygon[i];
+    return result;
+}
+
+QPolygonF TestGeometry::star(int skip){
+    QPolygonF result;
+    for(int i = 0; i < 5; i++){
+        double angle = 2 * M_PI * (i * skip % 5) / 5;
+        result << QPointF(std::sin(angle), -std::cos(angle));
+    }
+    return result;
+}
+
+void TestGeometry::unitSquareArea(){
+    QPolygonF square = polygon({0, 0, 1, 0, 1, 1, 0, 1});
+    QCOMPARE(Geometry::area(square), 1.0);
+    QVERIFY(Geometry::isConvex(square));
+    QCOMPARE(Geometry::boundingRect(reinterpret_cast<const double*>(square.constData()), square.size()), QRectF(0, 0, 1, 1));
+}
+
+void TestGeometry::orientation(){
+    QPolygonF square = polygon({0, 0, 2, 0, 2, 2, 0, 2});
+    const double *xy = reinterpret_cast<const double*>(square.constData());
+    QPolygonF back = reversed(square);
+    const double *backXy = reinterpret_cast<const double*>(back.constData());
+
+    QCOMPARE(Geometry::signedArea(xy, 4), 4.0);
+    QCOMPARE(Geometry::signedArea(backXy, 4), -4.0);
+    QCOMPARE(Geometry::area(back), 4.0);
+    QVERIFY(Geometry::isConvex(back));
+
+    //the clip needs a counterclockwise clip polygon, every mix of orientations gives the same intersection
+    QPolygonF shifted = polygon({1, 1, 3, 1, 3, 3, 1, 3});
+    QVERIFY(qAbs(Geometry::intersectionArea(square, shifted) - 1) < 1e-12);
+    QVERIFY(qAbs(Geometry::intersectionArea(back, shifted) - 1) < 1e-12);
+    QVERIFY(qAbs(Geometry::intersectionArea(square, reversed(shifted)) - 1) < 1e-12);
+    QVERIFY(qAbs(Geometry::intersectionArea(back, reversed(shifted)) - 1) < 1e-12);
+}
+
+void TestGeometry::oddVertexCount(){
+    //a house: a 2 x 2 square with a roof one pixel high, five points
+    QPolygonF house = polygon({0, 0, 2, 0, 2, 2, 1, 3, 0, 2});
+    const double *xy = reinterpret_cast<const double*>(house.constData());
+    QCOMPARE(Geometry::area(house), 5.0);
+    QVERIFY(Geometry::isConvex(house));
+
+    //nearestPoint takes two points per SSE2 step, the last point of an odd count is left to its scalar tail
+    QCOMPARE(Geometry::boundingRect(xy, 5), QRectF(0, 0, 2, 3));
+    double distance = -1;
+    QCOMPARE(Geometry::nearestPoint(xy, 5, QPointF(-0.1, 2.2), &distance), 4);
+    QVERIFY(qAbs(distance - 0.05) < 1e-12);
+    QCOMPARE(Geometry::nearestPoint(xy, 3, QPointF(2.1, 2.1)), 2);
+    QCOMPARE(Geometry::nearestPoint(xy, 0, QPointF(0, 0)), -1);
+
+    QPolygonF triangle = polygon({0, 0, 4, 0, 0, 3});
+    QCOMPARE(Geometry::area(triangle), 6.0);
+}
+
+void TestGeometry::containsEdges(){
+    QPolygonF square = polygon({0, 0, 1, 0, 1, 1, 0, 1});
+    QVERIFY(Geometry::contains(square, QPointF(0.5, 0.5)));
+    QVERIFY(!Geometry::contains(square, QPointF(1.5, 0.5)));
+
+    //the left and top edges are inside, the right and bottom ones outside
+    QVERIFY(Geometry::contains(square, QPointF(0, 0.5)));
+    QVERIFY(Geometry::contains(square, QPointF(0.5, 0)));
+    QVERIFY(!Geometry::contains(square, QPointF(1, 0.5)));
+    QVERIFY(!Geometry::contains(square, QPointF(0.5, 1)));
+    QVERIFY(Geometry::contains(square, QPointF(0, 0)));
+    QVERIFY(!Geometry::contains(square, QPointF(1, 1)));
+    QVERIFY(Geometry::contains(reversed(square), QPointF(0, 0.5)));
+    QVERIFY(!Geometry::contains(reversed(square), QPointF(1, 0.5)));
+
+    //a point on a shared edge belongs to exactly one of the two squares
+    QPolygonF right = polygon({1, 0, 2, 0, 2, 1, 1, 1});
+    QVector<QPointF> points;
+    points << QPointF(1, 0.5) << QPointF(1, 0) << QPointF(0.5, 0.5) << QPointF(3, 0.5);
+    QVector<bool> inLeft = Geometry::containsPoints(square, points);
+    QVector<bool> inRight = Geometry::containsPoints(right, points);
+    QVERIFY(inLeft[0] != inRight[0]);
+    QVERIFY(inLeft[1] != inRight[1]);
+    QVERIFY(inLeft[2] && !inRight[2]);
+    QVERIFY(!inLeft[3] && !inRight[3]);
+}
+
+void TestGeometry::concaveIou(){
+    //an L: the 2 x 2 square without its bottom right quarter, area 3
+    QPolygonF l = polygon({0, 0, 2, 0, 2, 1, 1, 1, 1, 2, 0, 2});
+    QPolygonF square = polygon({0.5, 0.5, 1.5, 0.5, 1.5, 1.5, 0.5, 1.5});
+    QCOMPARE(Geometry::area(l), 3.0);
+    QVERIFY(!Geometry::isConvex(l));
+
+    //the square loses the quarter [1, 1.5] x [1, 1.5]
+    double intersection = 0.75;
+    double expected = intersection / (3 + 1 - intersection);
+    QVERIFY(qAbs(Geometry::intersectionArea(l, square) - intersection) < 1e-12);
+    QVERIFY(qAbs(Geometry::intersectionArea(square, l) - intersection) < 1e-12);
+    QVERIFY(qAbs(Geometry::iou(l, square) - expected) < 1e-12);
+    QVERIFY(qAbs(Geometry::iou(reversed(l), square) - expected) < 1e-12);
+    QVERIFY(qAbs(Geometry::iou(l, reversed(square)) - expected) < 1e-12);
+    QVERIFY(qAbs(Geometry::iou(l, l) - 1) < 1e-12);
+}
+
+void TestGeometry::rotatedRectIou(){
+    //a square and the same square turned 45 degrees meet in a regular octagon, the IoU is 1 / sqrt(2)
+    QRectF square(-1, -1, 2, 2);
+    QVERIFY(qAbs(Geometry::iou(square, 0, square, 45) - 1 / std::sqrt(2.0)) < 1e-12);
+    QVERIFY(qAbs(Geometry::iou(square, 45, square, 0) - 1 / std::sqrt(2.0)) < 1e-12);
+    QVERIFY(qAbs(Geometry::iou(square, 30, square, 30) - 1) < 1e-12);
+
+    //a quarter turn of a 2 x 1 box around its center gives the 1 x 1 square in the middle: 1 / (2 + 2 - 1)
+    QRectF box(0, 0, 2, 1);
+    QVERIFY(qAbs(Geometry::iou(box, 0, box, 90) - 1.0 / 3) < 1e-12);
+
+    QPolygonF corners = Geometry::rotatedRect(box, 90);
+    QCOMPARE(corners.size(), 4);
+    QVERIFY(qAbs(Geometry::area(corners) - 2) < 1e-12);
+}
+
+void TestGeometry::disjointAndTouching(){
+    QRectF a(0, 0, 1, 1);
+    QCOMPARE(Geometry::iou(a, 0, QRectF(5, 5, 1, 1), 0), 0.0);
+    QCOMPARE(Geometry::iou(a, 0, QRectF(1, 0, 1, 1), 0), 0.0); //sharing an edge
+    QCOMPARE(Geometry::iou(a, 0, QRectF(1, 1, 1, 1), 0), 0.0); //sharing a corner
+    QCOMPARE(Geometry::iou(a, 0, a, 0), 1.0);
+    QCOMPARE(Geometry::iou(a, 0, QRectF(0.5, 0, 1, 1), 0), 1.0 / 3);
+
+    //the same through the polygon path
+    QPolygonF square = Geometry::rotatedRect(a, 0);
+    QCOMPARE(Geometry::intersectionArea(square, Geometry::rotatedRect(QRectF(5, 5, 1, 1), 0)), 0.0);
+    QCOMPARE(Geometry::intersectionArea(square, Geometry::rotatedRect(QRectF(1, 0, 1, 1), 0)), 0.0);
+    QCOMPARE(Geometry::intersectionArea(square, Geometry::rotatedRect(QRectF(1, 1, 1, 1), 0)), 0.0);
+    QCOMPARE(Geometry::iou(square, polygon({0, 0, 1, 0, 0, 1})), 0.5);
+    QCOMPARE(Geometry::iou(QPolygonF(), square), 0.0);
+}
+
+void TestGeometry::pentagram(){
+    QPolygonF pentagon = star(1);
+    QPolygonF pentagram = star(2);
+    QVERIFY(Geometry::isConvex(pentagon));
+    QVERIFY(Geometry::isConvex(reversed(pentagon)));
+    QVERIFY(!Geometry::isConvex(pentagram)); //every turn has the same direction, but it winds around twice
+    QVERIFY(!Geometry::isConvex(reversed(pentagram)));
+
+    //the star is inside its pentagon, the intersection is the star counted as area() counts it (the center twice)
+    double starArea = Geometry::area(pentagram);
+    double pentagonArea = Geometry::area(pentagon);
+    QVERIFY(qAbs(pentagonArea - 2.5 * std::sin(2 * M_PI / 5)) < 1e-12);
+    QVERIFY(qAbs(Geometry::intersectionArea(pentagram, pentagon) - starArea) < 1e-9);
+    QVERIFY(qAbs(Geometry::intersectionArea(pentagon, pentagram) - starArea) < 1e-9);
+    QVERIFY(qAbs(Geometry::iou(pentagram, pentagon) - starArea / pentagonArea) < 1e-9);
+
+    //even-odd: the center is wound twice, so it is outside, the tips are inside
+    QVERIFY(!Geometry::contains(pentagram, QPointF(0, 0)));
+    QVERIFY(Geometry::contains(pentagram, QPointF(0, -0.8)));
+}
+
+QTEST_APPLESS_MAIN(TestGeometry)
+
+#include "tst_geometry.moc"
@@ -0,0 +1,25 @@
+# Known-answer tests of the geometry routines.
+# qmake && make check runs them with the SSE2 code, qmake CONFIG+=scalar with the scalar code.
+
+QT       += testlib
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+TARGET = tst_geometry
+
+scalar {
+    DEFINES += GEOMETRY_NO_SIMD
+    TARGET = tst_geometry_scalar
+    OBJECTS_DIR = scalar # geometry.o of the SSE2 build is not linked in
+}
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../geometry.cpp \
+    tst_geometry.cpp
+
+HEADERS += \
+    ../geometry.h
@@ -0,0 +1,149 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/*!
+ * \brief The TraceEvent struct is one recorded span
+ */
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    qint64 start;
+    qint64 duration;
+};
+
+/*!
+ * \brief The ThreadBuffer struct is the ring buffer of one thread, only that thread writes it
+ */
+struct ThreadBuffer
+{
+    ThreadBuffer(int theId, const QString &theName) : id(theId), threadName(theName), events(TRACE_BUFFER_EVENTS), head(0), clearedAt(0) {}
+
+    int id;
+    QString threadName;
+    std::vector<TraceEvent> events;
+    std::atomic<quint64> head;      //number of spans ever written
+    std::atomic<quint64> clearedAt; //head value when the trace was last cleared
+};
+
+QMutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer> > registry; //buffers live until exit, so a dump can read the spans of finished threads
+thread_local ThreadBuffer *localBuffer = nullptr;
+
+ThreadBuffer *currentBuffer(){
+
+    if(localBuffer)
+        return localBuffer;
+
+    QThread *thread = QThread::currentThread();
+    QString name = thread->objectName();
+    if(name.isEmpty())
+        name = (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) ? "main" : "worker";
+
+    QMutexLocker locker(&registryMutex);
+    registry.emplace_back(new ThreadBuffer(int(registry.size()) + 1, name));
+    localBuffer = registry.back().get();
+    return localBuffer;
+}
+
+}
+
+std::atomic<bool> Trace::enabledFlag(false);
+
+void Trace::setEnabled(bool enabled){
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Trace::now(){
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(const char *name, const char *category, qint64 start, qint64 end){
+
+    ThreadBuffer *buffer = currentBuffer();
+    quint64 head = buffer->head.load(std::memory_order_relaxed);
+
+    TraceEvent &event = buffer->events[head % TRACE_BUFFER_EVENTS];
+    event.name = name;
+    event.category = category;
+    event.start = start;
+    event.duration = end - start;
+
+    buffer->head.store(head + 1, std::memory_order_release); //publish the span to dump()
+}
+
+void Trace::clear(){
+
+    QMutexLocker locker(&registryMutex);
+    for(const std::unique_ptr<ThreadBuffer> &buffer : registry)
+        buffer->clearedAt.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+bool Trace::dump(const QString &fileName){
+
+    QJsonArray traceEvents;
+    qint64 pid = QCoreApplication::applicationPid();
+
+    QMutexLocker locker(&registryMutex);
+    for(const std::unique_ptr<ThreadBuffer> &buffer : registry){
+
+        QJsonObject threadName;
+        threadName.insert("name", "thread_name");
+        threadName.insert("ph", "M");
+        threadName.insert("pid", pid);
+        threadName.insert("tid", buffer->id);
+        threadName.insert("args", QJsonObject{{"name", buffer->threadName + " " + QString::number(buffer->id)}});
+        traceEvents.append(threadName);
+
+        //The owning thread may keep writing while the buffer is read. Spans are copied first, then any
+        //slot the writer could have reached in the meantime is dropped.
+        quint64 end = buffer->head.load(std::memory_order_acquire);
+        quint64 begin = qMax(buffer->clearedAt.load(std::memory_order_relaxed), end > TRACE_BUFFER_EVENTS ? end - TRACE_BUFFER_EVENTS : 0);
+
+        std::vector<TraceEvent> copy;
+        copy.reserve(end - begin);
+        for(quint64 i = begin; i < end; i++)
+            copy.push_back(buffer->events[i % TRACE_BUFFER_EVENTS]);
+
+        quint64 after = buffer->head.load(std::memory_order_acquire);
+        quint64 firstSafe = after + 1 > TRACE_BUFFER_EVENTS ? after + 1 - TRACE_BUFFER_EVENTS : 0; //slot of the span being written
+
+        for(quint64 i = qMax(begin, firstSafe); i < end; i++){
+            const TraceEvent &event = copy[i - begin];
+            QJsonObject span;
+            span.insert("name", event.name);
+            span.insert("cat", event.category);
+            span.insert("ph", "X");
+            span.insert("ts", double(event.start));
+            span.insert("dur", double(event.duration));
+            span.insert("pid", pid);
+            span.insert("tid", buffer->id);
+            traceEvents.append(span);
+        }
+    }
+    locker.unlock();
+
+    QJsonObject root;
+    root.insert("traceEvents", traceEvents);
+    root.insert("displayTimeUnit", "ms");
+
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
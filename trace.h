@@ -0,0 +1,110 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+
+#include <atomic>
+
+/*!
+ * \brief TRACE_SCOPE records the time spent in the enclosing block as a span named name in category (both string literals)
+ */
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name, category)
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_CONCAT_INNER(a, b) a##b
+
+/*!
+ * \brief TRACE_BUFFER_EVENTS is the number of spans kept per thread, older spans are overwritten
+ */
+#define TRACE_BUFFER_EVENTS 65536
+
+/*!
+ * \brief The Trace class records timed spans into a ring buffer per thread and writes them as a Chrome trace (chrome://tracing or ui.perfetto.dev)
+ *
+ * Recording is off by default, a disabled TRACE_SCOPE costs one relaxed atomic load. Each thread only writes its own buffer,
+ * so recording never takes a lock (apart from registering the buffer the first time a thread records).
+ */
+class Trace
+{
+public:
+    /*!
+     * \brief setEnabled method starts or stops recording
+     * \param enabled is true to record spans
+     */
+    static void setEnabled(bool enabled);
+    /*!
+     * \brief isEnabled method determines whether spans are being recorded
+     * \return returns true while recording
+     */
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+    /*!
+     * \brief clear method drops all the recorded spans
+     */
+    static void clear();
+    /*!
+     * \brief dump method writes the recorded spans of every thread to a Chrome trace event json file
+     * \param fileName is the output file
+     * \return returns true if the file was written
+     */
+    static bool dump(const QString &fileName);
+    /*!
+     * \brief now method gets the trace clock in microseconds
+     */
+    static qint64 now();
+    /*!
+     * \brief record method stores a finished span in the ring buffer of the calling thread
+     * \param name is the span name (must outlive the trace, i.e. a string literal)
+     * \param category is the span category (a string literal)
+     * \param start is the start time from now()
+     * \param end is the end time from now()
+     */
+    static void record(const char *name, const char *category, qint64 start, qint64 end);
+
+private:
+    /*!
+     * \brief enabledFlag is true while recording
+     */
+    static std::atomic<bool> enabledFlag;
+};
+
+/*!
+ * \brief The TraceScope class records a span from its construction to its destruction, use it through TRACE_SCOPE
+ */
+class TraceScope
+{
+public:
+    /*!
+     * \brief TraceScope constructor starts the span if tracing is enabled
+     */
+    TraceScope(const char *theName, const char *theCategory) : name(theName), category(theCategory), start(-1)
+    {
+        if(Trace::isEnabled())
+            start = Trace::now();
+    }
+    /*!
+     * \brief ~TraceScope destructor records the span
+     */
+    ~TraceScope()
+    {
+        if(start >= 0)
+            Trace::record(name, category, start, Trace::now());
+    }
+
+private:
+    TraceScope(const TraceScope &);
+    TraceScope &operator=(const TraceScope &);
+
+    /*!
+     * \brief name is the span name
+     */
+    const char *name;
+    /*!
+     * \brief category is the span category
+     */
+    const char *category;
+    /*!
+     * \brief start is the start time or -1 when tracing was disabled
+     */
+    qint64 start;
+};
+
+#endif // TRACE_H